@@ -10,12 +10,30 @@
 #include <FlexCAN_T4.h>
 
 #include "core/general.h"
+#include "core/timebase.h"
 #include "interrupts/interrupts.h"
+#include "comms/telemetry.h"
+#include "comms/subscription.h"
+#include "comms/torque.h"
+#include "comms/dashboard.h"
+#include "comms/statistics.h"
+#include "comms/latency.h"
+#include "comms/transport.h"
+#include "comms/e2e.h"
+#include "comms/routing.h"
+#include "comms/admission.h"
+#include "comms/recovery.h"
+#include "daq/DAQ.h"
+#include "comms/protocol.h"
+#include "core/parameter.h"
 
 /*-------------------------------------------------------------------------------------------------
  Initializations for CAN Communication
 -------------------------------------------------------------------------------------------------*/
 extern FlexCAN_T4<CAN3, RX_SIZE_256, TX_SIZE_16> myCan;
+#ifdef EV1_5
+extern FlexCAN_T4<CAN1, RX_SIZE_256, TX_SIZE_16> telemetryCan;
+#endif
 
 /*------------------------------------------
  Macros - CAN Frame Parameters
@@ -27,6 +45,14 @@ extern FlexCAN_T4<CAN3, RX_SIZE_256, TX_SIZE_16> myCan;
 #define PAR_RX_DLC           	 3
 #define PAR_TX_DLC           	 4
 
+/*------------------------------------------
+ Macros - Bamocar Frame Layout
+------------------------------------------*/
+#define BAMOCAR_REG_OFFSET       0 // Destination register of a write (REG_READ for a read)
+#define BAMOCAR_VALUE_OFFSET     1 // 16 bit write value - little endian
+#define BAMOCAR_READ_REG_OFFSET  1 // Register requested by a read
+#define BAMOCAR_INTERVAL_OFFSET  2 // Transmission interval of a read
+
 /*------------------------------------------
  Macros - Bamocar CAN Message IDs
 ------------------------------------------*/
@@ -51,19 +77,13 @@ extern FlexCAN_T4<CAN3, RX_SIZE_256, TX_SIZE_16> myCan;
 #define REG_CURRENT_PHASE_3  	 0x56
 #define TRANSMIT_ONCE        	 0x00
 #define TRANSMIT_100MS           0x64
+#define TRANSMIT_STOP            0xFF
 
 /*------------------------------------------
  Macros - Custom CAN protocol
 ------------------------------------------*/
-#define ID_BATTERY_TEMP          0x6B1
-#define ID_ERROR_CODE        	 0x681
-#define ID_CURRENT_STATE     	 0x682
-#define ID_TEMP              	 0x001
-#define ID_SPEED              	 0x002
-#define ID_CURRENT           	 0x003
-#define ID_VOLTAGE            	 0x004
-#define PAR_ERROR_DLC         	 1
-#define PAR_STATE_DLC        	 1
+// IDs, DLCs and layouts are generated from dbc/ECU.dbc into comms/protocol.h
+// #define LEGACY_DASHBOARD // Send single signal dashboard frames instead of packed frames
 
 #define NUM_TX_MAILBOXES     	 10
 #define NUM_RX_MAILBOXES	 	 6 // FlexCAN FIFO queue holds 6
@@ -82,26 +102,82 @@ extern FlexCAN_T4<CAN3, RX_SIZE_256, TX_SIZE_16> myCan;
 #define STATUS_MESSAGE_INTERVAL	 50
 #define NUM_MESSAGES_TX		 	 6
 
+/*-------------------------------------------------------------------------------------------------
+ Frame Templates
+-------------------------------------------------------------------------------------------------*/
+/*-----------------------------------------------------------------------------
+ Build the fixed head of a frame at compile time (copied, then only the payload is patched)
+-----------------------------------------------------------------------------*/
+constexpr CAN_message_t MakeFrameTemplate(uint16_t ID, uint8_t DLC, uint8_t padding = 0) {
+    CAN_message_t message = {};
+
+    message.flags.extended  =  PAR_EXTENDED;
+    message.flags.remote    =  PAR_REMOTE;
+    message.flags.overrun   =  PAR_OVERRUN;
+    message.flags.reserved  =  PAR_RESERVED;
+    message.id              =  static_cast<uint32_t>(ID);
+    message.len             =  DLC;
+
+    for (uint8_t i = 0; i < 8; ++i) {
+        message.buf[i] = padding;
+    }
+
+    return message;
+}
+
+/*-----------------------------------------------------------------------------
+ Bamocar write template - value patched with PatchBamocarValue
+-----------------------------------------------------------------------------*/
+constexpr CAN_message_t MakeBamocarWriteTemplate(uint8_t bamocarDestReg) {
+    CAN_message_t message = MakeFrameTemplate(ID_CAN_MESSAGE_RX, PAR_RX_DLC);
+
+    message.buf[BAMOCAR_REG_OFFSET] = bamocarDestReg;
+
+    return message;
+}
+
+/*-----------------------------------------------------------------------------
+ Bamocar read register request template - See CAN Complete
+-----------------------------------------------------------------------------*/
+constexpr CAN_message_t MakeBamocarReadTemplate(uint8_t bamocarDestReg, uint8_t transmissionInterval) {
+    CAN_message_t message = MakeFrameTemplate(ID_CAN_MESSAGE_RX, PAR_RX_DLC);
+
+    message.buf[BAMOCAR_REG_OFFSET] = REG_READ;
+    message.buf[BAMOCAR_READ_REG_OFFSET] = bamocarDestReg;
+    message.buf[BAMOCAR_INTERVAL_OFFSET] = transmissionInterval;
+
+    return message;
+}
+
+/*-----------------------------------------------------------------------------
+ Store a write value in Bamocar little endian order (two byte stores)
+-----------------------------------------------------------------------------*/
+constexpr void PatchBamocarValue(CAN_message_t & message, uint16_t value) {
+    message.buf[BAMOCAR_VALUE_OFFSET] = value & BYTE_ONE;
+    message.buf[BAMOCAR_VALUE_OFFSET + 1] = (value & BYTE_TWO) >> 8;
+}
+
 /*-------------------------------------------------------------------------------------------------
  Prototypes
 -------------------------------------------------------------------------------------------------*/
 void ConfigureCANBus(void);
+void ConfigureControlBus(void);
+void ConfigureTelemetryBus(void);
 
 void PrintCANMessage(const CAN_message_t & message);
 
 void ProcessCANMessage(const CAN_message_t & message);
-
-void PopulateCANMessage(CAN_message_t * pMessage, uint16_t ID, uint8_t DLC, 
-    uint8_t * pMessageBuf, uint8_t bamocarDestReg);
-void PopulateCANMessage(CAN_message_t * pMessage, uint16_t ID, uint8_t DLC, uint8_t bamocarDestReg);
-void PopulateCANMessage(CAN_message_t * pMessage, uint16_t ID, uint8_t DLC, uint8_t bamocarDestReg,
-    uint8_t transmissionInterval);
-void PopulateCANMessage(CAN_message_t * pMessage, uint16_t ID, uint8_t DLC, uint8_t * pMessageBuf);
+void ProcessTelemetryCANMessage(const CAN_message_t & message);
+void DispatchCANMessage(const CAN_message_t & message, uint8_t bus);
+void HandleCANMessage(const CAN_message_t & message, uint8_t bus);
 
 bool MapCANMessage(CAN_message_t & message);
 
+uint32_t GetTXQueueCount(uint32_t id);
+uint8_t WriteCANMessage(const CAN_message_t & message, uint8_t buses);
 void SendCANMessage(const CAN_message_t & message);
 void SendCANMessage(const CAN_message_t & message, const FLEXCAN_MAILBOX MB);
+void ConfirmCANTransmit(const CAN_message_t & message);
 
 void SendCANStatusMessages(uint8_t * errors, uint8_t * state);
 
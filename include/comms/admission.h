@@ -0,0 +1,98 @@
+// Safe guards
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+/*-------------------------------------------------------------------------------------------------
+ Libraries
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include <FlexCAN_T4.h>
+
+#include "core/general.h"
+#include "comms/protocol.h"
+
+/*------------------------------------------
+ Macros - Per ID Rate Limits
+------------------------------------------*/
+#define ADMISSION_NUM_IDS        4
+#define ADMISSION_CREDIT_UNIT    1000000 // Credit per frame - one unit per us at 1 frame/s
+#define ADMISSION_MAX_ELAPSED    1000000 // Refill is capped at one second (us)
+
+/*------------------------------------------
+ Macros - ISR Time Budget
+------------------------------------------*/
+#define ADMISSION_WINDOW         1000    // Budget window (us)
+#define ADMISSION_ISR_PERCENT    25      // Share of each window the receive ISRs may use
+#define ADMISSION_BUDGET_CYCLES  (F_CPU_ACTUAL / 1000000 * ADMISSION_WINDOW * ADMISSION_ISR_PERCENT / 100)
+
+#define ADMISSION_RING_SIZE      64      // Frames deferred to the main loop (power of two)
+#define ADMISSION_FRAMES_PER_LOOP 8      // Deferred frames handled per main loop
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+// Token bucket of one received ID
+typedef struct admissionConfig {
+    uint16_t id;
+    uint16_t rate;        // Sustained frames per second
+    uint8_t burst;        // Frames accepted back to back
+} admissionConfig_t;
+
+typedef struct admissionBucket {
+    uint32_t credit;      // ADMISSION_CREDIT_UNIT per frame
+    uint32_t lastTime;    // micros() of the last refill
+    bool bStarted;
+    volatile uint32_t admitted;
+    volatile uint32_t rejected;
+} admissionBucket_t;
+
+// Received frame handled by the main loop instead of the ISR
+typedef struct admissionDeferred {
+    CAN_message_t message;
+    uint8_t bus;
+} admissionDeferred_t;
+
+// Single consumer ring (producers are the CAN receive ISRs - same priority, never nested)
+typedef struct admissionRing {
+    admissionDeferred_t frames[ADMISSION_RING_SIZE];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t dropped;
+    volatile uint32_t deferred;
+} admissionRing_t;
+
+/*-------------------------------------------------------------------------------------------------
+ Receive flood protection - rate limits and ISR time budget (through a static class)
+-------------------------------------------------------------------------------------------------*/
+class AdmissionHandler {
+    public:
+        // Getters
+        static const admissionConfig_t & GetConfig(uint8_t index) { return config[index]; }
+        static uint32_t GetRejected(uint8_t index) { return buckets[index].rejected; }
+        static uint32_t GetDeferred(void) { return ring.deferred; }
+        static uint32_t GetDropped(void) { return ring.dropped; }
+        static uint32_t GetPeakCycles(void) { return peakCycles; }
+
+        // Data methods
+        static bool AdmitFrame(const CAN_message_t & message);
+        static bool DeferFrame(const CAN_message_t & message, uint8_t bus);
+        static void ChargeISR(uint32_t startCycles);
+        static void ServiceDeferred(void);
+        static void PrintAdmission(void);
+
+    private:
+        // Expected rate of each accepted ID (flash)
+        static const admissionConfig_t config[ADMISSION_NUM_IDS];
+        static admissionBucket_t buckets[ADMISSION_NUM_IDS];
+
+        // ISR cycles used in the current window (written by the CAN receive ISRs)
+        static uint32_t windowStart;
+        static uint32_t windowCycles;
+        static volatile uint32_t peakCycles;
+
+        static admissionRing_t ring;
+};
+
+// End safe guards
+#endif /* ADMISSION_H */
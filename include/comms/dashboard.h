@@ -0,0 +1,74 @@
+// Safe guards
+#ifndef DASHBOARD_H
+#define DASHBOARD_H
+
+/*-------------------------------------------------------------------------------------------------
+ Libraries
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "core/general.h"
+#include "comms/protocol.h"
+
+/*------------------------------------------
+ Macros - Packed Dashboard Protocol
+------------------------------------------*/
+// Frame layouts are generated from dbc/ECU.dbc (DASH_EVENT, DASH_STATUS & DASH_MOTOR)
+#define DASH_STATUS_INTERVAL     50
+#define DASH_MOTOR_INTERVAL      100
+#define DASH_EVENT_HOLDOFF       5     // Minimum gap between event frames (ms) - changes queue behind it
+#define DASH_EVENT_QUEUE_SIZE    8     // Changes held through the hold-off (power of two)
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+// State and fault bits after a change
+typedef struct dashEvent {
+    uint8_t state;
+    uint8_t faults;
+    uint8_t merged;       // Later changes folded in while the queue was full
+} dashEvent_t;
+
+// Changes waiting for the hold-off (filled and emptied by the main loop)
+typedef struct dashEventQueue {
+    dashEvent_t events[DASH_EVENT_QUEUE_SIZE];
+    uint32_t head;
+    uint32_t tail;
+    uint32_t timer;       // Last event frame (ms)
+} dashEventQueue_t;
+
+/*-------------------------------------------------------------------------------------------------
+ Packed dashboard transmitter (through a static class)
+-------------------------------------------------------------------------------------------------*/
+class DashboardHandler {
+    public:
+        // Setters
+        static void SetVehicleStatus(uint8_t state, uint8_t faults, uint8_t percentAPPS, uint8_t percentBSE);
+
+        // Data methods
+        static void SendDashboardMessages(void);
+
+        // Change queue shared with the legacy dashboard frames
+        static void QueueEvent(dashEventQueue_t & queue, uint8_t state, uint8_t faults);
+        static bool GetEvent(dashEventQueue_t & queue, dashEvent_t & event);
+
+    private:
+        // Helpers
+        static void SendEventMessage(const dashEvent_t & event);
+        static void SendStatusMessage(void);
+
+        // Latest vehicle status from the FSM
+        static canDashStatus_t status;
+
+        // State or fault changes waiting to be sent
+        static dashEventQueue_t events;
+        static uint32_t statusTimer;
+
+        // Rolling counters (one per frame)
+        static uint8_t eventCounter;
+        static uint8_t statusCounter;
+        static uint8_t motorCounter;
+};
+
+// End safe guards
+#endif /* DASHBOARD_H */
@@ -0,0 +1,86 @@
+// Safe guards
+#ifndef E2E_H
+#define E2E_H
+
+/*-------------------------------------------------------------------------------------------------
+ Libraries
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include <FlexCAN_T4.h>
+
+#include "core/general.h"
+#include "core/crc.h"
+#include "comms/protocol.h"
+
+/*------------------------------------------
+ Macros - E2E Protection
+------------------------------------------*/
+// Data ID is the CAN ID - a frame copied onto the wrong ID fails its CRC
+#define E2E_COUNTER_MASK         0x0F
+#define E2E_MAX_DELTA_COUNTER    2     // Frames that may be lost between two good receptions
+
+// CRC byte of each protected frame
+#define E2E_DASH_EVENT_CRC       3
+#define E2E_DASH_STATUS_CRC      7
+#define E2E_TORQUE_MONITOR_CRC   0
+
+/*------------------------------------------
+ Macros - E2E Checked Receptions
+------------------------------------------*/
+#define E2E_NUM_RX               1
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+enum class e2eStatus : uint8_t {
+    OK = 0,
+    INITIAL,              // First frame - counter not yet known
+    REPEATED,             // Same counter as the last frame (stale sender)
+    WRONG_SEQUENCE,       // More than E2E_MAX_DELTA_COUNTER frames lost
+    CRC_ERROR,
+    NOT_PROTECTED
+};
+
+// Layout of a protected frame received by the ECU
+typedef struct e2eConfig {
+    uint16_t id;
+    uint8_t len;
+    uint8_t crcByte;
+    uint8_t counterByte;
+    uint8_t counterShift;
+} e2eConfig_t;
+
+// Receive state and failure counters (written by the CAN receive ISR)
+typedef struct e2eReceiver {
+    volatile uint32_t okCount;
+    volatile uint32_t repeatedCount;
+    volatile uint32_t sequenceCount;
+    volatile uint32_t crcCount;
+    volatile e2eStatus lastStatus;
+    uint8_t lastCounter;
+    bool bCounterValid;
+} e2eReceiver_t;
+
+/*-------------------------------------------------------------------------------------------------
+ Rolling counter and CRC-8 protection of CAN frames (through a static class)
+-------------------------------------------------------------------------------------------------*/
+class E2EHandler {
+    public:
+        // Getters
+        static const e2eReceiver_t & GetReceiver(uint8_t index) { return receivers[index]; }
+
+        // Data methods
+        static uint8_t ComputeCRC(const CAN_message_t & message, uint8_t crcByte);
+        static void Protect(CAN_message_t & message, uint8_t crcByte) { message.buf[crcByte] = ComputeCRC(message, crcByte); }
+        static e2eStatus CheckFrame(const CAN_message_t & message);
+        static void PrintE2E(void);
+
+    private:
+        // Protected frames sent to the ECU (flash)
+        static const e2eConfig_t rxConfig[E2E_NUM_RX];
+        static e2eReceiver_t receivers[E2E_NUM_RX];
+};
+
+// End safe guards
+#endif /* E2E_H */
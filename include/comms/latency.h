@@ -0,0 +1,74 @@
+// Safe guards
+#ifndef LATENCY_H
+#define LATENCY_H
+
+/*-------------------------------------------------------------------------------------------------
+ Libraries
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include <FlexCAN_T4.h>
+
+#include "core/general.h"
+#include "core/timebase.h"
+#include "comms/telemetry.h"
+
+/*------------------------------------------
+ Macros - Latency Histograms
+------------------------------------------*/
+#define LATENCY_NUM_BINS         17 // Bin n holds [2^n, 2^(n+1)) us, last bin is overflow
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+typedef struct latencyStats {
+    uint32_t histogram[LATENCY_NUM_BINS]; // Request to response time (log2 us bins)
+    uint32_t count;
+    uint32_t minimum;                     // us
+    uint32_t maximum;                     // us
+    uint64_t total;                       // us (mean = total / count)
+
+    uint32_t jitterCount;
+    uint32_t jitterMaximum;               // Largest cyclic deviation from the interval (us)
+    uint64_t jitterTotal;                 // us (mean = jitterTotal / jitterCount)
+} latencyStats_t;
+
+/*-------------------------------------------------------------------------------------------------
+ Bamocar request to response latency tracker (through a static class)
+-------------------------------------------------------------------------------------------------*/
+class LatencyHandler {
+    public:
+        // Getters
+        static const latencyStats_t & GetStats(bamocarSignal signal) {
+            return stats[ static_cast<uint8_t>(signal) ];
+        }
+
+        static const latencyStats_t & GetControlStats(void) { return controlStats; }
+
+        // Data methods
+        static void RecordRequest(uint8_t bamocarReg);
+        static void RecordResponse(const CAN_message_t & message);
+        static void RecordControlDelay(uint32_t delay);
+
+        static void PrintLatency(void);
+
+    private:
+        // Helpers
+        static uint8_t GetBin(uint32_t time);
+        static void AddLatency(latencyStats_t * pStats, uint32_t latency);
+        static void PrintStats(latencyStats_t * pStats);
+
+        // Request time of each register (written by the main loop)
+        static volatile uint32_t requestTimes[NUM_BAMOCAR_SIGNALS];
+        static volatile bool bAwaiting[NUM_BAMOCAR_SIGNALS];
+
+        // Response statistics (written by the CAN receive ISR)
+        static volatile uint32_t lastArrivals[NUM_BAMOCAR_SIGNALS];
+        static latencyStats_t stats[NUM_BAMOCAR_SIGNALS];
+
+        // Pedal sample to torque command on the bus (written by the CAN transmit ISR)
+        static latencyStats_t controlStats;
+};
+
+// End safe guards
+#endif /* LATENCY_H */
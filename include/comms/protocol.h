@@ -0,0 +1,419 @@
+// Safe guards
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+/*-------------------------------------------------------------------------------------------------
+ Generated from dbc/ECU.dbc by tools/dbcgen/dbcgen.py - DO NOT EDIT
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+/*------------------------------------------
+ Macros - Message IDs & DLCs
+------------------------------------------*/
+#define ID_TEMP                  0x001
+#define PAR_TEMP_DLC             4
+#define ID_SPEED                 0x002
+#define PAR_SPEED_DLC            4
+#define ID_CURRENT               0x003
+#define PAR_CURRENT_DLC          4
+#define ID_VOLTAGE               0x004
+#define PAR_VOLTAGE_DLC          4
+#define ID_DASH_EVENT            0x010
+#define PAR_DASH_EVENT_DLC       4
+#define ID_ERROR_CODE            0x681
+#define PAR_ERROR_CODE_DLC       1
+#define ID_CURRENT_STATE         0x682
+#define PAR_CURRENT_STATE_DLC    1
+#define ID_DASH_STATUS           0x683
+#define PAR_DASH_STATUS_DLC      8
+#define ID_DASH_MOTOR            0x684
+#define PAR_DASH_MOTOR_DLC       8
+#define ID_CAN_DIAGNOSTIC        0x685
+#define PAR_CAN_DIAGNOSTIC_DLC   8
+#define ID_TORQUE_MONITOR        0x686
+#define PAR_TORQUE_MONITOR_DLC   4
+#define ID_PARAM_REQUEST         0x6F0
+#define PAR_PARAM_REQUEST_DLC    8
+#define ID_PARAM_RESPONSE        0x6F8
+#define PAR_PARAM_RESPONSE_DLC   8
+#define ID_BATTERY_TEMP          0x6B1
+#define PAR_BATTERY_TEMP_DLC     8
+
+/*-------------------------------------------------------------------------------------------------
+ TEMP (0x001) - Sent by ECU
+-------------------------------------------------------------------------------------------------*/
+typedef struct canTemp {
+    uint8_t   bamocarReg;      // Bits 0-7
+    int16_t   value;           // Bits 8-23
+} canTemp_t;
+
+constexpr void EncodeTemp(const canTemp_t & msg, uint8_t * buf) {
+    buf[0] = static_cast<uint8_t>(static_cast<uint32_t>(msg.bamocarReg));
+    buf[1] = static_cast<uint8_t>(static_cast<uint32_t>(msg.value));
+    buf[2] = static_cast<uint8_t>((static_cast<uint32_t>(msg.value) >> 8));
+    buf[3] = static_cast<uint8_t>(0);
+}
+
+constexpr canTemp_t DecodeTemp(const uint8_t * buf) {
+    canTemp_t msg = {};
+    msg.bamocarReg = static_cast<uint8_t>(static_cast<uint32_t>(buf[0]));
+    msg.value = static_cast<int16_t>(static_cast<int32_t>(((static_cast<uint32_t>(buf[1]) | (static_cast<uint32_t>(buf[2]) << 8)) ^ 0x8000U) - 0x8000U));
+    return msg;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ SPEED (0x002) - Sent by ECU
+-------------------------------------------------------------------------------------------------*/
+typedef struct canSpeed {
+    uint8_t   bamocarReg;      // Bits 0-7
+    int16_t   value;           // Bits 8-23
+} canSpeed_t;
+
+constexpr void EncodeSpeed(const canSpeed_t & msg, uint8_t * buf) {
+    buf[0] = static_cast<uint8_t>(static_cast<uint32_t>(msg.bamocarReg));
+    buf[1] = static_cast<uint8_t>(static_cast<uint32_t>(msg.value));
+    buf[2] = static_cast<uint8_t>((static_cast<uint32_t>(msg.value) >> 8));
+    buf[3] = static_cast<uint8_t>(0);
+}
+
+constexpr canSpeed_t DecodeSpeed(const uint8_t * buf) {
+    canSpeed_t msg = {};
+    msg.bamocarReg = static_cast<uint8_t>(static_cast<uint32_t>(buf[0]));
+    msg.value = static_cast<int16_t>(static_cast<int32_t>(((static_cast<uint32_t>(buf[1]) | (static_cast<uint32_t>(buf[2]) << 8)) ^ 0x8000U) - 0x8000U));
+    return msg;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ CURRENT (0x003) - Sent by ECU
+-------------------------------------------------------------------------------------------------*/
+typedef struct canCurrent {
+    uint8_t   bamocarReg;      // Bits 0-7
+    int16_t   value;           // Bits 8-23
+} canCurrent_t;
+
+constexpr void EncodeCurrent(const canCurrent_t & msg, uint8_t * buf) {
+    buf[0] = static_cast<uint8_t>(static_cast<uint32_t>(msg.bamocarReg));
+    buf[1] = static_cast<uint8_t>(static_cast<uint32_t>(msg.value));
+    buf[2] = static_cast<uint8_t>((static_cast<uint32_t>(msg.value) >> 8));
+    buf[3] = static_cast<uint8_t>(0);
+}
+
+constexpr canCurrent_t DecodeCurrent(const uint8_t * buf) {
+    canCurrent_t msg = {};
+    msg.bamocarReg = static_cast<uint8_t>(static_cast<uint32_t>(buf[0]));
+    msg.value = static_cast<int16_t>(static_cast<int32_t>(((static_cast<uint32_t>(buf[1]) | (static_cast<uint32_t>(buf[2]) << 8)) ^ 0x8000U) - 0x8000U));
+    return msg;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ VOLTAGE (0x004) - Sent by ECU
+-------------------------------------------------------------------------------------------------*/
+typedef struct canVoltage {
+    uint8_t   bamocarReg;      // Bits 0-7
+    int16_t   value;           // Bits 8-23
+} canVoltage_t;
+
+constexpr void EncodeVoltage(const canVoltage_t & msg, uint8_t * buf) {
+    buf[0] = static_cast<uint8_t>(static_cast<uint32_t>(msg.bamocarReg));
+    buf[1] = static_cast<uint8_t>(static_cast<uint32_t>(msg.value));
+    buf[2] = static_cast<uint8_t>((static_cast<uint32_t>(msg.value) >> 8));
+    buf[3] = static_cast<uint8_t>(0);
+}
+
+constexpr canVoltage_t DecodeVoltage(const uint8_t * buf) {
+    canVoltage_t msg = {};
+    msg.bamocarReg = static_cast<uint8_t>(static_cast<uint32_t>(buf[0]));
+    msg.value = static_cast<int16_t>(static_cast<int32_t>(((static_cast<uint32_t>(buf[1]) | (static_cast<uint32_t>(buf[2]) << 8)) ^ 0x8000U) - 0x8000U));
+    return msg;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ DASH_EVENT (0x010) - Sent by ECU
+-------------------------------------------------------------------------------------------------*/
+typedef struct canDashEvent {
+    uint8_t   state;           // Bits 0-3
+    uint8_t   counter;         // Bits 4-7
+    uint8_t   faults;          // Bits 8-15
+    uint8_t   merged;          // Bits 16-23
+    uint8_t   crc;             // Bits 24-31
+} canDashEvent_t;
+
+constexpr void EncodeDashEvent(const canDashEvent_t & msg, uint8_t * buf) {
+    buf[0] = static_cast<uint8_t>((static_cast<uint32_t>(msg.state) & 0xF) | (static_cast<uint32_t>(msg.counter) << 4));
+    buf[1] = static_cast<uint8_t>(static_cast<uint32_t>(msg.faults));
+    buf[2] = static_cast<uint8_t>(static_cast<uint32_t>(msg.merged));
+    buf[3] = static_cast<uint8_t>(static_cast<uint32_t>(msg.crc));
+}
+
+constexpr canDashEvent_t DecodeDashEvent(const uint8_t * buf) {
+    canDashEvent_t msg = {};
+    msg.state = static_cast<uint8_t>((static_cast<uint32_t>(buf[0]) & 0xF));
+    msg.counter = static_cast<uint8_t>((static_cast<uint32_t>(buf[0]) >> 4));
+    msg.faults = static_cast<uint8_t>(static_cast<uint32_t>(buf[1]));
+    msg.merged = static_cast<uint8_t>(static_cast<uint32_t>(buf[2]));
+    msg.crc = static_cast<uint8_t>(static_cast<uint32_t>(buf[3]));
+    return msg;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ ERROR_CODE (0x681) - Sent by ECU
+-------------------------------------------------------------------------------------------------*/
+typedef struct canErrorCode {
+    uint8_t   faults;          // Bits 0-7
+} canErrorCode_t;
+
+constexpr void EncodeErrorCode(const canErrorCode_t & msg, uint8_t * buf) {
+    buf[0] = static_cast<uint8_t>(static_cast<uint32_t>(msg.faults));
+}
+
+constexpr canErrorCode_t DecodeErrorCode(const uint8_t * buf) {
+    canErrorCode_t msg = {};
+    msg.faults = static_cast<uint8_t>(static_cast<uint32_t>(buf[0]));
+    return msg;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ CURRENT_STATE (0x682) - Sent by ECU
+-------------------------------------------------------------------------------------------------*/
+typedef struct canCurrentState {
+    uint8_t   state;           // Bits 0-7
+} canCurrentState_t;
+
+constexpr void EncodeCurrentState(const canCurrentState_t & msg, uint8_t * buf) {
+    buf[0] = static_cast<uint8_t>(static_cast<uint32_t>(msg.state));
+}
+
+constexpr canCurrentState_t DecodeCurrentState(const uint8_t * buf) {
+    canCurrentState_t msg = {};
+    msg.state = static_cast<uint8_t>(static_cast<uint32_t>(buf[0]));
+    return msg;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ DASH_STATUS (0x683) - Sent by ECU
+-------------------------------------------------------------------------------------------------*/
+typedef struct canDashStatus {
+    uint8_t   state;           // Bits 0-3
+    uint8_t   counter;         // Bits 4-7
+    uint8_t   faults;          // Bits 8-15
+    uint8_t   percentAPPS;     // Bits 16-23 %
+    uint8_t   percentBSE;      // Bits 24-31 %
+    uint16_t  torque;          // Bits 32-47
+    uint8_t   crc;             // Bits 56-63
+} canDashStatus_t;
+
+constexpr void EncodeDashStatus(const canDashStatus_t & msg, uint8_t * buf) {
+    buf[0] = static_cast<uint8_t>((static_cast<uint32_t>(msg.state) & 0xF) | (static_cast<uint32_t>(msg.counter) << 4));
+    buf[1] = static_cast<uint8_t>(static_cast<uint32_t>(msg.faults));
+    buf[2] = static_cast<uint8_t>(static_cast<uint32_t>(msg.percentAPPS));
+    buf[3] = static_cast<uint8_t>(static_cast<uint32_t>(msg.percentBSE));
+    buf[4] = static_cast<uint8_t>(static_cast<uint32_t>(msg.torque));
+    buf[5] = static_cast<uint8_t>((static_cast<uint32_t>(msg.torque) >> 8));
+    buf[6] = static_cast<uint8_t>(0);
+    buf[7] = static_cast<uint8_t>(static_cast<uint32_t>(msg.crc));
+}
+
+constexpr canDashStatus_t DecodeDashStatus(const uint8_t * buf) {
+    canDashStatus_t msg = {};
+    msg.state = static_cast<uint8_t>((static_cast<uint32_t>(buf[0]) & 0xF));
+    msg.counter = static_cast<uint8_t>((static_cast<uint32_t>(buf[0]) >> 4));
+    msg.faults = static_cast<uint8_t>(static_cast<uint32_t>(buf[1]));
+    msg.percentAPPS = static_cast<uint8_t>(static_cast<uint32_t>(buf[2]));
+    msg.percentBSE = static_cast<uint8_t>(static_cast<uint32_t>(buf[3]));
+    msg.torque = static_cast<uint16_t>(static_cast<uint32_t>(buf[4]) | (static_cast<uint32_t>(buf[5]) << 8));
+    msg.crc = static_cast<uint8_t>(static_cast<uint32_t>(buf[7]));
+    return msg;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ DASH_MOTOR (0x684) - Sent by ECU
+-------------------------------------------------------------------------------------------------*/
+typedef struct canDashMotor {
+    uint8_t   counter;         // Bits 0-3
+    uint8_t   staleFlags;      // Bits 4-9
+    int16_t   speed;           // Bits 16-31 rpm
+    int8_t    motorTemp;       // Bits 32-39 C
+    int8_t    bamocarTemp;     // Bits 40-47 C
+    uint16_t  phaseCurrent;    // Bits 48-63 x 0.1 + 0 A
+} canDashMotor_t;
+
+constexpr void EncodeDashMotor(const canDashMotor_t & msg, uint8_t * buf) {
+    buf[0] = static_cast<uint8_t>((static_cast<uint32_t>(msg.counter) & 0xF) | (static_cast<uint32_t>(msg.staleFlags) << 4));
+    buf[1] = static_cast<uint8_t>(((static_cast<uint32_t>(msg.staleFlags) >> 4) & 0x3));
+    buf[2] = static_cast<uint8_t>(static_cast<uint32_t>(msg.speed));
+    buf[3] = static_cast<uint8_t>((static_cast<uint32_t>(msg.speed) >> 8));
+    buf[4] = static_cast<uint8_t>(static_cast<uint32_t>(msg.motorTemp));
+    buf[5] = static_cast<uint8_t>(static_cast<uint32_t>(msg.bamocarTemp));
+    buf[6] = static_cast<uint8_t>(static_cast<uint32_t>(msg.phaseCurrent));
+    buf[7] = static_cast<uint8_t>((static_cast<uint32_t>(msg.phaseCurrent) >> 8));
+}
+
+constexpr canDashMotor_t DecodeDashMotor(const uint8_t * buf) {
+    canDashMotor_t msg = {};
+    msg.counter = static_cast<uint8_t>((static_cast<uint32_t>(buf[0]) & 0xF));
+    msg.staleFlags = static_cast<uint8_t>((static_cast<uint32_t>(buf[0]) >> 4) | ((static_cast<uint32_t>(buf[1]) & 0x3) << 4));
+    msg.speed = static_cast<int16_t>(static_cast<int32_t>(((static_cast<uint32_t>(buf[2]) | (static_cast<uint32_t>(buf[3]) << 8)) ^ 0x8000U) - 0x8000U));
+    msg.motorTemp = static_cast<int8_t>(static_cast<int32_t>(((static_cast<uint32_t>(buf[4])) ^ 0x80U) - 0x80U));
+    msg.bamocarTemp = static_cast<int8_t>(static_cast<int32_t>(((static_cast<uint32_t>(buf[5])) ^ 0x80U) - 0x80U));
+    msg.phaseCurrent = static_cast<uint16_t>(static_cast<uint32_t>(buf[6]) | (static_cast<uint32_t>(buf[7]) << 8));
+    return msg;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ CAN_DIAGNOSTIC (0x685) - Sent by ECU
+-------------------------------------------------------------------------------------------------*/
+typedef struct canCanDiagnostic {
+    uint8_t   busLoad;         // Bits 0-7 x 0.5 + 0 %
+    uint8_t   txQueueHighWater; // Bits 8-15
+    uint8_t   rxErrorCounter;  // Bits 16-23
+    uint8_t   txErrorCounter;  // Bits 24-31
+    uint8_t   errorState;      // Bits 32-33
+    uint8_t   txFailures;      // Bits 34-39
+    uint8_t   busOffCount;     // Bits 40-47
+    uint8_t   rxOverruns;      // Bits 48-55
+    uint8_t   frameRate;       // Bits 56-63 x 20 + 0 1/s
+} canCanDiagnostic_t;
+
+constexpr void EncodeCanDiagnostic(const canCanDiagnostic_t & msg, uint8_t * buf) {
+    buf[0] = static_cast<uint8_t>(static_cast<uint32_t>(msg.busLoad));
+    buf[1] = static_cast<uint8_t>(static_cast<uint32_t>(msg.txQueueHighWater));
+    buf[2] = static_cast<uint8_t>(static_cast<uint32_t>(msg.rxErrorCounter));
+    buf[3] = static_cast<uint8_t>(static_cast<uint32_t>(msg.txErrorCounter));
+    buf[4] = static_cast<uint8_t>((static_cast<uint32_t>(msg.errorState) & 0x3) | (static_cast<uint32_t>(msg.txFailures) << 2));
+    buf[5] = static_cast<uint8_t>(static_cast<uint32_t>(msg.busOffCount));
+    buf[6] = static_cast<uint8_t>(static_cast<uint32_t>(msg.rxOverruns));
+    buf[7] = static_cast<uint8_t>(static_cast<uint32_t>(msg.frameRate));
+}
+
+constexpr canCanDiagnostic_t DecodeCanDiagnostic(const uint8_t * buf) {
+    canCanDiagnostic_t msg = {};
+    msg.busLoad = static_cast<uint8_t>(static_cast<uint32_t>(buf[0]));
+    msg.txQueueHighWater = static_cast<uint8_t>(static_cast<uint32_t>(buf[1]));
+    msg.rxErrorCounter = static_cast<uint8_t>(static_cast<uint32_t>(buf[2]));
+    msg.txErrorCounter = static_cast<uint8_t>(static_cast<uint32_t>(buf[3]));
+    msg.errorState = static_cast<uint8_t>((static_cast<uint32_t>(buf[4]) & 0x3));
+    msg.txFailures = static_cast<uint8_t>((static_cast<uint32_t>(buf[4]) >> 2));
+    msg.busOffCount = static_cast<uint8_t>(static_cast<uint32_t>(buf[5]));
+    msg.rxOverruns = static_cast<uint8_t>(static_cast<uint32_t>(buf[6]));
+    msg.frameRate = static_cast<uint8_t>(static_cast<uint32_t>(buf[7]));
+    return msg;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ TORQUE_MONITOR (0x686) - Sent by ECU
+-------------------------------------------------------------------------------------------------*/
+typedef struct canTorqueMonitor {
+    uint8_t   crc;             // Bits 0-7
+    uint8_t   counter;         // Bits 8-11
+    uint16_t  torque;          // Bits 16-31
+} canTorqueMonitor_t;
+
+constexpr void EncodeTorqueMonitor(const canTorqueMonitor_t & msg, uint8_t * buf) {
+    buf[0] = static_cast<uint8_t>(static_cast<uint32_t>(msg.crc));
+    buf[1] = static_cast<uint8_t>((static_cast<uint32_t>(msg.counter) & 0xF));
+    buf[2] = static_cast<uint8_t>(static_cast<uint32_t>(msg.torque));
+    buf[3] = static_cast<uint8_t>((static_cast<uint32_t>(msg.torque) >> 8));
+}
+
+constexpr canTorqueMonitor_t DecodeTorqueMonitor(const uint8_t * buf) {
+    canTorqueMonitor_t msg = {};
+    msg.crc = static_cast<uint8_t>(static_cast<uint32_t>(buf[0]));
+    msg.counter = static_cast<uint8_t>((static_cast<uint32_t>(buf[1]) & 0xF));
+    msg.torque = static_cast<uint16_t>(static_cast<uint32_t>(buf[2]) | (static_cast<uint32_t>(buf[3]) << 8));
+    return msg;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ PARAM_REQUEST (0x6F0) - Sent by TOOL
+-------------------------------------------------------------------------------------------------*/
+typedef struct canParamRequest {
+    uint8_t   command;         // Bits 0-7
+    uint8_t   index;           // Bits 8-15
+    uint32_t  value;           // Bits 32-63
+} canParamRequest_t;
+
+constexpr void EncodeParamRequest(const canParamRequest_t & msg, uint8_t * buf) {
+    buf[0] = static_cast<uint8_t>(static_cast<uint32_t>(msg.command));
+    buf[1] = static_cast<uint8_t>(static_cast<uint32_t>(msg.index));
+    buf[2] = static_cast<uint8_t>(0);
+    buf[3] = static_cast<uint8_t>(0);
+    buf[4] = static_cast<uint8_t>(static_cast<uint32_t>(msg.value));
+    buf[5] = static_cast<uint8_t>((static_cast<uint32_t>(msg.value) >> 8));
+    buf[6] = static_cast<uint8_t>((static_cast<uint32_t>(msg.value) >> 16));
+    buf[7] = static_cast<uint8_t>((static_cast<uint32_t>(msg.value) >> 24));
+}
+
+constexpr canParamRequest_t DecodeParamRequest(const uint8_t * buf) {
+    canParamRequest_t msg = {};
+    msg.command = static_cast<uint8_t>(static_cast<uint32_t>(buf[0]));
+    msg.index = static_cast<uint8_t>(static_cast<uint32_t>(buf[1]));
+    msg.value = static_cast<uint32_t>(static_cast<uint32_t>(buf[4]) | (static_cast<uint32_t>(buf[5]) << 8) | (static_cast<uint32_t>(buf[6]) << 16) | (static_cast<uint32_t>(buf[7]) << 24));
+    return msg;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ PARAM_RESPONSE (0x6F8) - Sent by ECU
+-------------------------------------------------------------------------------------------------*/
+typedef struct canParamResponse {
+    uint8_t   command;         // Bits 0-7
+    uint8_t   status;          // Bits 8-15
+    uint8_t   index;           // Bits 16-23
+    uint8_t   type;            // Bits 24-31
+    uint32_t  value;           // Bits 32-63
+} canParamResponse_t;
+
+constexpr void EncodeParamResponse(const canParamResponse_t & msg, uint8_t * buf) {
+    buf[0] = static_cast<uint8_t>(static_cast<uint32_t>(msg.command));
+    buf[1] = static_cast<uint8_t>(static_cast<uint32_t>(msg.status));
+    buf[2] = static_cast<uint8_t>(static_cast<uint32_t>(msg.index));
+    buf[3] = static_cast<uint8_t>(static_cast<uint32_t>(msg.type));
+    buf[4] = static_cast<uint8_t>(static_cast<uint32_t>(msg.value));
+    buf[5] = static_cast<uint8_t>((static_cast<uint32_t>(msg.value) >> 8));
+    buf[6] = static_cast<uint8_t>((static_cast<uint32_t>(msg.value) >> 16));
+    buf[7] = static_cast<uint8_t>((static_cast<uint32_t>(msg.value) >> 24));
+}
+
+constexpr canParamResponse_t DecodeParamResponse(const uint8_t * buf) {
+    canParamResponse_t msg = {};
+    msg.command = static_cast<uint8_t>(static_cast<uint32_t>(buf[0]));
+    msg.status = static_cast<uint8_t>(static_cast<uint32_t>(buf[1]));
+    msg.index = static_cast<uint8_t>(static_cast<uint32_t>(buf[2]));
+    msg.type = static_cast<uint8_t>(static_cast<uint32_t>(buf[3]));
+    msg.value = static_cast<uint32_t>(static_cast<uint32_t>(buf[4]) | (static_cast<uint32_t>(buf[5]) << 8) | (static_cast<uint32_t>(buf[6]) << 16) | (static_cast<uint32_t>(buf[7]) << 24));
+    return msg;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ BATTERY_TEMP (0x6B1) - Sent by BMS
+-------------------------------------------------------------------------------------------------*/
+typedef struct canBatteryTemp {
+    int8_t    highTemp;        // Bits 0-7 C
+    int8_t    lowTemp;         // Bits 8-15 C
+    int8_t    averageTemp;     // Bits 16-23 C
+    uint8_t   counter;         // Bits 48-51
+    uint8_t   crc;             // Bits 56-63
+} canBatteryTemp_t;
+
+constexpr void EncodeBatteryTemp(const canBatteryTemp_t & msg, uint8_t * buf) {
+    buf[0] = static_cast<uint8_t>(static_cast<uint32_t>(msg.highTemp));
+    buf[1] = static_cast<uint8_t>(static_cast<uint32_t>(msg.lowTemp));
+    buf[2] = static_cast<uint8_t>(static_cast<uint32_t>(msg.averageTemp));
+    buf[3] = static_cast<uint8_t>(0);
+    buf[4] = static_cast<uint8_t>(0);
+    buf[5] = static_cast<uint8_t>(0);
+    buf[6] = static_cast<uint8_t>((static_cast<uint32_t>(msg.counter) & 0xF));
+    buf[7] = static_cast<uint8_t>(static_cast<uint32_t>(msg.crc));
+}
+
+constexpr canBatteryTemp_t DecodeBatteryTemp(const uint8_t * buf) {
+    canBatteryTemp_t msg = {};
+    msg.highTemp = static_cast<int8_t>(static_cast<int32_t>(((static_cast<uint32_t>(buf[0])) ^ 0x80U) - 0x80U));
+    msg.lowTemp = static_cast<int8_t>(static_cast<int32_t>(((static_cast<uint32_t>(buf[1])) ^ 0x80U) - 0x80U));
+    msg.averageTemp = static_cast<int8_t>(static_cast<int32_t>(((static_cast<uint32_t>(buf[2])) ^ 0x80U) - 0x80U));
+    msg.counter = static_cast<uint8_t>((static_cast<uint32_t>(buf[6]) & 0xF));
+    msg.crc = static_cast<uint8_t>(static_cast<uint32_t>(buf[7]));
+    return msg;
+}
+
+// End safe guards
+#endif /* PROTOCOL_H */
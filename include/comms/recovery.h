@@ -0,0 +1,64 @@
+// Safe guards
+#ifndef RECOVERY_H
+#define RECOVERY_H
+
+/*-------------------------------------------------------------------------------------------------
+ Libraries
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include <FlexCAN_T4.h>
+
+#include "core/general.h"
+#include "comms/statistics.h"
+
+/*------------------------------------------
+ Macros - Bus Off Recovery
+------------------------------------------*/
+// The controller leaves bus off by itself after 128 sequences of 11 recessive bits. On a loaded
+// bus each sequence can wait behind a full frame, so re-initializing sooner cuts that short
+#define CAN_RECOVERY_BITS        (128 * (11 + STATS_FRAME_BITS(8)))
+#define CAN_RECOVERY_MIN         ((CAN_RECOVERY_BITS * 1000 + BAUD_RATE - 1) / BAUD_RATE) // Worst case (ms)
+
+// Default of ParameterHandler BUS_OFF_RECOVERY_MS - 0 leaves recovery to the controller alone,
+// other values are raised to CAN_RECOVERY_MIN
+#define CAN_RECOVERY_TIME        100   // Bus off time before the controller is re-initialized (ms)
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+typedef struct canBusHealth {
+    uint8_t state;        // CAN_ERROR_ACTIVE, CAN_ERROR_PASSIVE or CAN_BUS_OFF
+    bool bDown;           // Bus off and not yet recovered
+    uint32_t downTime;    // millis() when bus off was seen
+    uint32_t retryTime;   // millis() of the last re-initialization
+    uint32_t outages;
+    uint32_t reinits;
+    uint32_t lastOutage;  // Time from bus off to recovery (ms)
+} canBusHealth_t;
+
+/*-------------------------------------------------------------------------------------------------
+ CAN error state monitoring and bus off recovery (through a static class)
+-------------------------------------------------------------------------------------------------*/
+class RecoveryHandler {
+    public:
+        // Getters
+        static bool GetControlDown(void) { return control.bDown; }
+        static const canBusHealth_t & GetControlHealth(void) { return control; }
+
+        // Data methods
+        static void ServiceRecovery(void);
+        static void PrintRecovery(void);
+
+    private:
+        // Helpers
+        static bool CheckBus(canBusHealth_t & health, uint32_t esr, void (*pConfigure)(void), const char * pName);
+
+        static canBusHealth_t control;
+#ifdef EV1_5
+        static canBusHealth_t telemetry;
+#endif
+};
+
+// End safe guards
+#endif /* RECOVERY_H */
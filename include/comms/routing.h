@@ -0,0 +1,81 @@
+// Safe guards
+#ifndef ROUTING_H
+#define ROUTING_H
+
+/*-------------------------------------------------------------------------------------------------
+ Libraries
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include <FlexCAN_T4.h>
+
+#include "core/general.h"
+
+/*------------------------------------------
+ Macros - CAN Buses
+------------------------------------------*/
+// Bit masks so a route can name several buses
+#define CAN_BUS_CONTROL          0x01 // CAN3 - Bamocar torque commands and responses only
+#ifdef EV1_5
+#define CAN_BUS_TELEMETRY        0x02 // CAN1 (pins 22/23) - dashboard, BMS and host tools
+#else
+#define CAN_BUS_TELEMETRY        CAN_BUS_CONTROL // EV1 PCB has one transceiver (pin 22 is RFE)
+#endif
+
+/*------------------------------------------
+ Macros - Routing Table
+------------------------------------------*/
+#define CAN_ROUTE_ID_MASK        0x7FF // Standard IDs index the table directly
+#define CAN_ROUTE_BUS_MASK       0x0F
+#define CAN_ROUTE_FORWARD_SHIFT  4
+#define CAN_ROUTE_DEFAULT        CAN_BUS_TELEMETRY
+
+#define CAN_FORWARD_RING_SIZE    32    // Frames waiting to be bridged (power of two)
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+// Bus a frame lives on and the buses it is bridged onto when received
+typedef struct canRoute {
+    uint16_t id;
+    uint8_t buses;
+    uint8_t forward;
+} canRoute_t;
+
+// One entry per standard ID - buses in the low nibble, forward buses in the high nibble
+typedef struct canRouteTable {
+    uint8_t entries[CAN_ROUTE_ID_MASK + 1];
+} canRouteTable_t;
+
+// Single consumer ring (producers are the CAN receive ISRs - same priority, never nested)
+typedef struct canForwardRing {
+    CAN_message_t messages[CAN_FORWARD_RING_SIZE];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t dropped;
+} canForwardRing_t;
+
+/*-------------------------------------------------------------------------------------------------
+ Per ID bus routing and bridging between the CAN buses (through a static class)
+-------------------------------------------------------------------------------------------------*/
+class RoutingHandler {
+    public:
+        // Getters
+        static uint8_t GetBuses(uint32_t id) { return routeTable.entries[id & CAN_ROUTE_ID_MASK] & CAN_ROUTE_BUS_MASK; }
+        static uint8_t GetForward(uint32_t id) { return routeTable.entries[id & CAN_ROUTE_ID_MASK] >> CAN_ROUTE_FORWARD_SHIFT; }
+        static uint32_t GetForwardDropped(void) { return forwardRing.dropped; }
+
+        // Data methods
+        static void ForwardFrame(const CAN_message_t & message, uint8_t bus);
+        static void ServiceForwarding(void);
+
+    private:
+        // Built at compile time from the route list (flash)
+        static const canRouteTable_t routeTable;
+
+        // Frames received on one bus waiting to be written to another
+        static canForwardRing_t forwardRing;
+};
+
+// End safe guards
+#endif /* ROUTING_H */
@@ -0,0 +1,102 @@
+// Safe guards
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+/*-------------------------------------------------------------------------------------------------
+ Libraries
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include <FlexCAN_T4.h>
+
+#include "core/general.h"
+#include "comms/protocol.h"
+
+/*------------------------------------------
+ Macros - CAN Bus Statistics
+------------------------------------------*/
+#define STATS_MAX_IDS            16    // Distinct IDs tracked per direction
+#define STATS_WINDOW             1000  // Rate & bus load window (ms)
+#define STATS_PRINT_INTERVAL     10000 // Serial report interval (ms)
+
+// Worst case frame length with bit stuffing (standard ID, n data bytes)
+#define STATS_FRAME_BITS(len)    (8 * (len) + 47 + (34 + 8 * (len) - 1) / 4)
+
+/*------------------------------------------
+ Macros - FlexCAN Fault Confinement
+------------------------------------------*/
+#define CAN_ERROR_ACTIVE         0
+#define CAN_ERROR_PASSIVE        1
+#define CAN_BUS_OFF              2
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+typedef struct canIdCount {
+    uint32_t id;
+    volatile uint32_t count;    // Monotonic frame count
+    uint32_t lastCount;         // Count at the start of the current window
+    uint16_t rate;              // Frames over the last window (per second)
+} canIdCount_t;
+
+/*-------------------------------------------------------------------------------------------------
+ CAN bus health and load statistics (through a static class)
+-------------------------------------------------------------------------------------------------*/
+class StatisticsHandler {
+    public:
+        // Getters
+        static uint16_t GetBusLoad(void) { return busLoad; }
+        static uint16_t GetFrameRate(void) { return frameRate; }
+        static uint8_t GetTxQueueHighWater(void) { return txQueueHighWater; }
+        static uint8_t GetErrorState(void) { return errorState; }
+        static uint8_t GetRxErrorCounter(void) { return rxErrorCounter; }
+        static uint8_t GetTxErrorCounter(void) { return txErrorCounter; }
+        static uint32_t GetBusOffCount(void) { return busOffCount; }
+        static uint32_t GetRxOverruns(void) { return rxOverruns; }
+        static uint32_t GetTxFailures(void) { return txFailures; }
+
+        static uint16_t GetRate(uint32_t id, bool bTransmit);
+
+        // Data methods
+        static void RecordReceive(const CAN_message_t & message);
+        static void RecordTransmit(const CAN_message_t & message, uint8_t queueCount);
+        static void RecordTransmitFailure(void);
+
+        static void ServiceStatistics(void);
+
+        static void PrintStatistics(void);
+
+    private:
+        // Helpers
+        static canIdCount_t * FindEntry(canIdCount_t * table, volatile uint8_t & size, uint32_t id);
+        static void UpdateRates(canIdCount_t * table, uint8_t size);
+        static void PollErrorCounters(void);
+        static void SendDiagnosticMessage(void);
+
+        // Receive counters (written by the CAN receive ISR only)
+        static canIdCount_t rxTable[STATS_MAX_IDS];
+        static volatile uint8_t rxSize;
+        static volatile uint32_t rxBits;
+        static volatile uint32_t rxOverruns;
+
+        // Transmit counters (written from the main loop and CAN ISRs inside a critical section)
+        static canIdCount_t txTable[STATS_MAX_IDS];
+        static volatile uint8_t txSize;
+        static volatile uint32_t txBits;
+        static volatile uint8_t txQueueHighWater;
+        static volatile uint32_t txFailures;
+
+        // Window results
+        static uint32_t lastBits;
+        static uint16_t busLoad;      // 0.1 %
+        static uint16_t frameRate;    // Frames per second (both directions)
+
+        // Controller fault confinement
+        static uint8_t errorState;
+        static uint8_t rxErrorCounter;
+        static uint8_t txErrorCounter;
+        static uint32_t busOffCount;
+};
+
+// End safe guards
+#endif /* STATISTICS_H */
@@ -0,0 +1,57 @@
+// Safe guards
+#ifndef SUBSCRIPTION_H
+#define SUBSCRIPTION_H
+
+/*-------------------------------------------------------------------------------------------------
+ Libraries
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "core/general.h"
+#include "comms/telemetry.h"
+
+/*------------------------------------------
+ Macros - Subscription Timing
+------------------------------------------*/
+#define NUM_SUBSCRIPTIONS        NUM_BAMOCAR_SIGNALS
+#define SUBSCRIPTION_SPACING     5   // Minimum gap between subscription frames on the bus (ms)
+#define SUBSCRIPTION_RETRY_TIME  250 // Minimum gap between re-subscriptions of one register (ms)
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+typedef struct subscription {
+    uint8_t bamocarReg;   // Register read from the Bamocar
+    uint8_t interval;     // Cyclic interval requested from the Bamocar (ms)
+    uint32_t lastRequest; // millis() when the request was last sent
+    bool bPending;        // Request waiting for a free slot on the bus
+} subscription_t;
+
+/*-------------------------------------------------------------------------------------------------
+ Bamocar cyclic request manager (through a static class)
+-------------------------------------------------------------------------------------------------*/
+class SubscriptionHandler {
+    public:
+        // Getters
+        static uint8_t GetInterval(bamocarSignal signal) { 
+            return subscriptions[ static_cast<uint8_t>(signal) ].interval; 
+        }
+
+        // Setters
+        static bool SetInterval(uint8_t bamocarReg, uint8_t interval);
+
+        // Data methods
+        static void ResubscribeAll(void);
+        static void ServiceSubscriptions(void);
+
+    private:
+        // Subscriptions indexed by telemetry signal
+        static subscription_t subscriptions[NUM_SUBSCRIPTIONS];
+
+        // Bus pacing
+        static uint32_t lastSendTime;
+        static uint8_t nextIndex;
+};
+
+// End safe guards
+#endif /* SUBSCRIPTION_H */
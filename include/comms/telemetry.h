@@ -0,0 +1,92 @@
+// Safe guards
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+/*-------------------------------------------------------------------------------------------------
+ Libraries
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include <FlexCAN_T4.h>
+
+#include "core/general.h"
+
+/*------------------------------------------
+ Macros - Bamocar Signal Scaling
+------------------------------------------*/
+#define BAMOCAR_FULL_SCALE       32767 // Raw register value at 100% of the NDrive limit
+#define BAMOCAR_SPEED_MAX_RPM    6500  // Must match NDrive N-max (0xC8)
+#define BAMOCAR_CURRENT_MAX_DA   4000  // Must match NDrive I-max-pk (0xC4), in 0.1 A
+#define BAMOCAR_TEMP_OFFSET      9394  // Linear fit of the NDrive temperature table (raw at 0 C)
+#define BAMOCAR_TEMP_SLOPE       55    // Linear fit of the NDrive temperature table (raw per C)
+
+/*------------------------------------------
+ Macros - Freshness
+------------------------------------------*/
+#define NUM_BAMOCAR_SIGNALS      6
+#define TELEMETRY_STALE_MARGIN   50    // Grace period past the cyclic interval (ms)
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+// Index of each subscribed Bamocar register
+enum class bamocarSignal : uint8_t {
+    MOTOR_TEMP = 0,
+    BAMOCAR_TEMP,
+    SPEED,
+    PHASE_ONE,
+    PHASE_TWO,
+    PHASE_THREE
+};
+
+typedef struct telemetrySignal {
+    int16_t value;      // Scaled value (units listed in bamocarTelemetry)
+    uint32_t timestamp; // millis() when the response arrived
+    bool bStale;        // Cyclic response missed or never received
+} telemetrySignal_t;
+
+typedef struct bamocarTelemetry {
+    telemetrySignal_t motorTemperature;   // 0.1 C
+    telemetrySignal_t bamocarTemperature; // 0.1 C
+    telemetrySignal_t speed;              // RPM
+    telemetrySignal_t phaseCurrent[3];    // 0.1 A
+} bamocarTelemetry_t;
+
+/*-------------------------------------------------------------------------------------------------
+ Bamocar telemetry handler (through a static class)
+-------------------------------------------------------------------------------------------------*/
+class TelemetryHandler {
+    public:
+        // Getters
+        static bamocarTelemetry_t GetTelemetry(void);
+        static int16_t GetValue(bamocarSignal signal) { return values[ static_cast<uint8_t>(signal) ]; }
+        static int16_t GetMotorTemperature(void) { return GetValue(bamocarSignal::MOTOR_TEMP) / 10; }
+        static uint32_t GetExpectedInterval(bamocarSignal signal) { return intervals[ static_cast<uint8_t>(signal) ]; }
+
+        static int8_t GetSignalIndex(uint8_t bamocarReg);
+
+        static bool GetStale(bamocarSignal signal);
+
+        // Setters
+        static void SetExpectedInterval(bamocarSignal signal, uint32_t value) {
+            intervals[ static_cast<uint8_t>(signal) ] = value;
+        }
+
+        // Data methods
+        static bool DecodeMessage(const CAN_message_t & message);
+
+    private:
+        // Data written by the CAN receive ISR
+        static volatile int16_t values[NUM_BAMOCAR_SIGNALS];
+        static volatile uint32_t timestamps[NUM_BAMOCAR_SIGNALS];
+        static volatile uint8_t receivedFlags;
+
+        // Sequence counter (odd while the ISR is writing)
+        static volatile uint32_t sequence;
+
+        // Expected cyclic interval per signal (ms)
+        static uint32_t intervals[NUM_BAMOCAR_SIGNALS];
+};
+
+// End safe guards
+#endif /* TELEMETRY_H */
@@ -0,0 +1,59 @@
+// Safe guards
+#ifndef TORQUE_H
+#define TORQUE_H
+
+/*-------------------------------------------------------------------------------------------------
+ Libraries
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include <FlexCAN_T4.h>
+
+#include "core/general.h"
+
+/*------------------------------------------
+ Macros - Torque Transmission
+------------------------------------------*/
+#define TORQUE_DEADBAND          30 // Change in torque request sent immediately (~0.5% of max)
+#define TORQUE_KEEPALIVE_TIME    25 // Resend period - keep well under the Bamocar timeout (0xD0) (ms)
+
+/*-------------------------------------------------------------------------------------------------
+ Change-driven torque command transmitter (through a static class)
+-------------------------------------------------------------------------------------------------*/
+class TorqueHandler {
+    public:
+        // Getters
+        static uint16_t GetLastTorque(void) { return lastTorque; }
+        static uint16_t GetDeadband(void) { return deadband; }
+        static uint16_t GetKeepAliveTime(void) { return keepAliveTime; }
+
+        // Setters
+        static void SetDeadband(uint16_t value) { deadband = value; }
+        static void SetKeepAliveTime(uint16_t value) { keepAliveTime = value; }
+
+        // Send the next command even if unchanged (Bamocar may have missed the last one)
+        static void ResendTorque(void) { bSent = false; }
+
+        // Data methods
+        static bool TransmitTorque(uint16_t torque, uint32_t pedalTime = 0);
+        static void ConfirmTorque(const CAN_message_t & message);
+
+    private:
+        // Last command placed on the bus
+        static uint16_t lastTorque;
+        static uint32_t lastSendTime;
+        static bool bSent;
+
+        // micros() of the pedal sample behind the last command (0 if not from the pedals)
+        static volatile uint32_t sampleTime;
+
+        // Rolling counter of the E2E protected torque copy
+        static uint8_t monitorCounter;
+
+        // Transmission tuning
+        static uint16_t deadband;
+        static uint16_t keepAliveTime;
+};
+
+// End safe guards
+#endif /* TORQUE_H */
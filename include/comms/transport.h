@@ -0,0 +1,103 @@
+// Safe guards
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+/*-------------------------------------------------------------------------------------------------
+ Libraries
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include <FlexCAN_T4.h>
+
+#include "core/general.h"
+
+/*------------------------------------------
+ Macros - ISO-TP Link
+------------------------------------------*/
+#define ID_TRANSPORT_REQUEST     0x7F0 // Host to ECU (lowest priority on the bus)
+#define ID_TRANSPORT_RESPONSE    0x7F8 // ECU to host
+
+#define TRANSPORT_MAX_LENGTH     4095  // 12-bit ISO-TP message length
+#define TRANSPORT_PADDING        0xCC
+
+/*------------------------------------------
+ Macros - ISO-TP Protocol Control Information
+------------------------------------------*/
+#define ISOTP_SINGLE_FRAME       0x0
+#define ISOTP_FIRST_FRAME        0x1
+#define ISOTP_CONSECUTIVE_FRAME  0x2
+#define ISOTP_FLOW_CONTROL       0x3
+
+#define ISOTP_FC_CONTINUE        0x0
+#define ISOTP_FC_WAIT            0x1
+#define ISOTP_FC_OVERFLOW        0x2
+
+/*------------------------------------------
+ Macros - Pacing
+------------------------------------------*/
+#define TRANSPORT_BLOCK_SIZE     0     // Frames the host may send per flow control (0 = all)
+#define TRANSPORT_SEPARATION     1     // Gap requested from the host between frames (ms) - within the RX rate limit
+#define TRANSPORT_TIMEOUT        1000  // Flow control and consecutive frame timeout (ms)
+#define TRANSPORT_FRAMES_PER_LOOP 4    // Consecutive frames sent per main loop
+#define TRANSPORT_TX_QUEUE_LIMIT 2     // Yield while this many frames wait to be sent on the response bus
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+enum class transportState : uint8_t {
+    IDLE = 0,
+    WAIT_FLOW_CONTROL,
+    SENDING
+};
+
+/*-------------------------------------------------------------------------------------------------
+ Non-blocking ISO 15765-2 link for bulk transfers (through a static class)
+-------------------------------------------------------------------------------------------------*/
+class TransportHandler {
+    public:
+        // Getters
+        static bool GetRequest(const uint8_t *& pData, uint16_t & length);
+        static uint8_t * GetTxBuffer(void) { return txBuffer; }
+        static bool GetIdle(void) { return state == transportState::IDLE; }
+
+        // Data methods
+        static void ReceiveFrame(const CAN_message_t & message);
+        static void ReleaseRequest(void) { bRxComplete = false; }
+        static bool Send(uint16_t length);
+        static void ServiceTransport(void);
+
+    private:
+        // Helpers
+        static void SendFlowControl(uint8_t status);
+        static void SendConsecutiveFrames(void);
+
+        // Receiving (written by the CAN receive ISR)
+        static uint8_t rxBuffer[TRANSPORT_MAX_LENGTH];
+        static volatile uint16_t rxLength;
+        static volatile uint16_t rxReceived;
+        static volatile uint8_t rxSequence;
+        static volatile uint32_t rxTimer;
+        static volatile bool bReceiving;
+        static volatile bool bRxComplete;
+        static volatile bool bFlowControlDue;
+        static volatile uint8_t flowControlStatus;
+
+        // Flow control from the host while sending
+        static volatile bool bFlowControl;
+        static volatile uint8_t fcStatus;
+        static volatile uint8_t fcBlockSize;
+        static volatile uint8_t fcSeparation;
+
+        // Sending (main loop only)
+        static uint8_t txBuffer[TRANSPORT_MAX_LENGTH];
+        static uint16_t txLength;
+        static uint16_t txSent;
+        static uint8_t txSequence;
+        static uint8_t blockRemaining;
+        static uint32_t separation;  // us
+        static uint32_t txTimer;     // micros() of the last frame or flow control wait start
+        static transportState state;
+};
+
+// End safe guards
+#endif /* TRANSPORT_H */
@@ -8,12 +8,26 @@
 #include "core/general.h"
 #include "core/pin.h"
 #include "core/FSM.h"
+#include "core/parameter.h"
+#include "core/config.h"
+#include "core/timebase.h"
 
 #include "interrupts/interrupts.h"
 
 #include "comms/CAN.h"
+#include "comms/telemetry.h"
+#include "comms/subscription.h"
+#include "comms/torque.h"
+#include "comms/dashboard.h"
+#include "comms/statistics.h"
+#include "comms/latency.h"
+#include "comms/transport.h"
+#include "comms/e2e.h"
 
 #include "daq/DAQ.h"
+#include "daq/datalog.h"
+#include "daq/session.h"
+#include "daq/fileservice.h"
 
 #include "sensors/hall.h"
 
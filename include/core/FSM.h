@@ -13,6 +13,8 @@
 #include "daq/DAQ.h"
 #include "general.h"
 #include "pump.h"
+#include "parameter.h"
+#include "config.h"
 #include "pin.h"
 
 /*-------------------------------------------------------------------------------------------------
@@ -24,9 +26,9 @@ class systemData {
         systemData(void);
 
         // Getters
-        hall GetAPPS1(void) { return APPS1; }
-        hall GetAPPS2(void) { return APPS2; }
-        hall GetBSE(void) { return BSE; }
+        hall & GetAPPS1(void) { return APPS1; }
+        hall & GetAPPS2(void) { return APPS2; }
+        hall & GetBSE(void) { return BSE; }
 
         pumpController GetPumpController(void) { return pump; }
 
@@ -60,10 +62,6 @@ class systemData {
         uint8_t GetFaultBuffer(void) { return faultBuf; }
 
         // Setters
-        void SetAPPS1(hall sensor) { APPS1 = sensor; }
-        void SetAPPS2(hall sensor) { APPS2 = sensor; }
-        void SetBSE(hall sensor) { BSE = sensor; }
-
         void SetResetTimer(size_t value) { timers.resetTimer = value; }
         void SetResetTimerFlag(bool flag) { timers.bResetTimerStarted = flag; }
 
@@ -87,7 +85,7 @@ class systemData {
 
         void DeactivateBamocar(void);
 
-        void ProcessAPPS(uint8_t * pTorqueRequest);
+        uint16_t ProcessAPPS(void);
 
         void UpdatePedalStructures(void);
 
@@ -115,6 +113,10 @@ class systemData {
 
         void RunPump(void);
 
+        void UpdateDashboardStatus(void);
+
+        void UpdateMeasurements(void);
+
         void DebugPrintErrors(void);
 
     private:
@@ -160,7 +162,7 @@ class systemVehicle {
         systemVehicle(void);
 
         // Getters
-        systemData GetSystemData(void) { return system; }
+        systemData & GetSystemData(void) { return system; }
 
         // Methods
         void ProcessState(void);
@@ -0,0 +1,106 @@
+// Safe guards
+#ifndef CONFIG_H
+#define CONFIG_H
+
+/*-------------------------------------------------------------------------------------------------
+ Libraries
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+#include <EEPROM.h>
+
+#include "core/general.h"
+#include "core/crc.h"
+#include "core/parameter.h"
+#include "sensors/hall.h"
+#include "daq/csv.h"
+
+/*------------------------------------------
+ Macros - Config Store
+------------------------------------------*/
+#define CONFIG_EEPROM_ADDRESS    0
+#define CONFIG_MAGIC             0x4D524150  // "PARM" (kept from the version 1 parameter store)
+#define CONFIG_VERSION           2
+#define CONFIG_FLAG_PEDALS       0x01        // Pedal bounds calibrated or imported
+#define CONFIG_VERSION1_COUNT    10          // Parameters in a version 1 image
+
+/*------------------------------------------
+ Macros - Config Files
+------------------------------------------*/
+#define CONFIG_FILE              "config.csv"         // Written after every save
+#define CONFIG_IMPORT_FILE       "config_import.csv"  // Loaded and removed at the next PEDALS state
+#define CONFIG_NAME_SIZE         24
+#define CONFIG_DECIMALS          3                    // Float parameters in the files
+#define CONFIG_FIXED_SCALE       1000                 // 10^CONFIG_DECIMALS
+#define CONFIG_EXPORT_SIZE       768
+#define CONFIG_PEDAL_UPPER       "PEDAL_UPPER"
+#define CONFIG_PEDAL_LOWER       "PEDAL_LOWER"
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+// Raw bounds as calibrated (APPS1, APPS2, BSE) - pedal_bounds.csv order
+typedef struct configPedals {
+    uint16_t upper[NUM_SENSORS];
+    uint16_t lower[NUM_SENSORS];
+} configPedals_t;
+
+// EEPROM image - loaded with one read, layouts only change with the version
+typedef struct configBlob {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t count;        // Parameters
+    uint8_t flags;        // Reserved (0) in version 1
+    parameterValue_t parameters[static_cast<uint8_t>(parameter::COUNT)];
+    configPedals_t pedals;
+    uint32_t crc;         // CRC-32 of everything above
+} configBlob_t;
+
+// Version 1 image (parameters only) - migrated on load
+typedef struct configVersion1 {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t count;
+    uint8_t reserved;
+    parameterValue_t values[CONFIG_VERSION1_COUNT];
+    uint32_t crc;
+} configVersion1_t;
+
+static_assert(sizeof(configVersion1_t) <= sizeof(configBlob_t), "Version 1 must fit in the read of the current image");
+static_assert(CONFIG_VERSION1_COUNT == static_cast<uint8_t>(parameter::COUNT), "Give new parameters defaults in MigrateVersion1");
+
+/*-------------------------------------------------------------------------------------------------
+ Versioned calibration and parameter store in EEPROM (through a static class)
+-------------------------------------------------------------------------------------------------*/
+class ConfigHandler {
+    public:
+        // Getters
+        static const parameterValue_t * GetParameters(void) { return bValid ? blob.parameters : nullptr; }
+        static bool GetPedalBounds(configPedals_t & pedals);
+
+        // Setters
+        static void SetParameters(const parameterValue_t * pValues);
+        static void SetPedalBounds(const configPedals_t & pedals);
+
+        // Data methods
+        static void LoadConfig(void);
+        static bool SaveConfig(void);
+        static bool ImportConfig(void);
+        static bool ExportConfig(void);
+
+    private:
+        // Helpers
+        static uint32_t GetCRC(const configBlob_t & image);
+        static bool MigrateVersion1(void);
+        static bool ImportRows(csvReader & reader, configBlob_t & image);
+        static bool ImportFile(const char * pFileName, configBlob_t & image);
+        static bool ImportLegacyPedals(configBlob_t & image);
+
+        // Image in use (parameters and pedal bounds are copied out of it)
+        static configBlob_t blob;
+        static bool bValid;
+};
+
+// End safe guards
+#endif /* CONFIG_H */
@@ -0,0 +1,80 @@
+// Safe guards
+#ifndef CRC_H
+#define CRC_H
+
+/*-------------------------------------------------------------------------------------------------
+ Libraries
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/*------------------------------------------
+ Macros - CRC-32 (IEEE 802.3, matches zlib)
+------------------------------------------*/
+#define CRC32_POLYNOMIAL         0xEDB88320 // Reflected 0x04C11DB7
+
+/*------------------------------------------
+ Macros - CRC-8 (SAE J1850, AUTOSAR E2E profile 1)
+------------------------------------------*/
+#define CRC8_POLYNOMIAL          0x1D
+#define CRC8_INITIAL             0xFF
+#define CRC8_FINAL_XOR           0xFF
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+typedef struct crc32Table {
+    uint32_t entries[256];
+} crc32Table_t;
+
+typedef struct crc8Table {
+    uint8_t entries[256];
+} crc8Table_t;
+
+/*-----------------------------------------------------------------------------
+ Build the byte-wise CRC-32 lookup table at compile time
+-----------------------------------------------------------------------------*/
+constexpr crc32Table_t MakeCRC32Table(void) {
+    crc32Table_t table = {};
+
+    for (uint32_t index = 0; index < 256; ++index) {
+        uint32_t crc = index;
+
+        for (uint8_t bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? (crc >> 1) ^ CRC32_POLYNOMIAL : crc >> 1;
+        }
+
+        table.entries[index] = crc;
+    }
+
+    return table;
+}
+
+/*-----------------------------------------------------------------------------
+ Build the byte-wise CRC-8 lookup table at compile time
+-----------------------------------------------------------------------------*/
+constexpr crc8Table_t MakeCRC8Table(void) {
+    crc8Table_t table = {};
+
+    for (uint16_t index = 0; index < 256; ++index) {
+        uint8_t crc = index;
+
+        for (uint8_t bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x80) ? (crc << 1) ^ CRC8_POLYNOMIAL : crc << 1;
+        }
+
+        table.entries[index] = crc;
+    }
+
+    return table;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ Prototypes
+-------------------------------------------------------------------------------------------------*/
+uint32_t UpdateCRC32(uint32_t crc, const uint8_t * pData, size_t length);
+
+uint8_t UpdateCRC8(uint8_t crc, const uint8_t * pData, size_t length);
+
+// End safe guards
+#endif /* CRC_H */
@@ -61,6 +61,7 @@
 #define ERROR_CODE_DISAGREE  	 1
 #define ERROR_CODE_APPS_BSE  	 2
 #define ERROR_CODE_OOR       	 3
+#define ERROR_CODE_CAN_BUS   	 4 // Control bus off (cleared on recovery)
 
 /*------------------------------------------
  Macros - Debugging
@@ -0,0 +1,131 @@
+// Safe guards
+#ifndef PARAMETER_H
+#define PARAMETER_H
+
+/*-------------------------------------------------------------------------------------------------
+ Libraries
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include <FlexCAN_T4.h>
+
+#include "core/general.h"
+#include "comms/protocol.h"
+
+/*------------------------------------------
+ Macros - Parameter Service Commands
+------------------------------------------*/
+// Frame layouts are generated from dbc/ECU.dbc (PARAM_REQUEST & PARAM_RESPONSE)
+#define PARAM_CMD_READ           0x01  // Active value of a parameter
+#define PARAM_CMD_WRITE          0x02  // Stage a new value (checked against the limits)
+#define PARAM_CMD_COMMIT         0x03  // Apply every staged value at once (not while driving)
+#define PARAM_CMD_DISCARD        0x04  // Drop staged values
+#define PARAM_CMD_SAVE           0x05  // Store active values in the EEPROM config store (not while driving)
+#define PARAM_CMD_MEASURE        0x06  // Live value of a measurement
+#define PARAM_CMD_INFO           0x07  // Parameter count, measurement count and revision
+#define PARAM_CMD_RESPONSE       0x40  // Added to the command in every response
+
+/*------------------------------------------
+ Macros - Parameter Service Status
+------------------------------------------*/
+#define PARAM_STATUS_OK          0x00
+#define PARAM_STATUS_BAD_COMMAND 0x01
+#define PARAM_STATUS_BAD_INDEX   0x02
+#define PARAM_STATUS_RANGE       0x03
+#define PARAM_STATUS_STORAGE     0x04
+#define PARAM_STATUS_STATE       0x05  // Refused in IDLE, DRIVE and BRAKE
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+// Tunable values - Defaults are the compile-time macros they replace
+enum class parameter : uint8_t {
+    THRESHOLD_PERCENT = 0,  // PERCENT_THRESHOLD
+    BRAKE_PERCENT,          // PERCENT_BRAKE
+    ACCEL_PERCENT,          // PERCENT_ACCEL
+    AGREEMENT_PERCENT,      // APPS_AGREEMENT
+    IMPLAUSIBILITY_MS,      // IMPLAUSIBILITY_TIME
+    CHARGE_MS,              // CHARGE_TIME
+    PUMP_KP,
+    PUMP_KI,
+    PUMP_KD,
+    BUS_OFF_RECOVERY_MS,    // CAN_RECOVERY_TIME
+    COUNT
+};
+
+// Live values readable with PARAM_CMD_MEASURE
+enum class measurement : uint8_t {
+    PERCENT_APPS = 0,
+    PERCENT_BSE,
+    SDC_TAP,
+    STATE,
+    FAULTS,
+    MOTOR_TEMPERATURE,
+    SPEED,
+    COUNT
+};
+
+enum class parameterType : uint8_t {
+    INT32 = 0,
+    FLOAT
+};
+
+typedef union parameterValue {
+    int32_t i;
+    float f;
+    uint32_t raw;         // Bits sent over CAN and stored in the config store
+} parameterValue_t;
+
+typedef struct parameterInfo {
+    const char * pName;
+    parameterType type;
+    float minimum;
+    float maximum;
+    float defaultValue;
+} parameterInfo_t;
+
+/*-------------------------------------------------------------------------------------------------
+ Runtime tunable parameters and measurements over CAN (through a static class)
+-------------------------------------------------------------------------------------------------*/
+class ParameterHandler {
+    public:
+        // Getters - one indexed load, safe to use on the hot path
+        static int32_t GetInt(parameter id) { return active[static_cast<uint8_t>(id)].i; }
+        static uint32_t GetUInt(parameter id) { return active[static_cast<uint8_t>(id)].raw; } // Minimum >= 0 only
+        static float GetFloat(parameter id) { return active[static_cast<uint8_t>(id)].f; }
+        static uint16_t GetRevision(void) { return revision; }
+        static const parameterInfo_t & GetInfo(uint8_t index) { return info[index]; }
+
+        // Setters
+        static void SetMeasurement(measurement id, int32_t value) { measurements[static_cast<uint8_t>(id)].i = value; }
+        static void SetMeasurement(measurement id, float value) { measurements[static_cast<uint8_t>(id)].f = value; }
+
+        // Data methods
+        static void LoadParameters(void);
+        static bool SaveParameters(void);
+        static void ReceiveRequest(const CAN_message_t & message);
+        static void ServiceParameters(void);
+
+    private:
+        // Helpers
+        static uint8_t WriteStaged(uint8_t index, parameterValue_t value);
+        static bool GetDriving(void);
+        static void SetDefaults(void);
+
+        // Limits and defaults (flash)
+        static const parameterInfo_t info[static_cast<uint8_t>(parameter::COUNT)];
+        static const parameterType measurementTypes[static_cast<uint8_t>(measurement::COUNT)];
+
+        // Values in use and values waiting for a commit
+        static parameterValue_t active[static_cast<uint8_t>(parameter::COUNT)];
+        static parameterValue_t staged[static_cast<uint8_t>(parameter::COUNT)];
+        static parameterValue_t measurements[static_cast<uint8_t>(measurement::COUNT)];
+        static uint16_t revision;
+
+        // Latest request (written by the CAN receive ISR)
+        static canParamRequest_t request;
+        static volatile bool bRequestPending;
+};
+
+// End safe guards
+#endif /* PARAMETER_H */
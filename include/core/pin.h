@@ -138,18 +138,19 @@ class analogPin : public GPIO {
         analogPin(const uint8_t pinValue, bool bPinMode, size_t size);
 
         // Getters
-        circularBuffer GetBuffer(void) { return buffer; }
-
-        // Setters
-        void SetBuffer(circularBuffer data) { buffer = data; }
+        circularBuffer & GetBuffer(void) { return buffer; }
+        uint32_t GetSampleTime(void) { return sampleTime; }
 
         // Data methods
         void SetOutput(uint8_t value) { analogWrite(pin, value); }
-        uint16_t ReadRawPinAnalog(void) { return analogRead(pin); }
+        uint16_t ReadRawPinAnalog(void);
     
     private:
         // Circular buffer to average signal
         circularBuffer buffer;
+
+        // micros() when the last conversion sampled the pin
+        uint32_t sampleTime;
 };
 
 // End safe guards
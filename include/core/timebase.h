@@ -0,0 +1,52 @@
+// Safe guards
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+/*-------------------------------------------------------------------------------------------------
+ Libraries
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include <FlexCAN_T4.h>
+
+#include "core/general.h"
+
+/*------------------------------------------
+ Macros - FlexCAN Timestamps
+------------------------------------------*/
+#define TIMEBASE_TIMER_TICK_US   (1000000 / BAUD_RATE) // FlexCAN free running timer counts CAN bits
+#define TIMEBASE_TIMER_MASK      0xFFFF                // Wraps every 131 ms at 500 kbit/s
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+// micros() paired with the 64 bit ECU time at the same instant
+typedef struct timebaseEpoch {
+    uint64_t time;
+    uint32_t micros;
+} timebaseEpoch_t;
+
+/*-------------------------------------------------------------------------------------------------
+ Shared ECU timebase - 64 bit micros() for CAN frames and analog samples (through a static class)
+-------------------------------------------------------------------------------------------------*/
+class TimebaseHandler {
+    public:
+        // Getters
+        static uint64_t GetTime(void) { return ExtendTime( micros() ); }
+
+        static uint32_t GetFrameMicros(const CAN_message_t & message);
+        static uint64_t GetFrameTime(const CAN_message_t & message) { return ExtendTime( GetFrameMicros(message) ); }
+
+        // Data methods
+        static uint64_t ExtendTime(uint32_t time);
+        static void BeginTimebase(void);
+        static void ServiceTimebase(void);
+
+    private:
+        // Double buffered so an ISR never reads an epoch the loop is writing
+        static timebaseEpoch_t epochs[2];
+        static volatile uint8_t active;
+};
+
+// End safe guards
+#endif /* TIMEBASE_H */
@@ -12,31 +12,29 @@
 
 #include "interrupts/interrupts.h"
 #include "core/general.h"
+#include "core/timebase.h"
+#include "daq/trace.h"
+#include "daq/storage.h"
+#include "daq/csv.h"
 
 /*------------------------------------------
  Macros - Files
 ------------------------------------------*/
 #define OVERWRITE            	 1
-#define FILE_PEDAL_BOUNDS    	 "pedal_bounds.csv"
+#define FILE_PEDAL_BOUNDS    	 "pedal_bounds.csv"   // Imported only if the config store has no bounds
 #define FILE_ECU_FAULTS          "fault.txt"
 #define FILE_GENERAL_DATA        "general_data.txt"
 
 /*-------------------------------------------------------------------------------------------------
  Prototypes
 -------------------------------------------------------------------------------------------------*/
-size_t CountCharacter(const char * pString, const char character);
+void PrintCSVError(const char * pFileName, const csvReader & reader);
 
-size_t * CharacterIndex(const char * pString, const char character);
-
-char * Substring(const char * pString, const size_t start, const size_t end);
-
-uint16_t * SplitIntegerString(const char * pString, const char delimiter, size_t &length);
-
-void WriteDataToFile(const char * pFileName, const char * pString, bool bOverwrite);
+bool WriteDataToFile(const char * pFileName, const char * pString, bool bOverwrite);
 
 void ErrorToSD(void);
 
-void CANDataToSD(const CAN_message_t &message);
+void CANDataToSD(const CAN_message_t &message, bool bTransmit);
 
 void SetupSD(void);
 
@@ -0,0 +1,252 @@
+// Safe guards
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+/*-------------------------------------------------------------------------------------------------
+ Libraries
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/*------------------------------------------
+ Macros - Channel Log File Format
+------------------------------------------*/
+#define CHANNEL_MAGIC            "ECUDATA"
+#define CHANNEL_VERSION          1
+#define CHANNEL_NAME_SIZE        16
+#define CHANNEL_HEADER_SIZE      512   // One sector - records start sector aligned
+
+/*------------------------------------------
+ Macros - Channel Encoding
+------------------------------------------*/
+#define CHANNEL_MAX_CHANNELS     16
+#define CHANNEL_KEYFRAME_INTERVAL 100  // Samples between keyframes (decoders resync at these)
+#define CHANNEL_VARINT_MAX       10    // Bytes of the longest 64 bit varint
+#define CHANNEL_RECORD_MAX(n)    (1 + CHANNEL_VARINT_MAX + 5 * (n)) // Tag, time and n 32 bit varints
+
+// Record tags
+#define CHANNEL_TAG_DELTA        0x00  // Time since the last sample, zig-zag deltas of each channel
+#define CHANNEL_TAG_KEYFRAME     0x01  // Full ECU time, zig-zag values of each channel
+#define CHANNEL_TAG_PADDING      0xFF  // End of a logger buffer (LOGGER_PADDING)
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+// Result of decoding one record
+enum class channelRecord : uint8_t {
+    SAMPLE = 0,
+    UNSYNCED,   // Delta before the first keyframe - skipped
+    PADDING,    // Rest of the buffer is unused
+    CORRUPT     // Unknown tag or truncated varint
+};
+
+// First sector of a channel log - records follow in channelEncoder format
+typedef struct channelFileHeader {
+    char magic[8];
+    uint16_t version;
+    uint16_t numChannels;
+    uint16_t keyframeInterval;
+    uint16_t bufferSectors;   // Every buffer starts with a keyframe - a decoder may start at any buffer
+    uint32_t samplePeriod;    // us
+    uint32_t startTime;       // millis() when the file was opened
+    uint64_t startEpoch;      // ECU time (us) when the file was opened
+    char names[CHANNEL_MAX_CHANNELS][CHANNEL_NAME_SIZE];
+    uint8_t reserved[CHANNEL_HEADER_SIZE - 32 - CHANNEL_MAX_CHANNELS * CHANNEL_NAME_SIZE];
+} channelFileHeader_t;
+
+/*-----------------------------------------------------------------------------
+ Map signed values to unsigned so small magnitudes stay small (0, -1, 1, -2 -> 0, 1, 2, 3)
+-----------------------------------------------------------------------------*/
+constexpr uint32_t ZigZagEncode(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+constexpr int32_t ZigZagDecode(uint32_t value) {
+    return static_cast<int32_t>( (value >> 1) ^ (0 - (value & 1)) );
+}
+
+/*-----------------------------------------------------------------------------
+ Store 7 bits per byte, high bit set while more follow - Returns bytes written
+-----------------------------------------------------------------------------*/
+constexpr uint8_t VarintEncode(uint64_t value, uint8_t * pOut) {
+    uint8_t length = 0;
+
+    while (value >= 0x80) {
+        pOut[length++] = static_cast<uint8_t>(value) | 0x80;
+        value >>= 7;
+    }
+
+    pOut[length++] = static_cast<uint8_t>(value);
+
+    return length;
+}
+
+/*-----------------------------------------------------------------------------
+ Read a varint without passing the end - Returns bytes read (0 if truncated or too long)
+-----------------------------------------------------------------------------*/
+constexpr uint8_t VarintDecode(const uint8_t * pIn, const uint8_t * pEnd, uint64_t & value) {
+    value = 0;
+
+    for (uint8_t length = 0; length < CHANNEL_VARINT_MAX && pIn + length < pEnd; ++length) {
+        value |= static_cast<uint64_t>(pIn[length] & 0x7F) << (7 * length);
+
+        if ( !(pIn[length] & 0x80) ) {
+            return length + 1;
+        }
+    }
+
+    return 0;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ Incremental channel encoder - fixed cost per sample, keyframes for random access
+-------------------------------------------------------------------------------------------------*/
+class channelEncoder {
+    public:
+        // Constructor
+        channelEncoder(uint8_t numChannels, uint16_t keyframeInterval = CHANNEL_KEYFRAME_INTERVAL) :
+            previous{},
+            previousTime(0),
+            count(0),
+            interval(keyframeInterval),
+            channels( (numChannels > CHANNEL_MAX_CHANNELS) ? CHANNEL_MAX_CHANNELS : numChannels ) {}
+
+        // Getters
+        uint8_t GetNumChannels(void) { return channels; }
+
+        // Next sample is a keyframe (call when a record was lost so the decoder state would diverge)
+        void ForceKeyframe(void) { count = 0; }
+
+        // Data methods
+        uint16_t Encode(uint64_t time, const int32_t * pValues, uint8_t * pRecord);
+
+    private:
+        int32_t previous[CHANNEL_MAX_CHANNELS];
+        uint64_t previousTime;
+        uint16_t count;
+        uint16_t interval;
+        uint8_t channels;
+};
+
+/*-----------------------------------------------------------------------------
+ Encode one sample into at most CHANNEL_RECORD_MAX(channels) bytes - Returns record length
+-----------------------------------------------------------------------------*/
+inline uint16_t channelEncoder::Encode(uint64_t time, const int32_t * pValues, uint8_t * pRecord) {
+    bool bKeyframe = (count == 0);
+    uint16_t length = 1;
+
+    pRecord[0] = bKeyframe ? CHANNEL_TAG_KEYFRAME : CHANNEL_TAG_DELTA;
+    length += VarintEncode(bKeyframe ? time : time - previousTime, &pRecord[length]);
+
+    for (uint8_t index = 0; index < channels; ++index) {
+        // Wrapping difference - the decoder's wrapping sum restores any int32 step
+        int32_t delta = static_cast<int32_t>( static_cast<uint32_t>(pValues[index]) - static_cast<uint32_t>(previous[index]) );
+
+        length += VarintEncode(ZigZagEncode(bKeyframe ? pValues[index] : delta), &pRecord[length]);
+        previous[index] = pValues[index];
+    }
+
+    previousTime = time;
+    count = (count + 1 >= interval) ? 0 : count + 1;
+
+    return length;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ Channel decoder - mirrors channelEncoder (host tools)
+-------------------------------------------------------------------------------------------------*/
+class channelDecoder {
+    public:
+        // Constructor
+        channelDecoder(uint8_t numChannels) :
+            values{},
+            time(0),
+            channels( (numChannels > CHANNEL_MAX_CHANNELS) ? CHANNEL_MAX_CHANNELS : numChannels ),
+            bSynced(false) {}
+
+        // Getters
+        uint64_t GetTime(void) { return time; }
+        int32_t GetValue(uint8_t index) { return values[index]; }
+        const int32_t * GetValues(void) { return values; }
+        bool GetSynced(void) { return bSynced; }
+
+        // Wait for the next keyframe (after seeking or a gap)
+        void Reset(void) { bSynced = false; }
+
+        // Data methods
+        channelRecord Decode(const uint8_t * pRecord, const uint8_t * pEnd, uint32_t & length);
+
+    private:
+        int32_t values[CHANNEL_MAX_CHANNELS];
+        uint64_t time;
+        uint8_t channels;
+        bool bSynced;
+};
+
+/*-----------------------------------------------------------------------------
+ Decode the record at pRecord - length is set to its size (0 for padding and corrupt records)
+-----------------------------------------------------------------------------*/
+inline channelRecord channelDecoder::Decode(const uint8_t * pRecord, const uint8_t * pEnd, uint32_t & length) {
+    uint8_t tag = (pRecord < pEnd) ? pRecord[0] : CHANNEL_TAG_PADDING;
+    uint64_t field = 0;
+    uint8_t used = 0;
+
+    length = 0;
+
+    if (tag == CHANNEL_TAG_PADDING) {
+        return channelRecord::PADDING;
+    }
+
+    if (tag != CHANNEL_TAG_KEYFRAME && tag != CHANNEL_TAG_DELTA) {
+        bSynced = false;
+        return channelRecord::CORRUPT;
+    }
+
+    // Deltas are parsed even when unsynced so the stream can be walked to the next keyframe
+    bool bKeyframe = (tag == CHANNEL_TAG_KEYFRAME);
+    bool bApply = bKeyframe || bSynced;
+    uint32_t offset = 1;
+
+    used = VarintDecode(&pRecord[offset], pEnd, field);
+    offset += used;
+
+    if (!used) {
+        bSynced = false;
+        return channelRecord::CORRUPT;
+    }
+
+    uint64_t nextTime = bKeyframe ? field : time + field;
+    int32_t next[CHANNEL_MAX_CHANNELS];
+
+    for (uint8_t index = 0; index < channels; ++index) {
+        used = VarintDecode(&pRecord[offset], pEnd, field);
+        offset += used;
+
+        if (!used || field > UINT32_MAX) {
+            bSynced = false;
+            return channelRecord::CORRUPT;
+        }
+
+        int32_t value = ZigZagDecode( static_cast<uint32_t>(field) );
+
+        next[index] = bKeyframe ? value : static_cast<int32_t>( static_cast<uint32_t>(values[index]) + static_cast<uint32_t>(value) );
+    }
+
+    length = offset;
+
+    if (!bApply) {
+        return channelRecord::UNSYNCED;
+    }
+
+    for (uint8_t index = 0; index < channels; ++index) {
+        values[index] = next[index];
+    }
+
+    time = nextTime;
+    bSynced = true;
+
+    return channelRecord::SAMPLE;
+}
+
+// End safe guards
+#endif /* CHANNEL_H */
@@ -0,0 +1,433 @@
+// Safe guards
+#ifndef CSV_H
+#define CSV_H
+
+/*-------------------------------------------------------------------------------------------------
+ Libraries
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/*------------------------------------------
+ Macros - CSV Reader
+------------------------------------------*/
+#define CSV_BUFFER_SIZE          64    // Bytes read from the source at a time (lives in the reader)
+#define CSV_DELIMITER            ','
+#define CSV_COMMENT              '#'   // Lines starting with it are skipped like blank lines
+#define CSV_END                  -1    // Peek past the last character
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+// First error of a reader - every later read fails with it
+enum class csvError : uint8_t {
+    NONE = 0,
+    READ,           // Source returned an error
+    EMPTY_FIELD,    // Nothing between two delimiters
+    NOT_A_NUMBER,   // Character other than a digit in an integer field
+    OUT_OF_RANGE,   // Integer outside the limits of its field
+    TEXT_TOO_LONG,  // Text field longer than its buffer
+    MISSING_FIELD,  // Row or file ended before every field was read
+    EXTRA_FIELD,    // Row has more fields than were read
+    EXTRA_ROW,      // File has more rows than were read
+    UNKNOWN_NAME,   // Text field the caller has no use for (set with Fail)
+    COUNT
+};
+
+// Where the reader is within the rows
+enum class csvRowState : uint8_t {
+    START = 0,      // Before the first field of a row
+    FIELD,          // After a delimiter - another field follows
+    END             // Row ended with its last field
+};
+
+/*-------------------------------------------------------------------------------------------------
+ Streaming CSV reader - single pass, no heap, any source with read(void *, size_t) (SD File, host
+ memory in a fuzzer)
+-------------------------------------------------------------------------------------------------*/
+class csvReader {
+    public:
+        // Constructor
+        template <typename T>
+        csvReader(T & source) :
+            pSource(&source),
+            pRead(ReadSource<T>),
+            fill(0),
+            index(0),
+            line(1),
+            column(1),
+            errorLine(0),
+            errorColumn(0),
+            error(csvError::NONE),
+            rowState(csvRowState::START),
+            bEnd(false) {}
+
+        // Getters
+        csvError GetError(void) const { return error; }
+        uint32_t GetLine(void) const { return errorLine; }          // Position of the error (1 based)
+        uint32_t GetColumn(void) const { return errorColumn; }
+        static const char * GetErrorName(csvError code);
+
+        // Data methods
+        bool ReadInteger(int32_t & value, int32_t minimum = INT32_MIN, int32_t maximum = INT32_MAX);
+        bool ReadFixed(int32_t & value, uint8_t decimals, int32_t minimum = INT32_MIN, int32_t maximum = INT32_MAX);
+        bool ReadText(char * pText, size_t size);
+        bool ReadRow(int32_t * pValues, size_t count, int32_t minimum = INT32_MIN, int32_t maximum = INT32_MAX);
+        bool EndRow(void);
+        bool EndFile(void);
+        bool GetEnd(void);
+        bool Fail(csvError code);
+
+    private:
+        // Helpers
+        template <typename T>
+        static int ReadSource(void * pSource, char * pBuffer, size_t size) {
+            return static_cast<T *>(pSource)->read(pBuffer, size);
+        }
+
+        static bool IsSpace(int character) { return character == ' ' || character == '\t' || character == '\r'; }
+        static bool AddDigit(uint64_t & magnitude, int digit);
+
+        int Peek(void);
+        void Advance(void);
+        bool BeginField(void);
+        bool EndField(void);
+        void SkipBlankLines(void);
+
+        void * pSource;
+        int (*pRead)(void * pSource, char * pBuffer, size_t size);
+        char buffer[CSV_BUFFER_SIZE];
+        size_t fill;
+        size_t index;
+
+        uint32_t line;
+        uint32_t column;
+        uint32_t errorLine;
+        uint32_t errorColumn;
+        csvError error;
+        csvRowState rowState;
+        bool bEnd;
+};
+
+/*-----------------------------------------------------------------------------
+ Name of an error for debug output
+-----------------------------------------------------------------------------*/
+inline const char * csvReader::GetErrorName(csvError code) {
+    static const char * names[static_cast<uint8_t>(csvError::COUNT)] = {
+        "NONE", "READ", "EMPTY FIELD", "NOT A NUMBER", "OUT OF RANGE",
+        "TEXT TOO LONG", "MISSING FIELD", "EXTRA FIELD", "EXTRA ROW", "UNKNOWN NAME"
+    };
+
+    return (code < csvError::COUNT) ? names[static_cast<uint8_t>(code)] : "UNKNOWN";
+}
+
+/*-----------------------------------------------------------------------------
+ Next character without consuming it - Returns CSV_END after the last one
+-----------------------------------------------------------------------------*/
+inline int csvReader::Peek(void) {
+    if (index == fill && !bEnd) {
+        int length = pRead(pSource, buffer, sizeof(buffer));
+
+        if (length < 0) {
+            Fail(csvError::READ);
+        }
+
+        fill = (length > 0) ? static_cast<size_t>(length) : 0;
+        index = 0;
+        bEnd = (length <= 0);
+    }
+
+    return (index < fill) ? static_cast<uint8_t>(buffer[index]) : CSV_END;
+}
+
+/*-----------------------------------------------------------------------------
+ Consume the peeked character
+-----------------------------------------------------------------------------*/
+inline void csvReader::Advance(void) {
+    if (index < fill) {
+        bool bNewLine = (buffer[index++] == '\n');
+
+        line += bNewLine ? 1 : 0;
+        column = bNewLine ? 1 : column + 1;
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ Keep the first error and where it happened (callers reject fields with it) - Returns false
+-----------------------------------------------------------------------------*/
+inline bool csvReader::Fail(csvError code) {
+    if (error == csvError::NONE) {
+        error = code;
+        errorLine = line;
+        errorColumn = column;
+    }
+
+    return false;
+}
+
+/*-----------------------------------------------------------------------------
+ Skip blank lines and comments before a row
+-----------------------------------------------------------------------------*/
+inline void csvReader::SkipBlankLines(void) {
+    int character = Peek();
+
+    while (character != CSV_END) {
+        if (character == CSV_COMMENT && column == 1) {
+            while (character != CSV_END && character != '\n') {
+                Advance();
+                character = Peek();
+            }
+        } else if ( !IsSpace(character) && character != '\n' ) {
+            return;
+        }
+
+        Advance();
+        character = Peek();
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ Move to the start of the next field - Returns false if the row has no more
+-----------------------------------------------------------------------------*/
+inline bool csvReader::BeginField(void) {
+    if (error != csvError::NONE) {
+        return false;
+    }
+
+    if (rowState == csvRowState::START) {
+        SkipBlankLines();
+
+        if (Peek() == CSV_END) {
+            return Fail(csvError::MISSING_FIELD);
+        }
+    }
+
+    if (rowState == csvRowState::END) {
+        return Fail(csvError::MISSING_FIELD);
+    }
+
+    while ( IsSpace( Peek() ) ) {
+        Advance();
+    }
+
+    return error == csvError::NONE;
+}
+
+/*-----------------------------------------------------------------------------
+ Consume the delimiter or line end after a field - Returns false on other characters
+-----------------------------------------------------------------------------*/
+inline bool csvReader::EndField(void) {
+    while ( IsSpace( Peek() ) ) {
+        Advance();
+    }
+
+    int character = Peek();
+
+    if (character == CSV_DELIMITER) {
+        rowState = csvRowState::FIELD;
+    } else if (character == '\n' || character == CSV_END) {
+        rowState = csvRowState::END;
+    } else {
+        return Fail(csvError::NOT_A_NUMBER);
+    }
+
+    Advance();
+
+    return error == csvError::NONE;
+}
+
+/*-----------------------------------------------------------------------------
+ Append a digit to a magnitude - Returns false once it is past any int32
+-----------------------------------------------------------------------------*/
+inline bool csvReader::AddDigit(uint64_t & magnitude, int digit) {
+    magnitude = magnitude * 10 + digit;
+
+    // The rest of the digits cannot bring it back
+    return magnitude <= static_cast<uint64_t>(INT32_MAX) + 1;
+}
+
+/*-----------------------------------------------------------------------------
+ Convert the next field of the row as it streams in - Returns false on an error
+-----------------------------------------------------------------------------*/
+inline bool csvReader::ReadInteger(int32_t & value, int32_t minimum, int32_t maximum) {
+    return ReadFixed(value, 0, minimum, maximum);
+}
+
+/*-----------------------------------------------------------------------------
+ Convert a decimal field scaled by 10^decimals ("1.25" is 1250 with 3) - Returns false on an error
+-----------------------------------------------------------------------------*/
+inline bool csvReader::ReadFixed(int32_t & value, uint8_t decimals, int32_t minimum, int32_t maximum) {
+    if ( !BeginField() ) {
+        return false;
+    }
+
+    uint32_t startLine = line;
+    uint32_t startColumn = column;
+    int character = Peek();
+    bool bNegative = (character == '-');
+    uint64_t magnitude = 0;
+    uint8_t places = 0;
+    bool bDigits = false;
+
+    if (character == '-' || character == '+') {
+        Advance();
+        character = Peek();
+    }
+
+    while (character >= '0' && character <= '9') {
+        if ( !AddDigit(magnitude, character - '0') ) {
+            return Fail(csvError::OUT_OF_RANGE);
+        }
+
+        bDigits = true;
+        Advance();
+        character = Peek();
+    }
+
+    if (decimals && character == '.') {
+        Advance();
+        character = Peek();
+
+        while (character >= '0' && character <= '9') {
+            // More precision than the field holds
+            if (places == decimals) {
+                return Fail(csvError::NOT_A_NUMBER);
+            }
+
+            if ( !AddDigit(magnitude, character - '0') ) {
+                return Fail(csvError::OUT_OF_RANGE);
+            }
+
+            ++places;
+            bDigits = true;
+            Advance();
+            character = Peek();
+        }
+    }
+
+    if (!bDigits) {
+        bool bEmpty = (column == startColumn) &&
+            (character == CSV_DELIMITER || character == '\n' || character == CSV_END || IsSpace(character));
+
+        return Fail(bEmpty ? csvError::EMPTY_FIELD : csvError::NOT_A_NUMBER);
+    }
+
+    for (; places < decimals; ++places) {
+        if ( !AddDigit(magnitude, 0) ) {
+            return Fail(csvError::OUT_OF_RANGE);
+        }
+    }
+
+    int64_t result = bNegative ? -static_cast<int64_t>(magnitude) : static_cast<int64_t>(magnitude);
+
+    if ( !EndField() ) {
+        return false;
+    }
+
+    // Report the field rather than the delimiter after it
+    if (result < minimum || result > maximum) {
+        Fail(csvError::OUT_OF_RANGE);
+        errorLine = startLine;
+        errorColumn = startColumn;
+
+        return false;
+    }
+
+    value = static_cast<int32_t>(result);
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Copy the next field of the row without surrounding spaces - Returns false on an error
+-----------------------------------------------------------------------------*/
+inline bool csvReader::ReadText(char * pText, size_t size) {
+    size_t length = 0;
+    size_t trimmed = 0;
+
+    if ( !BeginField() ) {
+        return false;
+    }
+
+    if (size == 0) {
+        return Fail(csvError::TEXT_TOO_LONG);
+    }
+
+    int character = Peek();
+
+    while (character != CSV_DELIMITER && character != '\n' && character != CSV_END) {
+        if (length + 1 >= size) {
+            return Fail(csvError::TEXT_TOO_LONG);
+        }
+
+        pText[length++] = static_cast<char>(character);
+        trimmed = IsSpace(character) ? trimmed : length;
+        Advance();
+        character = Peek();
+    }
+
+    pText[trimmed] = '\0';
+
+    if (!trimmed) {
+        return Fail(csvError::EMPTY_FIELD);
+    }
+
+    return EndField();
+}
+
+/*-----------------------------------------------------------------------------
+ Read a whole row of integers - Returns false on an error or a different field count
+-----------------------------------------------------------------------------*/
+inline bool csvReader::ReadRow(int32_t * pValues, size_t count, int32_t minimum, int32_t maximum) {
+    for (size_t field = 0; field < count; ++field) {
+        if ( !ReadInteger(pValues[field], minimum, maximum) ) {
+            return false;
+        }
+    }
+
+    return EndRow();
+}
+
+/*-----------------------------------------------------------------------------
+ Finish a row - Returns false if it has fields left
+-----------------------------------------------------------------------------*/
+inline bool csvReader::EndRow(void) {
+    if (error != csvError::NONE) {
+        return false;
+    }
+
+    if (rowState == csvRowState::FIELD) {
+        return Fail(csvError::EXTRA_FIELD);
+    }
+
+    rowState = csvRowState::START;
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Check only blank lines and comments follow the last row - Returns false if not
+-----------------------------------------------------------------------------*/
+inline bool csvReader::EndFile(void) {
+    if ( !EndRow() ) {
+        return false;
+    }
+
+    return GetEnd() || Fail(csvError::EXTRA_ROW);
+}
+
+/*-----------------------------------------------------------------------------
+ Check for the end of the file between rows (for files with any number of rows)
+-----------------------------------------------------------------------------*/
+inline bool csvReader::GetEnd(void) {
+    if (error != csvError::NONE || rowState != csvRowState::START) {
+        return false;
+    }
+
+    SkipBlankLines();
+
+    return Peek() == CSV_END;
+}
+
+// End safe guards
+#endif /* CSV_H */
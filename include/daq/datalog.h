@@ -0,0 +1,81 @@
+// Safe guards
+#ifndef DATALOG_H
+#define DATALOG_H
+
+/*-------------------------------------------------------------------------------------------------
+ Libraries
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include "core/general.h"
+#include "core/timebase.h"
+#include "daq/channel.h"
+#include "daq/logger.h"
+#include "daq/session.h"
+
+/*------------------------------------------
+ Macros - Data Log Recorder
+------------------------------------------*/
+#define DATALOG_FILE_NAME        SESSION_DATALOG_NAME
+#define DATALOG_FILE_SIZE        (64UL * 1024 * 1024)                    // Preallocated per file
+#define DATALOG_SAMPLE_PERIOD    1000                                    // Time between samples (us)
+#define DATALOG_NUM_CHANNELS     12
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+// Logged channels (order of the values in every record)
+enum class datalogChannel : uint8_t {
+    APPS1 = 0,      // Raw ADC
+    APPS2,
+    BSE,
+    TORQUE,         // Last torque command (Bamocar units)
+    STATE,          // systemState
+    FAULTS,         // ERROR_CODE_* bits
+    SPEED,          // RPM
+    MOTOR_TEMP,     // 0.1 C
+    BAMOCAR_TEMP,
+    PHASE_ONE,      // 0.1 A
+    PHASE_TWO,
+    PHASE_THREE
+};
+
+// Filled by the FSM (core/FSM.h)
+class systemData;
+
+/*-------------------------------------------------------------------------------------------------
+ Compact pedal, torque, state and Bamocar channel log (through a static class)
+-------------------------------------------------------------------------------------------------*/
+class DatalogHandler {
+    public:
+        // Getters
+        static bool GetRecording(void) { return logger.GetOpen(); }
+        static uint32_t GetDropped(void) { return logger.GetDropped(); }
+        static uint32_t GetSamples(void) { return samples; }
+
+        // Data methods
+        static bool BeginDatalog(void);
+        static void SampleChannels(systemData & system);
+        static bool ServiceDatalog(void);
+
+    private:
+        // Helpers
+        static void WriteHeader(uint8_t * pSector);
+
+        // Channel names in the file header (flash)
+        static const char names[DATALOG_NUM_CHANNELS][CHANNEL_NAME_SIZE];
+
+        // Filled and encoded by the main loop only
+        static streamLogger logger;
+        static channelEncoder encoder;
+        static uint64_t lastSample;
+        static uint32_t samples;
+        static uint8_t lastFaults;  // Fault bits of the previous sample
+
+        // Index entry of the buffer being filled
+        static sessionIndexEntry_t block;
+        static bool bBlockStarted;
+};
+
+// End safe guards
+#endif /* DATALOG_H */
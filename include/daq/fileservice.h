@@ -0,0 +1,71 @@
+// Safe guards
+#ifndef FILESERVICE_H
+#define FILESERVICE_H
+
+/*-------------------------------------------------------------------------------------------------
+ Libraries
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include <SD.h>
+
+#include "core/general.h"
+#include "comms/transport.h"
+#include "daq/storage.h"
+
+/*------------------------------------------
+ Macros - File Service Commands
+------------------------------------------*/
+#define FILE_CMD_LIST            0x01  // u16 start index
+#define FILE_CMD_READ            0x02  // u32 offset, u16 length, name
+#define FILE_CMD_WRITE           0x03  // u32 offset, u8 flags, name, data
+#define FILE_CMD_CRC             0x04  // name
+#define FILE_CMD_RESPONSE        0x40  // Added to the command in every response
+
+#define FILE_WRITE_TRUNCATE      0x01  // Write flag - start the file again
+
+/*------------------------------------------
+ Macros - File Service Status
+------------------------------------------*/
+#define FILE_STATUS_OK           0x00
+#define FILE_STATUS_NOT_FOUND    0x01
+#define FILE_STATUS_BAD_REQUEST  0x02
+#define FILE_STATUS_IO_ERROR     0x03
+
+/*------------------------------------------
+ Macros - File Service
+------------------------------------------*/
+#define FILE_RESPONSE_HEADER     2     // Command and status
+#define FILE_READ_HEADER         (FILE_RESPONSE_HEADER + 4)
+#define FILE_MAX_READ            (TRANSPORT_MAX_LENGTH - FILE_READ_HEADER)
+#define FILE_LIST_HEADER         (FILE_RESPONSE_HEADER + 2)
+
+/*-------------------------------------------------------------------------------------------------
+ SD card file access over ISO-TP (through a static class)
+-------------------------------------------------------------------------------------------------*/
+class FileServiceHandler {
+    public:
+        // Data methods
+        static void ServiceFiles(void);
+
+    private:
+        // Commands (called every loop until they return a response length)
+        static uint16_t ListFiles(const uint8_t * pRequest, uint16_t length, uint8_t * pResponse);
+        static uint16_t ReadFile(const uint8_t * pRequest, uint16_t length, uint8_t * pResponse);
+        static uint16_t WriteFile(const uint8_t * pRequest, uint16_t length, uint8_t * pResponse);
+        static uint16_t CalculateCRC(const uint8_t * pRequest, uint16_t length, uint8_t * pResponse);
+
+        // Helpers
+        static const char * GetFileName(const uint8_t * pRequest, uint16_t length, uint16_t & end);
+        static uint16_t SetStatus(uint8_t * pResponse, uint8_t command, uint8_t status);
+        static uint8_t GetStorageStatus(uint8_t status);
+
+        // Request running over several loops (held until its response is ready)
+        static bool bActive;
+
+        // Command queued for the storage handler
+        static storageTransfer_t transfer;
+};
+
+// End safe guards
+#endif /* FILESERVICE_H */
@@ -0,0 +1,101 @@
+// Safe guards
+#ifndef LOGGER_H
+#define LOGGER_H
+
+/*-------------------------------------------------------------------------------------------------
+ Libraries
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include <SD.h>
+
+#include "core/general.h"
+#include "daq/storage.h"
+
+/*------------------------------------------
+ Macros - Streaming Logger
+------------------------------------------*/
+#define LOGGER_SECTOR_SIZE       512
+#define LOGGER_BUFFER_SECTORS    16                                          // Sectors per SDIO transfer
+#define LOGGER_BUFFER_SIZE       (LOGGER_SECTOR_SIZE * LOGGER_BUFFER_SECTORS)
+#define LOGGER_NUM_BUFFERS       3                                           // Filling, queued and writing
+#define LOGGER_PADDING           0xFF                                        // Unused end of a buffer
+#define LOGGER_SYNC_INTERVAL     1000                                        // File size update (ms)
+#define LOGGER_FLUSH_INTERVAL    1000                                        // Longest wait of a partly filled buffer (ms)
+#define LOGGER_NAME_SIZE         16
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+// One multi-sector write (cache line aligned for the SDIO DMA)
+typedef struct loggerBuffer {
+    alignas(32) uint8_t data[LOGGER_BUFFER_SIZE];
+} loggerBuffer_t;
+
+/*-------------------------------------------------------------------------------------------------
+ Streaming binary logger - preallocated files written in whole sector runs (serviced by StorageHandler)
+-------------------------------------------------------------------------------------------------*/
+class streamLogger {
+    public:
+        // Constructor - the name format takes the session and file numbers, the header callback
+        // fills the first sector of every file
+        streamLogger(const char * pFormat, uint32_t size, void (*pWriteHeader)(uint8_t * pSector));
+
+        // Getters
+        bool GetOpen(void) { return bOpen; }
+        const char * GetFileName(void) { return fileName; }
+        uint32_t GetDropped(void) { return dropped; }
+        uint32_t GetWritten(void) { return written; }
+        uint32_t GetFree(void) { return LOGGER_BUFFER_SIZE - fill; }   // Bytes left in the filling buffer
+        uint32_t GetBufferIndex(void) { return head; }                 // Filling buffer counted from Begin
+
+        // Setters
+        void RequestFlush(void) { bFlush = true; }                     // Hand over and sync the filling buffer
+
+        // Data methods
+        bool Begin(uint32_t session, uint16_t maxFiles);
+        bool Write(const void * pData, uint16_t length);
+        bool Service(void);
+
+    private:
+        // Helpers
+        bool OpenFile(void);
+        bool StartFile(void);
+        void ReserveFile(void);
+        bool NextFile(void);
+        void FlushBuffer(void);
+
+        // Filled by one producer context (the loop, or ISRs of one priority that never nest),
+        // written by the main loop - which hands over a partly filled buffer with interrupts off
+        loggerBuffer_t buffers[LOGGER_NUM_BUFFERS];
+        volatile uint32_t head;     // Buffers handed to the writer
+        volatile uint32_t tail;     // Buffers written to the card
+        uint32_t fill;              // Bytes in the buffer being filled
+        volatile uint32_t dropped;  // Writes lost while every buffer waited on the card
+        uint32_t written;
+
+        // Current file and the next one, created and preallocated ahead by the SD queue
+        const char * pNameFormat;
+        uint32_t fileSize;
+        void (*pHeader)(uint8_t * pSector);
+        FsFile files[2];
+        uint8_t active;             // Index of the file being written
+        char fileName[LOGGER_NAME_SIZE];
+        char spareName[LOGGER_NAME_SIZE];
+        storageTransfer_t spare;    // Allocation job of the next file
+        bool bReserving;            // Allocation queued or running
+        bool bReserved;             // Next file open and preallocated
+        uint32_t sessionNumber;
+        uint16_t fileIndex;
+        uint16_t fileLimit;
+        uint32_t fileBytes;
+        uint32_t syncTimer;
+        uint32_t flushTimer;
+        bool bFlush;
+        bool bSync;                 // Sync as soon as the flushed buffer is written
+        bool bDirty;                // Written since the last sync
+        volatile bool bOpen;
+};
+
+// End safe guards
+#endif /* LOGGER_H */
@@ -0,0 +1,84 @@
+// Safe guards
+#ifndef SESSION_H
+#define SESSION_H
+
+/*-------------------------------------------------------------------------------------------------
+ Libraries
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include <SD.h>
+
+#include "core/general.h"
+#include "core/timebase.h"
+#include "daq/sessionfile.h"
+
+/*------------------------------------------
+ Macros - Session Rotation
+------------------------------------------*/
+#define SESSION_MAX_COUNT        50                              // Sessions kept on the card (new one included)
+#define SESSION_MAX_BYTES        (16ULL * 1024 * 1024 * 1024)    // All sessions, new one at its file limit included
+#define SESSION_MAX_FILES        32                              // Files per stream in one session
+
+/*------------------------------------------
+ Macros - Session File
+------------------------------------------*/
+#define SESSION_BUILD            __DATE__ " " __TIME__           // Firmware build (compile time)
+#define SESSION_INDEX_INTERVAL   5000                            // Partial index sector write (ms)
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+// Sessions on the card when the ECU starts
+typedef struct sessionScan {
+    uint32_t count;       // Session files
+    uint64_t bytes;       // Every file of every session
+    uint32_t oldest;
+    uint32_t newest;
+    bool bFound;          // Any session file names at all
+} sessionScan_t;
+
+// Filled by the FSM (core/FSM.h)
+class systemData;
+
+/*-------------------------------------------------------------------------------------------------
+ Per power cycle log sessions - header, block index and rotation (through a static class)
+-------------------------------------------------------------------------------------------------*/
+class SessionHandler {
+    public:
+        // Getters
+        static uint32_t GetSession(void) { return header.session; }
+        static bool GetOpen(void) { return bOpen; }
+        static uint32_t GetIndexEntries(void) { return entryCount; }
+        static uint32_t GetIndexDropped(void) { return droppedEntries; }
+
+        // Data methods
+        static bool BeginSession(void);
+        static void RecordCalibration(systemData & system);
+        static void AddIndexEntry(const sessionIndexEntry_t & entry);
+        static bool ServiceSession(void);
+
+    private:
+        // Helpers
+        static sessionScan_t ScanSessions(void);
+        static bool RemoveSession(uint32_t session);
+        static void RecordParameters(void);
+        static bool WriteSector(uint32_t sector, const void * pData);
+
+        static sessionFileHeader_t header;
+
+        // Index sector being filled (written when full and every SESSION_INDEX_INTERVAL)
+        static sessionIndexEntry_t entries[SESSION_INDEX_PER_SECTOR];
+        static uint32_t entryCount;
+        static uint32_t droppedEntries;
+        static bool bSectorFull;
+        static bool bIndexDirty;
+        static bool bHeaderDirty;
+        static uint32_t flushTimer;
+
+        static FsFile file;
+        static bool bOpen;
+};
+
+// End safe guards
+#endif /* SESSION_H */
@@ -0,0 +1,87 @@
+// Safe guards
+#ifndef SESSIONFILE_H
+#define SESSIONFILE_H
+
+/*-------------------------------------------------------------------------------------------------
+ Libraries
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/*------------------------------------------
+ Macros - Session File Names
+------------------------------------------*/
+// One session per power cycle - every file of a session starts with its number
+#define SESSION_FILE_NAME        "S%05u.SES"           // Header and block index
+#define SESSION_TRACE_NAME       "S%05uT%03u.BIN"      // CAN trace files (daq/trace.h)
+#define SESSION_DATALOG_NAME     "S%05uL%03u.BIN"      // Channel logs (daq/channel.h)
+#define SESSION_NAME_PREFIX      'S'
+#define SESSION_NAME_DIGITS      5
+#define SESSION_MAX_NUMBER       99999
+
+/*------------------------------------------
+ Macros - Session File Format
+------------------------------------------*/
+#define SESSION_MAGIC            "ECUSESS"
+#define SESSION_VERSION          1
+#define SESSION_SECTOR_SIZE      512
+#define SESSION_BUILD_SIZE       32
+#define SESSION_VEHICLE_SIZE     8
+#define SESSION_NUM_BOUNDS       6     // Lower and upper bound of APPS1, APPS2 and BSE
+#define SESSION_MAX_PARAMETERS   16
+#define SESSION_INDEX_PER_SECTOR (SESSION_SECTOR_SIZE / sizeof(sessionIndexEntry_t))
+#define SESSION_INDEX_UNUSED     0xFF  // Fill of index entries not written yet
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+// Sector 0 of the session file - rewritten when the calibration or parameters change
+typedef struct sessionFileHeader {
+    char magic[8];
+    uint16_t version;
+    uint16_t bufferSectors;     // Sectors per logger buffer
+    uint32_t session;
+    uint32_t buffersPerFile;    // Channel log buffer n is buffer n % buffersPerFile of file n / buffersPerFile
+    uint32_t startTime;         // millis() when the session started
+    uint64_t startEpoch;        // ECU time (us) when the session started
+    char build[SESSION_BUILD_SIZE];
+    char vehicle[SESSION_VEHICLE_SIZE];               // "EV1" or "EV1_5"
+    uint16_t pedalBounds[SESSION_NUM_BOUNDS];         // Lower, upper for APPS1, APPS2, BSE (0 until loaded)
+    uint16_t parameterRevision;
+    uint16_t parameterCount;
+    uint32_t parameters[SESSION_MAX_PARAMETERS];      // Raw ParameterHandler values
+    uint8_t reserved[SESSION_SECTOR_SIZE - 152];
+} sessionFileHeader_t;
+
+// One channel log buffer - sectors 1 onwards hold these in order
+typedef struct sessionIndexEntry {
+    uint64_t time;              // ECU time (us) of the buffer's keyframe
+    uint32_t buffer;            // Buffer number counted from the start of the session
+    uint16_t states;            // Bit per systemState seen in the buffer
+    uint8_t faults;             // ERROR_CODE_* bits seen in the buffer
+    uint8_t reserved;
+} sessionIndexEntry_t;
+
+/*-----------------------------------------------------------------------------
+ Read the session number of a file name - Returns false if it is not a session file
+-----------------------------------------------------------------------------*/
+inline bool ParseSessionNumber(const char * pName, uint32_t & session) {
+    session = 0;
+
+    if (pName[0] != SESSION_NAME_PREFIX) {
+        return false;
+    }
+
+    for (uint8_t index = 1; index <= SESSION_NAME_DIGITS; ++index) {
+        if (pName[index] < '0' || pName[index] > '9') {
+            return false;
+        }
+
+        session = session * 10 + (pName[index] - '0');
+    }
+
+    return true;
+}
+
+// End safe guards
+#endif /* SESSIONFILE_H */
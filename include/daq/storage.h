@@ -0,0 +1,133 @@
+// Safe guards
+#ifndef STORAGE_H
+#define STORAGE_H
+
+/*-------------------------------------------------------------------------------------------------
+ Libraries
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include <SD.h>
+
+#include "core/general.h"
+#include "core/crc.h"
+
+/*------------------------------------------
+ Macros - SD Write Queue
+------------------------------------------*/
+#define STORAGE_QUEUE_SIZE       8     // Queued file writes (power of two)
+#define STORAGE_NAME_SIZE        24
+#define STORAGE_DATA_SIZE        128   // Longest line a queued write can hold
+#define STORAGE_BUDGET_US        500   // SD time per loop - no new operation starts after it
+#define STORAGE_TRANSFER_BLOCK   512   // Bytes moved per step of a queued read, write or CRC
+#define STORAGE_LIST_ENTRY       5     // Size (u32) and name length (u8) ahead of each listed name
+#define STORAGE_LIST_NAME        255   // Longest listed name (longer ones are cut)
+
+/*------------------------------------------
+ Macros - SD Transfer Status
+------------------------------------------*/
+#define STORAGE_STATUS_OK        0
+#define STORAGE_STATUS_PENDING   1     // Queued or running - the buffer belongs to the queue
+#define STORAGE_STATUS_NOT_FOUND 2
+#define STORAGE_STATUS_BAD_RANGE 3     // Write past the end of the file
+#define STORAGE_STATUS_IO_ERROR  4
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+// SD operations of one queued job (one per step so the budget is checked between them)
+enum class storageStep : uint8_t {
+    REMOVE = 0,
+    OPEN,
+    WRITE,
+    TRANSFER,
+    ALLOCATE,
+    CLOSE
+};
+
+enum class storageOperation : uint8_t {
+    APPEND = 0,     // Line from the job itself
+    READ,           // Range of a file into a caller buffer
+    WRITE,          // Caller buffer into a file at an offset
+    ALLOCATE,       // New file with contiguous space - left open in the caller's FsFile
+    CRC,            // CRC-32 of a whole file
+    LIST            // Root directory entries from an index into a caller buffer
+};
+
+// Caller owned buffer and result of a queued read, write, CRC or listing
+typedef struct storageTransfer {
+    uint8_t * pData;
+    uint32_t offset;        // List - index of the first file
+    uint16_t length;        // Bytes to move - reads are clamped to the end of the file (list - buffer size)
+    uint16_t moved;
+    uint32_t size;          // File size once finished (list - files up to the last one listed)
+    uint32_t crc;           // CRC - CRC-32 of the file once finished
+    bool bTruncate;         // Write - cut the file at the offset first
+    FsFile * pFile;         // Allocate - receives the open file
+    uint32_t reserve;       // Allocate - bytes of contiguous space
+    uint8_t status;
+} storageTransfer_t;
+
+// One line appended to (or replacing) a file, a transfer with a caller buffer, or a new stream file
+typedef struct storageJob {
+    char fileName[STORAGE_NAME_SIZE];
+    char data[STORAGE_DATA_SIZE];
+    bool bOverwrite;
+    storageOperation operation;
+    storageTransfer_t * pTransfer;
+} storageJob_t;
+
+// Queue filled and emptied by the main loop only
+typedef struct storageQueue {
+    storageJob_t jobs[STORAGE_QUEUE_SIZE];
+    uint32_t head;
+    uint32_t tail;
+    uint32_t rejected;      // Writes refused while the queue was full
+    uint32_t highWater;
+} storageQueue_t;
+
+/*-------------------------------------------------------------------------------------------------
+ Asynchronous SD writes, transfers and stream buffers serviced within a per loop time budget (through a static class)
+-------------------------------------------------------------------------------------------------*/
+class StorageHandler {
+    public:
+        // Getters
+        static uint32_t GetQueued(void) { return queue.head - queue.tail; }
+        static uint32_t GetRejected(void) { return queue.rejected; }
+        static uint32_t GetBusyCount(void) { return busyCount; }
+        static uint32_t GetPeakTime(void) { return peakTime; }
+
+        static bool GetPending(const char * pFileName);
+
+        // Data methods
+        static bool QueueWrite(const char * pFileName, const char * pString, bool bOverwrite);
+        static bool QueueTransfer(const char * pFileName, storageOperation operation, storageTransfer_t & transfer);
+        static void ServiceStorage(void);
+        static void PrintStorage(void);
+
+    private:
+        // Helpers
+        static bool ServiceStreams(void);
+        static bool OpenFile(storageJob_t & job);
+        static void RunStep(storageJob_t & job);
+        static bool RunTransfer(storageJob_t & job);
+        static bool RunCRC(storageJob_t & job);
+        static bool RunList(storageJob_t & job);
+
+        static storageQueue_t queue;
+
+        // Stream serviced first on the next call (round robin)
+        static uint8_t nextStream;
+
+        // Job at the tail of the queue
+        static storageStep step;
+        static File file;
+        static uint8_t transferStatus;
+
+        // Loops the card was still busy and the longest service (us)
+        static uint32_t busyCount;
+        static uint32_t peakTime;
+};
+
+// End safe guards
+#endif /* STORAGE_H */
@@ -0,0 +1,53 @@
+// Safe guards
+#ifndef TRACE_H
+#define TRACE_H
+
+/*-------------------------------------------------------------------------------------------------
+ Libraries
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include <FlexCAN_T4.h>
+#include <SD.h>
+
+#include "core/general.h"
+#include "core/timebase.h"
+#include "daq/logger.h"
+#include "daq/session.h"
+#include "daq/tracefile.h"
+
+/*------------------------------------------
+ Macros - Trace Recorder
+------------------------------------------*/
+#define TRACE_FILE_NAME          SESSION_TRACE_NAME
+#define TRACE_FILE_SIZE          (64UL * 1024 * 1024)                    // Preallocated per file
+
+/*-------------------------------------------------------------------------------------------------
+ Binary CAN trace recorder (through a static class)
+-------------------------------------------------------------------------------------------------*/
+class TraceHandler {
+    public:
+        // Getters
+        static bool GetRecording(void) { return logger.GetOpen(); }
+        static uint32_t GetDropped(void) { return logger.GetDropped(); }
+
+        // Setters
+        static void RequestFlush(void) { logger.RequestFlush(); }
+
+        // Data methods
+        static bool BeginTrace(void);
+        static void RecordFrame(const CAN_message_t & message, uint32_t timestamp, bool bTransmit);
+        static bool ServiceTrace(void);
+
+    private:
+        // Helpers
+        static void WriteHeader(uint8_t * pSector);
+
+        // Both directions share one stream (producers are the CAN ISRs - same priority, never nested).
+        // Senders never record directly - TX frames are traced from the transmit-complete interrupt
+        static streamLogger logger;
+        static uint16_t sequences[2];
+};
+
+// End safe guards
+#endif /* TRACE_H */
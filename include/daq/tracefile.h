@@ -0,0 +1,46 @@
+// Safe guards
+#ifndef TRACEFILE_H
+#define TRACEFILE_H
+
+/*-------------------------------------------------------------------------------------------------
+ Libraries
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+/*------------------------------------------
+ Macros - Trace File Format
+------------------------------------------*/
+#define TRACE_MAGIC              "ECUTRACE"
+#define TRACE_VERSION            1
+#define TRACE_BLOCK_SIZE         512                                     // One sector (LOGGER_SECTOR_SIZE)
+#define TRACE_RECORD_SIZE        16                                      // Divides LOGGER_BUFFER_SIZE
+
+// Record header bit fields
+#define TRACE_ID_MASK            0x07FF
+#define TRACE_TX_BIT             11
+#define TRACE_LEN_SHIFT          12
+#define TRACE_PADDING            0xFFFF                                  // Header of the unused end of a flushed buffer
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+// One CAN frame (standard IDs only)
+typedef struct traceRecord {
+    uint32_t timestamp;   // micros() when the frame finished on the bus (hardware timestamp)
+    uint16_t header;      // ID (bits 0-10), TX (bit 11), DLC (bits 12-15)
+    uint16_t sequence;    // Per direction count (gaps are dropped frames)
+    uint8_t buf[8];
+} traceRecord_t;
+
+// First block of every trace file
+typedef struct traceFileHeader {
+    char magic[8];
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t startTime;   // millis() when the file was opened
+    uint64_t startEpoch;  // ECU time (us) when the file was opened - unwraps record timestamps
+    uint8_t reserved[TRACE_BLOCK_SIZE - 24];
+} traceFileHeader_t;
+
+// End safe guards
+#endif /* TRACEFILE_H */
@@ -24,15 +24,11 @@ class IRQHandler {
         static uint8_t GetErrorBuffer(void) { return errorBuf; }
         static uint32_t GetLastPressTime(void) { return lastPressTime; }
 
-        static uint8_t GetMotorTemperature(void) { return motorTemperature; }
-
         // Setters
         static void SetShutdownState(bool flag) { bShutdownCircuitOpen = flag; }
         static void SetButtonHeld(bool flag) { bButtonHeld = flag; }
         static void SetErrorBuffer(uint8_t value) { errorBuf = value; }
         static void SetLastPressTime(uint32_t value) { lastPressTime = value; }
-        
-        static void SetMotorTemperature(uint8_t value) { motorTemperature = value; }
 
         // Watchdog methods
         static void ConfigureWDT(void);
@@ -60,9 +56,6 @@ class IRQHandler {
         // Timers for ECU PCB EV1.5
         static IntervalTimer faultLEDTimer;
         static IntervalTimer fadeLEDTimer;
-
-        // Pump control
-        static volatile uint8_t motorTemperature; // In Celsius
 };
 
 /*-------------------------------------------------------------------------------------------------
@@ -19,6 +19,10 @@ class circularBuffer {
         // Destructor
         ~circularBuffer(void);
 
+        // Owns its memory - copies would free it twice
+        circularBuffer(const circularBuffer &) = delete;
+        circularBuffer & operator=(const circularBuffer &) = delete;
+
         // Getters
         size_t GetCapacity(void) { return capacity; }
         size_t GetCount(void) { return count; }
@@ -41,13 +41,14 @@ class hall {
         hall(const uint8_t pinValue, const bool bInverted);
         
         // Getters
-        circularBuffer GetBuffer(void) { return buffer; }
-        analogPin GetPin(void) { return pin; }
+        circularBuffer & GetBuffer(void) { return buffer; }
+        analogPin & GetPin(void) { return pin; }
 
         uint16_t GetRawOutput(void) { return rawOutput; }
         uint16_t GetNormalizedRawOutput(void) { return normalizedRawOutput; }
         uint16_t GetCookedOutput(void) { return cookedOutput; }
         uint16_t GetTorqueRequest(void) { return torqueRequest; }
+        uint32_t GetSampleTime(void) { return pin.GetSampleTime(); }
 
         uint16_t GetPercentRequestLowerBound(void) { return lower; }
         uint16_t GetPercentRequestUpperBound(void) { return upper; }
@@ -1,12 +1,35 @@
 #include "comms/CAN.h"
 
-// Vehicle CAN bus
+// Vehicle CAN bus (control bus on EV1.5)
 FlexCAN_T4<CAN3, RX_SIZE_256, TX_SIZE_16> myCan;
 
+#ifdef EV1_5
+// Dashboard, BMS, logging and host tool traffic
+FlexCAN_T4<CAN1, RX_SIZE_256, TX_SIZE_16> telemetryCan;
+#endif
+
+// Frame templates
+static constexpr CAN_message_t errorCodeTemplate = MakeFrameTemplate(ID_ERROR_CODE, PAR_ERROR_CODE_DLC);
+static constexpr CAN_message_t currentStateTemplate = MakeFrameTemplate(ID_CURRENT_STATE, PAR_CURRENT_STATE_DLC);
+
 /*-----------------------------------------------------------------------------
  Configure the CAN bus network
 -----------------------------------------------------------------------------*/
 void ConfigureCANBus(void) {
+	ConfigureControlBus();
+
+#ifdef EV1_5
+	// Telemetry bus keeps the control bus free of dashboard and tool traffic
+	ConfigureTelemetryBus();
+#endif
+
+	DebugPrintln("CAN BUS INITIALIZED");
+}
+
+/*-----------------------------------------------------------------------------
+ Initialize the control bus controller and its filters (also used for bus off recovery)
+-----------------------------------------------------------------------------*/
+void ConfigureControlBus(void) {
 	// Enable CAN bus
 	myCan.begin();
 	myCan.setBaudRate(BAUD_RATE);
@@ -15,16 +38,42 @@ void ConfigureCANBus(void) {
 	myCan.enableFIFO();
 	myCan.enableFIFOInterrupt();
 
-	// Set message filters for reading messages
+	// Set exact ID message filters for reading messages (nothing else reaches the ISR)
+	myCan.setMBFilter(REJECT_ALL);
 	myCan.setFIFOFilter(REJECT_ALL);
 	myCan.setFIFOFilter(0, ID_CAN_MESSAGE_TX, STD);
+
+#ifndef EV1_5
 	myCan.setFIFOFilter(1, ID_BATTERY_TEMP, STD);
+	myCan.setFIFOFilter(2, ID_TRANSPORT_REQUEST, STD);
+	myCan.setFIFOFilter(3, ID_PARAM_REQUEST, STD);
+#endif
 
 	// Set a callback function used to process incoming messages
 	myCan.onReceive(ProcessCANMessage);
+	myCan.onTransmit(ConfirmCANTransmit);
+}
 
-	DebugPrintln("CAN BUS INITIALIZED");
+#ifdef EV1_5
+/*-----------------------------------------------------------------------------
+ Initialize the telemetry bus controller and its filters (also used for bus off recovery)
+-----------------------------------------------------------------------------*/
+void ConfigureTelemetryBus(void) {
+	telemetryCan.begin();
+	telemetryCan.setBaudRate(BAUD_RATE);
+	telemetryCan.enableFIFO();
+	telemetryCan.enableFIFOInterrupt();
+
+	telemetryCan.setMBFilter(REJECT_ALL);
+	telemetryCan.setFIFOFilter(REJECT_ALL);
+	telemetryCan.setFIFOFilter(0, ID_BATTERY_TEMP, STD);
+	telemetryCan.setFIFOFilter(1, ID_TRANSPORT_REQUEST, STD);
+	telemetryCan.setFIFOFilter(2, ID_PARAM_REQUEST, STD);
+
+	telemetryCan.onReceive(ProcessTelemetryCANMessage);
+	telemetryCan.onTransmit(ConfirmCANTransmit);
 }
+#endif
 
 /*-----------------------------------------------------------------------------
  Output the contents of a CAN message
@@ -45,102 +94,80 @@ void PrintCANMessage(const CAN_message_t & message) {
 }
 
 /*-----------------------------------------------------------------------------
- Read a CAN message using interrupts (messages held in FIFO buffer)
+ Read a control bus CAN message using interrupts (messages held in FIFO buffer)
 -----------------------------------------------------------------------------*/
 void ProcessCANMessage(const CAN_message_t & message) {
-	CAN_message_t messageCopy = message;
+	uint32_t startCycles = ARM_DWT_CYCCNT;
 
 	// Output CAN message contents
 	DebugPrintCANMessage(message);
-	
-	// Check the message is from the Bamocar and contains dashboard data
-	if ( message.id == ID_CAN_MESSAGE_TX && MapCANMessage(messageCopy) ) {
-		// Send the data to the dashboard
-		SendCANMessage(messageCopy);
-	}
+
+	// Count the frame towards bus load and per ID rates (control bus only)
+	StatisticsHandler::RecordReceive(message);
+
+	DispatchCANMessage(message, CAN_BUS_CONTROL);
+	AdmissionHandler::ChargeISR(startCycles);
 }
 
+#ifdef EV1_5
 /*-----------------------------------------------------------------------------
- Populate CAN message frame (Bamocar write specific)
+ Read a telemetry bus CAN message using interrupts (messages held in FIFO buffer)
 -----------------------------------------------------------------------------*/
-void PopulateCANMessage(CAN_message_t * pMessage, uint16_t ID, uint8_t DLC, 
-	uint8_t * pMessageBuf, uint8_t bamocarDestReg) {
-	// Head of Message
-	pMessage->flags.extended  =  PAR_EXTENDED;
-	pMessage->flags.remote    =  PAR_REMOTE;
-	pMessage->flags.overrun   =  PAR_OVERRUN;
-	pMessage->flags.reserved  =  PAR_RESERVED;
-	pMessage->id              =  static_cast<uint32_t>(ID);
-	pMessage->len             =  DLC;
+void ProcessTelemetryCANMessage(const CAN_message_t & message) {
+	uint32_t startCycles = ARM_DWT_CYCCNT;
 
-	pMessage->buf[0] = bamocarDestReg;
+	// Output CAN message contents
+	DebugPrintCANMessage(message);
 
-	// Bamocar wants Litte Endian Format (LIFO)
-	for (uint8_t i = 1; i < DLC; ++i) {
-		pMessage->buf[i] = pMessageBuf[DLC - i];
-	}
+	DispatchCANMessage(message, CAN_BUS_TELEMETRY);
+	AdmissionHandler::ChargeISR(startCycles);
 }
+#endif
 
 /*-----------------------------------------------------------------------------
- Populate CAN message frame (Bamocar read specific)
+ Rate limit a received CAN message and handle it now or in the main loop (called from CAN ISR)
 -----------------------------------------------------------------------------*/
-void PopulateCANMessage(CAN_message_t * pMessage, uint16_t ID, uint8_t DLC, uint8_t bamocarDestReg) {
-	// Head of Message
-	pMessage->flags.extended  =  PAR_EXTENDED;
-	pMessage->flags.remote    =  PAR_REMOTE;
-	pMessage->flags.overrun   =  PAR_OVERRUN;
-	pMessage->flags.reserved  =  PAR_RESERVED;
-	pMessage->id              =  static_cast<uint32_t>(ID);
-	pMessage->len             =  DLC;
+void DispatchCANMessage(const CAN_message_t & message, uint8_t bus) {
+	// Binary trace of every frame for replay (stamped on arrival)
+	CANDataToSD(message, false);
 
-	// Bamocar read register request - See CAN Complete
-	// Requesting data to be sent back instantaneously
-	if (pMessage->len == PAR_RX_DLC) {
-		pMessage->buf[0] = REG_READ;
-		pMessage->buf[1] = bamocarDestReg;
-		pMessage->buf[2] = TRANSMIT_ONCE;
+	// Drop IDs sent faster than expected, defer the rest once the ISR budget is spent
+	if ( AdmissionHandler::AdmitFrame(message) && !AdmissionHandler::DeferFrame(message, bus) ) {
+		HandleCANMessage(message, bus);
 	}
 }
 
 /*-----------------------------------------------------------------------------
- Populate CAN message frame (Bamocar read specific with transmission interval)
+ Handle a CAN message received on either bus (CAN ISR or deferred to the main loop)
 -----------------------------------------------------------------------------*/
-void PopulateCANMessage(CAN_message_t * pMessage, uint16_t ID, uint8_t DLC, uint8_t bamocarDestReg,
-    uint8_t transmissionInterval) {
-	// Head of Message
-	pMessage->flags.extended  =  PAR_EXTENDED;
-	pMessage->flags.remote    =  PAR_REMOTE;
-	pMessage->flags.overrun   =  PAR_OVERRUN;
-	pMessage->flags.reserved  =  PAR_RESERVED;
-	pMessage->id              =  static_cast<uint32_t>(ID);
-	pMessage->len             =  DLC;
+void HandleCANMessage(const CAN_message_t & message, uint8_t bus) {
+	// Bridge the frame onto the other bus if routed there
+	RoutingHandler::ForwardFrame(message, bus);
 
-	// Bamocar read register request - See CAN Complete
-	// Requesting data to be sent back every 100ms
-	if (pMessage->len == PAR_RX_DLC) {
-		pMessage->buf[0] = REG_READ;
-		pMessage->buf[1] = bamocarDestReg;
-		pMessage->buf[2] = transmissionInterval;
-	}
+	// Counter and CRC check of protected frames
+	E2EHandler::CheckFrame(message);
 
-}
+	// Time Bamocar responses against their requests
+	LatencyHandler::RecordResponse(message);
 
-/*-----------------------------------------------------------------------------
-Populate CAN message frame (Generalized)
------------------------------------------------------------------------------*/
-void PopulateCANMessage(CAN_message_t * pMessage, uint16_t ID, uint8_t DLC, uint8_t * pMessageBuf) {
-	// Head of Message
-	pMessage->flags.extended  =  PAR_EXTENDED;
-	pMessage->flags.remote    =  PAR_REMOTE;
-	pMessage->flags.overrun   =  PAR_OVERRUN;
-	pMessage->flags.reserved  =  PAR_RESERVED;
-	pMessage->id              =  static_cast<uint32_t>(ID);
-	pMessage->len             =  DLC;
+	// Decode Bamocar responses into the shared telemetry model
+	TelemetryHandler::DecodeMessage(message);
 
-	// Populate buffer for custom message (error, state, etc.)
-	for (uint8_t i = 0; i < DLC; ++i) {
-		pMessage->buf[i] = pMessageBuf[i];
+	// Parameter tuning requests from the host
+	ParameterHandler::ReceiveRequest(message);
+
+	// Reassemble file service requests from the host
+	TransportHandler::ReceiveFrame(message);
+	
+#ifdef LEGACY_DASHBOARD
+	CAN_message_t messageCopy = message;
+
+	// Check the message is from the Bamocar and contains dashboard data
+	if ( message.id == ID_CAN_MESSAGE_TX && MapCANMessage(messageCopy) ) {
+		// Send the data to the dashboard
+		SendCANMessage(messageCopy);
 	}
+#endif
 }
 
 /*-----------------------------------------------------------------------------
@@ -153,10 +180,6 @@ bool MapCANMessage(CAN_message_t & message) {
 	switch ( message.buf[0] ) {
 		// Motor temperature
 		case (REG_MOTOR_TEMP):
-			// Set the motor temperature 
-			// TODO - get conversion rate from pi software
-			IRQHandler::SetMotorTemperature(0);
-
 			message.id = ID_TEMP;
 			break;
 
@@ -175,36 +198,122 @@ bool MapCANMessage(CAN_message_t & message) {
 }
 
 /*-----------------------------------------------------------------------------
- Send a CAN message (to any transmitting mailbox)
+ Write a CAN message to each bus in a bus mask - Returns the buses that accepted it
+-----------------------------------------------------------------------------*/
+uint8_t WriteCANMessage(const CAN_message_t & message, uint8_t buses) {
+	uint8_t accepted = 0;
+
+	if ( (buses & CAN_BUS_CONTROL) && myCan.write(message) ) {
+		accepted |= CAN_BUS_CONTROL;
+	}
+
+#ifdef EV1_5
+	if ( (buses & CAN_BUS_TELEMETRY) && telemetryCan.write(message) ) {
+		accepted |= CAN_BUS_TELEMETRY;
+	}
+#endif
+
+	return accepted;
+}
+
+/*-----------------------------------------------------------------------------
+ Get the longest transmit queue of the buses an ID is routed on
+-----------------------------------------------------------------------------*/
+uint32_t GetTXQueueCount(uint32_t id) {
+	uint8_t buses = RoutingHandler::GetBuses(id);
+	uint32_t count = (buses & CAN_BUS_CONTROL) ? myCan.getTXQueueCount() : 0;
+
+#ifdef EV1_5
+	if (buses & CAN_BUS_TELEMETRY) {
+		uint32_t telemetryCount = telemetryCan.getTXQueueCount();
+		count = (telemetryCount > count) ? telemetryCount : count;
+	}
+#endif
+
+	return count;
+}
+
+/*-----------------------------------------------------------------------------
+ Send a CAN message on its routed buses (to any transmitting mailbox)
 -----------------------------------------------------------------------------*/
 void SendCANMessage(const CAN_message_t & message) {
-	myCan.write(message);
+	uint8_t buses = RoutingHandler::GetBuses(message.id);
+
+	uint8_t accepted = WriteCANMessage(message, buses);
+
+	// Statistics describe the control bus load
+	if (accepted & CAN_BUS_CONTROL) {
+		StatisticsHandler::RecordTransmit( message, myCan.getTXQueueCount() );
+	}
+	else if (buses & CAN_BUS_CONTROL) {
+		StatisticsHandler::RecordTransmitFailure();
+	}
+
 	// DebugPrintln("MESSAGE SENT");
 }
 
 /*-----------------------------------------------------------------------------
- Send a CAN message to a specified transmitting mailbox
+ Send a CAN message to a specified control bus transmitting mailbox
 -----------------------------------------------------------------------------*/
 void SendCANMessage(const CAN_message_t & message, const FLEXCAN_MAILBOX MB) {
-	myCan.write(MB, message);
+	if ( myCan.write(MB, message) ) {
+		StatisticsHandler::RecordTransmit( message, myCan.getTXQueueCount() );
+	}
+	else {
+		StatisticsHandler::RecordTransmitFailure();
+	}
 	DebugPrintln("MESSAGE SENT");
 }
 
 /*-----------------------------------------------------------------------------
- Periodically vehicle status CAN messages
+ Time stamp a frame once it has been sent on either bus (called from CAN ISR)
+-----------------------------------------------------------------------------*/
+void ConfirmCANTransmit(const CAN_message_t & message) {
+	uint8_t bus = (message.bus == 1) ? CAN_BUS_TELEMETRY : CAN_BUS_CONTROL;
+
+	// Bridged copies were already traced when they were received
+	if ( !(RoutingHandler::GetBuses(message.id) & bus) ) {
+		return;
+	}
+
+	// Traced when it is actually on the bus - frames lost to a bus off never appear
+	CANDataToSD(message, true);
+
+	if ( message.id == ID_CAN_MESSAGE_RX && message.buf[BAMOCAR_REG_OFFSET] == REG_DIG_TORQUE_SET ) {
+		TorqueHandler::ConfirmTorque(message);
+	}
+}
+
+/*-----------------------------------------------------------------------------
+ Send vehicle status CAN messages on change and periodically
 -----------------------------------------------------------------------------*/
 void SendCANStatusMessages(uint8_t * errors, uint8_t * state) {
     static uint32_t timer = millis();
+	static dashEventQueue_t events = {};
+	static uint8_t lastErrors = 0;
+	static uint8_t lastState = 0;
 	CAN_message_t message;
+	dashEvent_t event = {*state, *errors, 0};
+
+	// Changes queue behind the hold-off so none is lost
+	if (*errors != lastErrors || *state != lastState) {
+		DashboardHandler::QueueEvent(events, *state, *errors);
+		lastErrors = *errors;
+		lastState = *state;
+	}
 
-	// Check if the timing period has passed to send CAN messages again
-	if ( millis() - timer >= STATUS_MESSAGE_INTERVAL ) {
+	bool bEvent = DashboardHandler::GetEvent(events, event);
+
+	// Send a due change, or the current values once the timing period has passed and nothing is queued
+	if ( bEvent || ( events.head == events.tail && millis() - timer >= STATUS_MESSAGE_INTERVAL ) ) {
 		// Send ECU fault errors to dashboard
-		PopulateCANMessage(&message, ID_ERROR_CODE, PAR_ERROR_DLC, errors);
+		message = errorCodeTemplate;
+		EncodeErrorCode({event.faults}, message.buf);
 		SendCANMessage(message);
 
 		// Send current vehicle state to dashboard
-		PopulateCANMessage(&message, ID_CURRENT_STATE, PAR_STATE_DLC, state);
+		message = currentStateTemplate;
+		EncodeCurrentState({event.state}, message.buf);
 		SendCANMessage(message);
 
 		// Reset timer
@@ -216,36 +325,8 @@ void SendCANStatusMessages(uint8_t * errors, uint8_t * state) {
  Request data from Bamocar registers at a set periodic interval
 -----------------------------------------------------------------------------*/
 void RequestBamocarData(void) {
-	CAN_message_t msgBamocarRequest;
-
-	// Motor temperature
-	PopulateCANMessage(&msgBamocarRequest, ID_CAN_MESSAGE_RX, PAR_RX_DLC, 
-		REG_MOTOR_TEMP, TRANSMIT_100MS);
-	SendCANMessage(msgBamocarRequest);
-
-	// Bamocar temperature
-	msgBamocarRequest.buf[1] = REG_BAMOCAR_TEMP;
-	SendCANMessage(msgBamocarRequest);
-
-	// Overall current
-	// msgBamocarRequest.buf[1] = REG_CURRENT;
-	// SendCANMessage(msgBamocarRequest);
-
-	// Overall voltage
-	// msgBamocarRequest.buf[1] = REG_VOLTAGE;
-	// SendCANMessage(msgBamocarRequest);
-	
-	// Motor RPM
-	msgBamocarRequest.buf[1] = REG_SPEED_FILTERED;
-	SendCANMessage(msgBamocarRequest);
-
-	// Phase current
-	msgBamocarRequest.buf[1] = REG_CURRENT_PHASE_1;
-	SendCANMessage(msgBamocarRequest);
-	msgBamocarRequest.buf[1] = REG_CURRENT_PHASE_2;
-	SendCANMessage(msgBamocarRequest);
-	msgBamocarRequest.buf[1] = REG_CURRENT_PHASE_3;
-	SendCANMessage(msgBamocarRequest);
+	// Queue every register subscription - sent staggered from the main loop
+	SubscriptionHandler::ResubscribeAll();
 
 	DebugPrintln("REQUESTING BAMOCAR DATA...");
 }
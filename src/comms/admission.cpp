@@ -0,0 +1,132 @@
+#include "comms/admission.h"
+#include "comms/CAN.h"
+
+// Initialize variables
+const admissionConfig_t AdmissionHandler::config[ADMISSION_NUM_IDS] = {
+	// ID                    Rate   Burst
+	{ID_CAN_MESSAGE_TX,      1000,  32},  // Cyclic responses and request replies
+	{ID_BATTERY_TEMP,        100,   4},
+	{ID_PARAM_REQUEST,       100,   4},   // One request at a time
+	{ID_TRANSPORT_REQUEST,   1000,  32}   // Consecutive frames paced by TRANSPORT_SEPARATION
+};
+
+admissionBucket_t AdmissionHandler::buckets[ADMISSION_NUM_IDS] = {};
+uint32_t AdmissionHandler::windowStart = 0;
+uint32_t AdmissionHandler::windowCycles = 0;
+volatile uint32_t AdmissionHandler::peakCycles = 0;
+admissionRing_t AdmissionHandler::ring = {};
+
+/*-----------------------------------------------------------------------------
+ Rate limit a received ID - Returns false if the frame is dropped (called from CAN ISR)
+-----------------------------------------------------------------------------*/
+bool AdmissionHandler::AdmitFrame(const CAN_message_t & message) {
+	for (uint8_t index = 0; index < ADMISSION_NUM_IDS; ++index) {
+		const admissionConfig_t & limit = config[index];
+		admissionBucket_t & bucket = buckets[index];
+
+		if (message.id != limit.id) {
+			continue;
+		}
+
+		uint32_t now = micros();
+		uint32_t capacity = limit.burst * ADMISSION_CREDIT_UNIT;
+		uint32_t elapsed = now - bucket.lastTime;
+
+		// Start full so a burst at power up is not mistaken for a flood
+		if (!bucket.bStarted) {
+			bucket.credit = capacity;
+			bucket.bStarted = true;
+		} else {
+			elapsed = (elapsed > ADMISSION_MAX_ELAPSED) ? ADMISSION_MAX_ELAPSED : elapsed;
+			bucket.credit += elapsed * limit.rate;
+			bucket.credit = (bucket.credit > capacity) ? capacity : bucket.credit;
+		}
+
+		bucket.lastTime = now;
+
+		if (bucket.credit < ADMISSION_CREDIT_UNIT) {
+			++bucket.rejected;
+			return false;
+		}
+
+		bucket.credit -= ADMISSION_CREDIT_UNIT;
+		++bucket.admitted;
+
+		return true;
+	}
+
+	// Hardware filters only pass listed IDs - anything else is admitted
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Hand a frame to the main loop once the ISR budget is spent - Returns true if deferred
+-----------------------------------------------------------------------------*/
+bool AdmissionHandler::DeferFrame(const CAN_message_t & message, uint8_t bus) {
+	uint32_t head = ring.head;
+
+	// Start a new budget window
+	if (micros() - windowStart >= ADMISSION_WINDOW) {
+		windowStart = micros();
+		windowCycles = 0;
+	}
+
+	// Frames queue behind earlier deferred frames so handlers keep one context and bus order
+	if (windowCycles < ADMISSION_BUDGET_CYCLES && head == ring.tail) {
+		return false;
+	}
+
+	if (head - ring.tail >= ADMISSION_RING_SIZE) {
+		++ring.dropped;
+		return true;
+	}
+
+	ring.frames[head % ADMISSION_RING_SIZE] = {message, bus};
+	++ring.deferred;
+
+	// Publish the frame after it is complete
+	ring.head = head + 1;
+
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Charge the cycles used by one receive interrupt to the current window
+-----------------------------------------------------------------------------*/
+void AdmissionHandler::ChargeISR(uint32_t startCycles) {
+	uint32_t cycles = ARM_DWT_CYCCNT - startCycles;
+
+	windowCycles += cycles;
+	peakCycles = (cycles > peakCycles) ? cycles : peakCycles;
+}
+
+/*-----------------------------------------------------------------------------
+ Handle a bounded number of deferred frames in order
+-----------------------------------------------------------------------------*/
+void AdmissionHandler::ServiceDeferred(void) {
+	uint32_t tail = ring.tail;
+
+	for (uint8_t count = 0; count < ADMISSION_FRAMES_PER_LOOP && tail != ring.head; ++count) {
+		const admissionDeferred_t & deferred = ring.frames[tail % ADMISSION_RING_SIZE];
+
+		HandleCANMessage(deferred.message, deferred.bus);
+
+		// Released after handling - the ISRs keep deferring until the ring is empty
+		ring.tail = ++tail;
+	}
+}
+
+/*-----------------------------------------------------------------------------
+ Output the rate limit and deferral counters
+-----------------------------------------------------------------------------*/
+void AdmissionHandler::PrintAdmission(void) {
+	for (uint8_t index = 0; index < ADMISSION_NUM_IDS; ++index) {
+		DebugPrint("  RATE 0x"); DebugPrintHEX(config[index].id);
+		DebugPrint(" ADMITTED: "); DebugPrint(buckets[index].admitted);
+		DebugPrint(" REJECTED: "); DebugPrintln(buckets[index].rejected);
+	}
+
+	DebugPrint("  DEFERRED: "); DebugPrint(ring.deferred);
+	DebugPrint(" DROPPED: "); DebugPrint(ring.dropped);
+	DebugPrint(" ISR PEAK CYCLES: "); DebugPrintln(peakCycles);
+}
@@ -0,0 +1,151 @@
+#include "comms/dashboard.h"
+#include "comms/CAN.h"
+
+// Initialize variables
+canDashStatus_t DashboardHandler::status = {};
+dashEventQueue_t DashboardHandler::events = {};
+uint32_t DashboardHandler::statusTimer = 0;
+uint8_t DashboardHandler::eventCounter = 0;
+uint8_t DashboardHandler::statusCounter = 0;
+uint8_t DashboardHandler::motorCounter = 0;
+
+// Frame templates
+static constexpr CAN_message_t eventTemplate = MakeFrameTemplate(ID_DASH_EVENT, PAR_DASH_EVENT_DLC);
+static constexpr CAN_message_t statusTemplate = MakeFrameTemplate(ID_DASH_STATUS, PAR_DASH_STATUS_DLC);
+static constexpr CAN_message_t motorTemplate = MakeFrameTemplate(ID_DASH_MOTOR, PAR_DASH_MOTOR_DLC);
+
+/*-----------------------------------------------------------------------------
+ Store the latest vehicle status reported by the FSM
+-----------------------------------------------------------------------------*/
+void DashboardHandler::SetVehicleStatus(uint8_t state, uint8_t faults, uint8_t percentAPPS, 
+	uint8_t percentBSE) {
+	// State transitions and fault set/clear are each reported in order
+	if (state != status.state || faults != status.faults) {
+		QueueEvent(events, state, faults);
+	}
+
+	status.state = state;
+	status.faults = faults;
+	status.percentAPPS = percentAPPS;
+	status.percentBSE = percentBSE;
+}
+
+/*-----------------------------------------------------------------------------
+ Queue a state or fault change - a full queue folds it into the newest change
+-----------------------------------------------------------------------------*/
+void DashboardHandler::QueueEvent(dashEventQueue_t & queue, uint8_t state, uint8_t faults) {
+	uint32_t head = queue.head;
+
+	if (head - queue.tail >= DASH_EVENT_QUEUE_SIZE) {
+		dashEvent_t & newest = queue.events[(head - 1) % DASH_EVENT_QUEUE_SIZE];
+
+		// The dashboard always ends on the latest values and sees that changes were merged
+		newest.state = state;
+		newest.faults = faults;
+		newest.merged = (newest.merged < 255) ? newest.merged + 1 : 255;
+		return;
+	}
+
+	queue.events[head % DASH_EVENT_QUEUE_SIZE] = {state, faults, 0};
+	queue.head = head + 1;
+}
+
+/*-----------------------------------------------------------------------------
+ Take the oldest change once the hold-off has passed - Returns false if none is due
+-----------------------------------------------------------------------------*/
+bool DashboardHandler::GetEvent(dashEventQueue_t & queue, dashEvent_t & event) {
+	if ( queue.tail == queue.head || millis() - queue.timer < DASH_EVENT_HOLDOFF ) {
+		return false;
+	}
+
+	event = queue.events[queue.tail % DASH_EVENT_QUEUE_SIZE];
+	++queue.tail;
+	queue.timer = millis();
+
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Send one state or fault change
+-----------------------------------------------------------------------------*/
+void DashboardHandler::SendEventMessage(const dashEvent_t & event) {
+	CAN_message_t message;
+	canDashEvent_t frame = {};
+
+	frame.state = event.state;
+	frame.counter = eventCounter++;
+	frame.faults = event.faults;
+	frame.merged = event.merged;
+
+	message = eventTemplate;
+	EncodeDashEvent(frame, message.buf);
+	E2EHandler::Protect(message, E2E_DASH_EVENT_CRC);
+	SendCANMessage(message);
+}
+
+/*-----------------------------------------------------------------------------
+ Send the vehicle state, faults, pedals and torque command
+-----------------------------------------------------------------------------*/
+void DashboardHandler::SendStatusMessage(void) {
+	CAN_message_t message;
+
+	status.counter = statusCounter++;
+	status.torque = TorqueHandler::GetLastTorque();
+
+	message = statusTemplate;
+	EncodeDashStatus(status, message.buf);
+	E2EHandler::Protect(message, E2E_DASH_STATUS_CRC);
+	SendCANMessage(message);
+
+	statusTimer = millis();
+}
+
+/*-----------------------------------------------------------------------------
+ Send status changes as events and the packed dashboard frames periodically
+-----------------------------------------------------------------------------*/
+void DashboardHandler::SendDashboardMessages(void) {
+	static uint32_t motorTimer = millis();
+	CAN_message_t message;
+	dashEvent_t event;
+
+	// Event frame in the same loop as the change - later changes follow one per hold-off
+	if ( GetEvent(events, event) ) {
+		SendEventMessage(event);
+	}
+
+	if ( millis() - statusTimer >= DASH_STATUS_INTERVAL ) {
+		SendStatusMessage();
+	}
+
+	// Motor speed, temperatures and current from Bamocar telemetry
+	if ( millis() - motorTimer >= DASH_MOTOR_INTERVAL ) {
+		bamocarTelemetry_t telemetry = TelemetryHandler::GetTelemetry();
+		telemetrySignal_t * signals[NUM_BAMOCAR_SIGNALS] = {
+			&telemetry.motorTemperature, &telemetry.bamocarTemperature, &telemetry.speed,
+			&telemetry.phaseCurrent[0], &telemetry.phaseCurrent[1], &telemetry.phaseCurrent[2]
+		};
+		canDashMotor_t motor = {};
+
+		// One stale bit per telemetry signal
+		for (uint8_t index = 0; index < NUM_BAMOCAR_SIGNALS; ++index) {
+			motor.staleFlags |= signals[index]->bStale << index;
+		}
+
+		motor.counter = motorCounter++;
+		motor.speed = telemetry.speed.value;
+		motor.motorTemp = telemetry.motorTemperature.value / 10;
+		motor.bamocarTemp = telemetry.bamocarTemperature.value / 10;
+
+		// Largest phase current magnitude
+		for (uint8_t phase = 0; phase < 3; ++phase) {
+			int32_t current = abs(telemetry.phaseCurrent[phase].value);
+			motor.phaseCurrent = (current > motor.phaseCurrent) ? current : motor.phaseCurrent;
+		}
+
+		message = motorTemplate;
+		EncodeDashMotor(motor, message.buf);
+		SendCANMessage(message);
+
+		motorTimer = millis();
+	}
+}
@@ -0,0 +1,84 @@
+#include "comms/e2e.h"
+
+// Initialize variables
+const e2eConfig_t E2EHandler::rxConfig[E2E_NUM_RX] = {
+	// ID                 DLC                     CRC  Counter  Shift
+	{ID_BATTERY_TEMP,     PAR_BATTERY_TEMP_DLC,   7,   6,       0}
+};
+
+e2eReceiver_t E2EHandler::receivers[E2E_NUM_RX] = {};
+
+/*-----------------------------------------------------------------------------
+ CRC-8 over the data ID and every byte except the CRC byte
+-----------------------------------------------------------------------------*/
+uint8_t E2EHandler::ComputeCRC(const CAN_message_t & message, uint8_t crcByte) {
+	const uint8_t dataID[2] = { static_cast<uint8_t>(message.id & 0xFF), static_cast<uint8_t>(message.id >> 8) };
+	uint8_t crc = CRC8_INITIAL;
+
+	crc = UpdateCRC8(crc, dataID, sizeof(dataID));
+	crc = UpdateCRC8(crc, message.buf, crcByte);
+	crc = UpdateCRC8(crc, &message.buf[crcByte + 1], message.len - crcByte - 1);
+
+	return crc ^ CRC8_FINAL_XOR;
+}
+
+/*-----------------------------------------------------------------------------
+ Validate a received frame and count failures (called from CAN ISR)
+-----------------------------------------------------------------------------*/
+e2eStatus E2EHandler::CheckFrame(const CAN_message_t & message) {
+	for (uint8_t index = 0; index < E2E_NUM_RX; ++index) {
+		const e2eConfig_t & config = rxConfig[index];
+		e2eReceiver_t & receiver = receivers[index];
+
+		if (message.id != config.id) {
+			continue;
+		}
+
+		e2eStatus status = e2eStatus::OK;
+		uint8_t counter = (message.buf[config.counterByte] >> config.counterShift) & E2E_COUNTER_MASK;
+		uint8_t delta = (counter - receiver.lastCounter) & E2E_COUNTER_MASK;
+
+		// A short frame cannot hold the CRC - treat it as corrupted
+		if ( message.len != config.len || message.buf[config.crcByte] != ComputeCRC(message, config.crcByte) ) {
+			status = e2eStatus::CRC_ERROR;
+			++receiver.crcCount;
+		} else if (!receiver.bCounterValid) {
+			status = e2eStatus::INITIAL;
+		} else if (delta == 0) {
+			status = e2eStatus::REPEATED;
+			++receiver.repeatedCount;
+		} else if (delta > E2E_MAX_DELTA_COUNTER + 1) {
+			status = e2eStatus::WRONG_SEQUENCE;
+			++receiver.sequenceCount;
+		} else {
+			++receiver.okCount;
+		}
+
+		// Resynchronise on any frame with a good CRC
+		if (status != e2eStatus::CRC_ERROR) {
+			receiver.lastCounter = counter;
+			receiver.bCounterValid = true;
+		}
+
+		receiver.lastStatus = status;
+
+		return status;
+	}
+
+	return e2eStatus::NOT_PROTECTED;
+}
+
+/*-----------------------------------------------------------------------------
+ Output the receive failure counters
+-----------------------------------------------------------------------------*/
+void E2EHandler::PrintE2E(void) {
+	for (uint8_t index = 0; index < E2E_NUM_RX; ++index) {
+		const e2eReceiver_t & receiver = receivers[index];
+
+		DebugPrint("  E2E 0x"); DebugPrintHEX(rxConfig[index].id);
+		DebugPrint(" OK: "); DebugPrint(receiver.okCount);
+		DebugPrint(" REPEATED: "); DebugPrint(receiver.repeatedCount);
+		DebugPrint(" SEQUENCE: "); DebugPrint(receiver.sequenceCount);
+		DebugPrint(" CRC: "); DebugPrintln(receiver.crcCount);
+	}
+}
@@ -0,0 +1,133 @@
+#include "comms/latency.h"
+#include "comms/CAN.h"
+
+// Initialize variables
+volatile uint32_t LatencyHandler::requestTimes[NUM_BAMOCAR_SIGNALS] = {0};
+volatile bool LatencyHandler::bAwaiting[NUM_BAMOCAR_SIGNALS] = {false};
+volatile uint32_t LatencyHandler::lastArrivals[NUM_BAMOCAR_SIGNALS] = {0};
+latencyStats_t LatencyHandler::stats[NUM_BAMOCAR_SIGNALS] = {};
+latencyStats_t LatencyHandler::controlStats = {};
+
+/*-----------------------------------------------------------------------------
+ Get the log2 histogram bin of a time in us
+-----------------------------------------------------------------------------*/
+uint8_t LatencyHandler::GetBin(uint32_t time) {
+	uint8_t bin = (time > 1) ? 31 - __builtin_clz(time) : 0;
+
+	return (bin < LATENCY_NUM_BINS) ? bin : LATENCY_NUM_BINS - 1;
+}
+
+/*-----------------------------------------------------------------------------
+ Add one measured latency to a histogram and its limits
+-----------------------------------------------------------------------------*/
+void LatencyHandler::AddLatency(latencyStats_t * pStats, uint32_t latency) {
+	++pStats->histogram[ GetBin(latency) ];
+	pStats->minimum = (pStats->count == 0 || latency < pStats->minimum) ? latency : pStats->minimum;
+	pStats->maximum = (latency > pStats->maximum) ? latency : pStats->maximum;
+	pStats->total += latency;
+	++pStats->count;
+}
+
+/*-----------------------------------------------------------------------------
+ Mark a register read request as sent (next response closes the round trip)
+-----------------------------------------------------------------------------*/
+void LatencyHandler::RecordRequest(uint8_t bamocarReg) {
+	int8_t index = TelemetryHandler::GetSignalIndex(bamocarReg);
+
+	if (index < 0) {
+		return;
+	}
+
+	// Publish the time before the flag the ISR checks
+	requestTimes[index] = micros();
+	bAwaiting[index] = true;
+}
+
+/*-----------------------------------------------------------------------------
+ Match a Bamocar response to its request or cyclic period (called from CAN ISR)
+-----------------------------------------------------------------------------*/
+void LatencyHandler::RecordResponse(const CAN_message_t & message) {
+	if (message.id != ID_CAN_MESSAGE_TX) {
+		return;
+	}
+
+	int8_t index = TelemetryHandler::GetSignalIndex( message.buf[0] );
+
+	if (index < 0) {
+		return;
+	}
+
+	uint32_t arrival = TimebaseHandler::GetFrameMicros(message);
+	latencyStats_t * pStats = &stats[index];
+
+	// First response after a request is the round trip
+	if (bAwaiting[index]) {
+		AddLatency(pStats, arrival - requestTimes[index]);
+
+		bAwaiting[index] = false;
+	}
+	// Later responses are cyclic - measure deviation from the requested interval
+	else if (lastArrivals[index] != 0) {
+		uint32_t period = arrival - lastArrivals[index];
+		uint32_t expected = TelemetryHandler::GetExpectedInterval( static_cast<bamocarSignal>(index) ) * 1000;
+
+		// Skip gaps from missed responses (caught by stale detection instead)
+		if (period < 2 * expected) {
+			uint32_t jitter = (period > expected) ? period - expected : expected - period;
+
+			pStats->jitterMaximum = (jitter > pStats->jitterMaximum) ? jitter : pStats->jitterMaximum;
+			pStats->jitterTotal += jitter;
+			++pStats->jitterCount;
+		}
+	}
+
+	lastArrivals[index] = arrival;
+}
+
+/*-----------------------------------------------------------------------------
+ Record the time from a pedal sample to its torque command on the bus (called from CAN ISR)
+-----------------------------------------------------------------------------*/
+void LatencyHandler::RecordControlDelay(uint32_t delay) {
+	AddLatency(&controlStats, delay);
+}
+
+/*-----------------------------------------------------------------------------
+ Output one histogram and its jitter
+-----------------------------------------------------------------------------*/
+void LatencyHandler::PrintStats(latencyStats_t * pStats) {
+	DebugPrint(" N: "); DebugPrint(pStats->count);
+
+	if (pStats->count) {
+		DebugPrint(" MIN: "); DebugPrint(pStats->minimum);
+		DebugPrint(" MEAN: "); DebugPrint( static_cast<uint32_t>(pStats->total / pStats->count) );
+		DebugPrint(" MAX: "); DebugPrint(pStats->maximum);
+	}
+
+	if (pStats->jitterCount) {
+		DebugPrint(" JITTER MEAN: "); DebugPrint( static_cast<uint32_t>(pStats->jitterTotal / pStats->jitterCount) );
+		DebugPrint(" MAX: "); DebugPrint(pStats->jitterMaximum);
+	}
+
+	// Non-empty bins as 2^n:count
+	DebugPrint(" HIST:");
+	for (uint8_t bin = 0; bin < LATENCY_NUM_BINS; ++bin) {
+		if (pStats->histogram[bin]) {
+			DebugPrint(" "); DebugPrint(bin); DebugPrint(":"); DebugPrint(pStats->histogram[bin]);
+		}
+	}
+
+	DebugPrintln();
+}
+
+/*-----------------------------------------------------------------------------
+ Output the latency and jitter of each register and the control delay
+-----------------------------------------------------------------------------*/
+void LatencyHandler::PrintLatency(void) {
+	for (uint8_t index = 0; index < NUM_BAMOCAR_SIGNALS; ++index) {
+		DebugPrint("  LATENCY "); DebugPrint(index);
+		PrintStats(&stats[index]);
+	}
+
+	DebugPrint("  CONTROL DELAY");
+	PrintStats(&controlStats);
+}
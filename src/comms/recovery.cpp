@@ -0,0 +1,100 @@
+#include "comms/recovery.h"
+#include "comms/CAN.h"
+
+// Initialize variables
+canBusHealth_t RecoveryHandler::control = {};
+#ifdef EV1_5
+canBusHealth_t RecoveryHandler::telemetry = {};
+#endif
+
+/*-----------------------------------------------------------------------------
+ Track the fault confinement state of a bus - Returns true when it recovers from bus off
+-----------------------------------------------------------------------------*/
+bool RecoveryHandler::CheckBus(canBusHealth_t & health, uint32_t esr, void (*pConfigure)(void), const char * pName) {
+	uint8_t state = FLEXCAN_ESR_get_fault_code(esr);
+	uint32_t recoveryTime = ParameterHandler::GetUInt(parameter::BUS_OFF_RECOVERY_MS);
+	bool bRecovered = false;
+
+	state = (state > CAN_BUS_OFF) ? CAN_BUS_OFF : state;
+
+	// Never re-initialize before the controller could have finished its own recovery
+	if ( recoveryTime && recoveryTime < CAN_RECOVERY_MIN ) {
+		recoveryTime = CAN_RECOVERY_MIN;
+	}
+
+	if (state != health.state) {
+		DebugPrint(pName); DebugPrint(" CAN STATE: "); DebugPrintln(state);
+	}
+
+	health.state = state;
+
+	if (state == CAN_BUS_OFF) {
+		if (!health.bDown) {
+			health.bDown = true;
+			health.downTime = millis();
+			health.retryTime = health.downTime;
+			++health.outages;
+		}
+
+		// Restart the controller and its filters if it has not come back by itself
+		if ( recoveryTime && millis() - health.retryTime >= recoveryTime ) {
+			pConfigure();
+			health.retryTime = millis();
+			++health.reinits;
+		}
+	} else if (health.bDown) {
+		health.bDown = false;
+		health.lastOutage = millis() - health.downTime;
+		bRecovered = true;
+
+		DebugPrint(pName); DebugPrint(" CAN RECOVERED (MS): "); DebugPrintln(health.lastOutage);
+	}
+
+	return bRecovered;
+}
+
+/*-----------------------------------------------------------------------------
+ Check both buses every loop and restore Bamocar traffic after a bus off
+-----------------------------------------------------------------------------*/
+void RecoveryHandler::ServiceRecovery(void) {
+	uint8_t errors = 0;
+
+	if ( CheckBus(control, FLEXCANb_ESR1(CAN3), ConfigureControlBus, "CONTROL") ) {
+		// Cyclic responses stopped while the ECU was off the bus
+		RequestBamocarData();
+
+		// Do not wait for the keep-alive to restore the torque command
+		TorqueHandler::ResendTorque();
+	}
+
+#ifdef EV1_5
+	CheckBus(telemetry, FLEXCANb_ESR1(CAN1), ConfigureTelemetryBus, "TELEMETRY");
+#endif
+
+	// Fault flag follows the control bus - read and written with interrupts off since the SDC ISR
+	// sets its own bit in the same buffer (re-initializing the controller takes a while)
+	noInterrupts();
+
+	errors = IRQHandler::GetErrorBuffer();
+
+	if ( bitRead(errors, ERROR_CODE_CAN_BUS) != control.bDown ) {
+		IRQHandler::SetErrorBuffer( control.bDown ? errors | (1 << ERROR_CODE_CAN_BUS) : errors & ~(1 << ERROR_CODE_CAN_BUS) );
+	}
+
+	interrupts();
+}
+
+/*-----------------------------------------------------------------------------
+ Output the bus off counters
+-----------------------------------------------------------------------------*/
+void RecoveryHandler::PrintRecovery(void) {
+	DebugPrint("  CONTROL OUTAGES: "); DebugPrint(control.outages);
+	DebugPrint(" REINITS: "); DebugPrint(control.reinits);
+	DebugPrint(" LAST OUTAGE (MS): "); DebugPrintln(control.lastOutage);
+
+#ifdef EV1_5
+	DebugPrint("  TELEMETRY OUTAGES: "); DebugPrint(telemetry.outages);
+	DebugPrint(" REINITS: "); DebugPrint(telemetry.reinits);
+	DebugPrint(" LAST OUTAGE (MS): "); DebugPrintln(telemetry.lastOutage);
+#endif
+}
@@ -0,0 +1,72 @@
+#include "comms/routing.h"
+#include "comms/CAN.h"
+
+// Frames that must reach the Bamocar quickly - every other ID uses CAN_ROUTE_DEFAULT
+static constexpr canRoute_t routes[] = {
+	// ID                   Buses              Forward
+	{ID_CAN_MESSAGE_RX,     CAN_BUS_CONTROL,   0},
+	{ID_CAN_MESSAGE_TX,     CAN_BUS_CONTROL,   CAN_BUS_TELEMETRY} // Loggers on the telemetry bus still see responses
+};
+
+/*-----------------------------------------------------------------------------
+ Build the ID indexed routing table at compile time
+-----------------------------------------------------------------------------*/
+static constexpr canRouteTable_t MakeRouteTable(void) {
+	canRouteTable_t table = {};
+
+	for (uint16_t id = 0; id <= CAN_ROUTE_ID_MASK; ++id) {
+		table.entries[id] = CAN_ROUTE_DEFAULT;
+	}
+
+	for (const canRoute_t & route : routes) {
+		// Never bridge a frame back onto the bus it came from (single bus builds forward nothing)
+		uint8_t forward = route.forward & ~route.buses;
+
+		table.entries[route.id] = route.buses | (forward << CAN_ROUTE_FORWARD_SHIFT);
+	}
+
+	return table;
+}
+
+// Initialize variables
+const canRouteTable_t RoutingHandler::routeTable = MakeRouteTable();
+canForwardRing_t RoutingHandler::forwardRing = {};
+
+/*-----------------------------------------------------------------------------
+ Queue a received frame for the buses it is bridged onto (called from CAN ISR)
+-----------------------------------------------------------------------------*/
+void RoutingHandler::ForwardFrame(const CAN_message_t & message, uint8_t bus) {
+	uint32_t head = forwardRing.head;
+
+	// Only frames arriving on their own bus are bridged
+	if ( GetForward(message.id) == 0 || !(GetBuses(message.id) & bus) ) {
+		return;
+	}
+
+	if (head - forwardRing.tail >= CAN_FORWARD_RING_SIZE) {
+		++forwardRing.dropped;
+		return;
+	}
+
+	// Only copy - the controller's FIFO slot is reused once the ISR returns
+	forwardRing.messages[head % CAN_FORWARD_RING_SIZE] = message;
+
+	// Publish the frame after it is complete
+	forwardRing.head = head + 1;
+}
+
+/*-----------------------------------------------------------------------------
+ Write queued frames to their forward buses (FlexCAN writes are not reentrant)
+-----------------------------------------------------------------------------*/
+void RoutingHandler::ServiceForwarding(void) {
+	uint32_t tail = forwardRing.tail;
+
+	while (tail != forwardRing.head) {
+		const CAN_message_t & message = forwardRing.messages[tail % CAN_FORWARD_RING_SIZE];
+
+		// Written straight from the ring slot, not counted or traced again
+		WriteCANMessage( message, GetForward(message.id) );
+
+		forwardRing.tail = ++tail;
+	}
+}
@@ -0,0 +1,238 @@
+#include "comms/statistics.h"
+#include "comms/CAN.h"
+
+// Initialize variables
+canIdCount_t StatisticsHandler::rxTable[STATS_MAX_IDS] = {};
+volatile uint8_t StatisticsHandler::rxSize = 0;
+volatile uint32_t StatisticsHandler::rxBits = 0;
+volatile uint32_t StatisticsHandler::rxOverruns = 0;
+canIdCount_t StatisticsHandler::txTable[STATS_MAX_IDS] = {};
+volatile uint8_t StatisticsHandler::txSize = 0;
+volatile uint32_t StatisticsHandler::txBits = 0;
+volatile uint8_t StatisticsHandler::txQueueHighWater = 0;
+volatile uint32_t StatisticsHandler::txFailures = 0;
+uint32_t StatisticsHandler::lastBits = 0;
+uint16_t StatisticsHandler::busLoad = 0;
+uint16_t StatisticsHandler::frameRate = 0;
+uint8_t StatisticsHandler::errorState = CAN_ERROR_ACTIVE;
+uint8_t StatisticsHandler::rxErrorCounter = 0;
+uint8_t StatisticsHandler::txErrorCounter = 0;
+uint32_t StatisticsHandler::busOffCount = 0;
+
+// Frame templates
+static constexpr CAN_message_t diagnosticTemplate = MakeFrameTemplate(ID_CAN_DIAGNOSTIC, PAR_CAN_DIAGNOSTIC_DLC);
+
+/*-----------------------------------------------------------------------------
+ Find or append the entry of an ID - Returns nullptr when the table is full
+-----------------------------------------------------------------------------*/
+canIdCount_t * StatisticsHandler::FindEntry(canIdCount_t * table, volatile uint8_t & size, uint32_t id) {
+	uint8_t entries = size;
+
+	for (uint8_t index = 0; index < entries; ++index) {
+		if (table[index].id == id) {
+			return &table[index];
+		}
+	}
+
+	if (entries >= STATS_MAX_IDS) {
+		return nullptr;
+	}
+
+	// Publish the ID before the size so readers never see an empty slot
+	table[entries].id = id;
+	size = entries + 1;
+
+	return &table[entries];
+}
+
+/*-----------------------------------------------------------------------------
+ Count a received frame (called from CAN ISR)
+-----------------------------------------------------------------------------*/
+void StatisticsHandler::RecordReceive(const CAN_message_t & message) {
+	canIdCount_t * entry = FindEntry(rxTable, rxSize, message.id);
+
+	if (entry) {
+		++entry->count;
+	}
+
+	rxBits += STATS_FRAME_BITS(message.len);
+
+	// FIFO overflowed before this frame was read
+	if (message.flags.overrun) {
+		++rxOverruns;
+	}
+}
+
+/*-----------------------------------------------------------------------------
+ Count a frame accepted for transmission and the transmit queue depth behind it
+-----------------------------------------------------------------------------*/
+void StatisticsHandler::RecordTransmit(const CAN_message_t & message, uint8_t queueCount) {
+	// Frames are also sent from CAN ISRs (legacy dashboard mapping) - keep the updates atomic
+	noInterrupts();
+
+	canIdCount_t * entry = FindEntry(txTable, txSize, message.id);
+
+	if (entry) {
+		++entry->count;
+	}
+
+	txBits += STATS_FRAME_BITS(message.len);
+
+	if (queueCount > txQueueHighWater) {
+		txQueueHighWater = queueCount;
+	}
+
+	interrupts();
+}
+
+/*-----------------------------------------------------------------------------
+ Count a frame the controller refused (no free mailbox and a full queue)
+-----------------------------------------------------------------------------*/
+void StatisticsHandler::RecordTransmitFailure(void) {
+	noInterrupts();
+	++txFailures;
+	interrupts();
+}
+
+/*-----------------------------------------------------------------------------
+ Get the frame rate of an ID over the last window - Returns 0 if untracked
+-----------------------------------------------------------------------------*/
+uint16_t StatisticsHandler::GetRate(uint32_t id, bool bTransmit) {
+	canIdCount_t * table = bTransmit ? txTable : rxTable;
+	uint8_t size = bTransmit ? txSize : rxSize;
+
+	for (uint8_t index = 0; index < size; ++index) {
+		if (table[index].id == id) {
+			return table[index].rate;
+		}
+	}
+
+	return 0;
+}
+
+/*-----------------------------------------------------------------------------
+ Close the window of each ID and store its frame rate
+-----------------------------------------------------------------------------*/
+void StatisticsHandler::UpdateRates(canIdCount_t * table, uint8_t size) {
+	for (uint8_t index = 0; index < size; ++index) {
+		uint32_t count = table[index].count;
+
+		table[index].rate = (count - table[index].lastCount) * 1000 / STATS_WINDOW;
+		table[index].lastCount = count;
+	}
+}
+
+/*-----------------------------------------------------------------------------
+ Read the controller error counters and track bus off events
+-----------------------------------------------------------------------------*/
+void StatisticsHandler::PollErrorCounters(void) {
+	uint32_t ecr = FLEXCANb_ECR(CAN3);
+	uint32_t esr = FLEXCANb_ESR1(CAN3);
+	uint8_t state = FLEXCAN_ESR_get_fault_code(esr);
+
+	txErrorCounter = ecr & 0xFF;
+	rxErrorCounter = (ecr >> 8) & 0xFF;
+
+	// Sticky flag catches a bus off that recovered between polls
+	if (esr & FLEXCAN_ESR_BOFF_INT) {
+		FLEXCANb_ESR1(CAN3) = FLEXCAN_ESR_BOFF_INT;
+		++busOffCount;
+	}
+
+	errorState = (state > CAN_BUS_OFF) ? CAN_BUS_OFF : state;
+}
+
+/*-----------------------------------------------------------------------------
+ Send the bus health frame to the dashboard (counters saturate at 255)
+-----------------------------------------------------------------------------*/
+void StatisticsHandler::SendDiagnosticMessage(void) {
+	CAN_message_t message;
+	canCanDiagnostic_t diagnostic = {};
+
+	diagnostic.busLoad = min(busLoad / 5, 255);
+	diagnostic.txQueueHighWater = txQueueHighWater;
+	diagnostic.rxErrorCounter = rxErrorCounter;
+	diagnostic.txErrorCounter = txErrorCounter;
+	diagnostic.errorState = errorState;
+	diagnostic.txFailures = (txFailures > 63) ? 63 : txFailures;
+	diagnostic.busOffCount = (busOffCount > 255) ? 255 : busOffCount;
+	diagnostic.rxOverruns = (rxOverruns > 255) ? 255 : rxOverruns;
+	diagnostic.frameRate = min(frameRate / 20, 255);
+
+	message = diagnosticTemplate;
+	EncodeCanDiagnostic(diagnostic, message.buf);
+	SendCANMessage(message);
+}
+
+/*-----------------------------------------------------------------------------
+ Update error counters every loop and the load statistics every window
+-----------------------------------------------------------------------------*/
+void StatisticsHandler::ServiceStatistics(void) {
+	static uint32_t windowTimer = millis();
+	static uint32_t printTimer = millis();
+
+	PollErrorCounters();
+
+	if ( millis() - windowTimer >= STATS_WINDOW ) {
+		uint32_t bits = rxBits + txBits;
+		uint32_t frames = 0;
+
+		UpdateRates(rxTable, rxSize);
+		UpdateRates(txTable, txSize);
+
+		for (uint8_t index = 0; index < rxSize; ++index) {
+			frames += rxTable[index].rate;
+		}
+
+		for (uint8_t index = 0; index < txSize; ++index) {
+			frames += txTable[index].rate;
+		}
+
+		// Only frames passing the acceptance filters are seen - load is a lower bound
+		busLoad = static_cast<uint64_t>(bits - lastBits) * 1000 * 1000 /
+			(static_cast<uint64_t>(BAUD_RATE) * STATS_WINDOW);
+		frameRate = frames;
+		lastBits = bits;
+
+		SendDiagnosticMessage();
+
+		windowTimer = millis();
+	}
+
+	if ( millis() - printTimer >= STATS_PRINT_INTERVAL ) {
+		PrintStatistics();
+
+		printTimer = millis();
+	}
+}
+
+/*-----------------------------------------------------------------------------
+ Output the bus statistics
+-----------------------------------------------------------------------------*/
+void StatisticsHandler::PrintStatistics(void) {
+	DebugPrint("CAN LOAD: "); DebugPrint(busLoad / 10); DebugPrint("."); DebugPrint(busLoad % 10);
+	DebugPrint("% FRAMES/S: "); DebugPrint(frameRate);
+	DebugPrint(" TXQ MAX: "); DebugPrint(txQueueHighWater);
+	DebugPrint(" REC: "); DebugPrint(rxErrorCounter);
+	DebugPrint(" TEC: "); DebugPrint(txErrorCounter);
+	DebugPrint(" STATE: "); DebugPrint(errorState);
+	DebugPrint(" BUS OFF: "); DebugPrint(busOffCount);
+	DebugPrint(" OVERRUNS: "); DebugPrint(rxOverruns);
+	DebugPrint(" TX FAILED: "); DebugPrintln(txFailures);
+
+	for (uint8_t index = 0; index < rxSize; ++index) {
+		DebugPrint("  RX 0x"); DebugPrintHEX(rxTable[index].id);
+		DebugPrint(": "); DebugPrintln(rxTable[index].rate);
+	}
+
+	for (uint8_t index = 0; index < txSize; ++index) {
+		DebugPrint("  TX 0x"); DebugPrintHEX(txTable[index].id);
+		DebugPrint(": "); DebugPrintln(txTable[index].rate);
+	}
+
+	LatencyHandler::PrintLatency();
+	E2EHandler::PrintE2E();
+	AdmissionHandler::PrintAdmission();
+	RecoveryHandler::PrintRecovery();
+	StorageHandler::PrintStorage();
+}
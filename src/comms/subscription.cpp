@@ -0,0 +1,92 @@
+#include "comms/subscription.h"
+#include "comms/CAN.h"
+
+// Initialize variables (same order as bamocarSignal)
+subscription_t SubscriptionHandler::subscriptions[NUM_SUBSCRIPTIONS] = {
+	{REG_MOTOR_TEMP, TRANSMIT_100MS, 0, false},
+	{REG_BAMOCAR_TEMP, TRANSMIT_100MS, 0, false},
+	{REG_SPEED_FILTERED, TRANSMIT_100MS, 0, false},
+	{REG_CURRENT_PHASE_1, TRANSMIT_100MS, 0, false},
+	{REG_CURRENT_PHASE_2, TRANSMIT_100MS, 0, false},
+	{REG_CURRENT_PHASE_3, TRANSMIT_100MS, 0, false}
+};
+uint32_t SubscriptionHandler::lastSendTime = 0;
+uint8_t SubscriptionHandler::nextIndex = 0;
+
+// Frame templates
+static constexpr CAN_message_t readTemplate = MakeBamocarReadTemplate(0, TRANSMIT_ONCE);
+
+/*-----------------------------------------------------------------------------
+ Change the cyclic interval of a register - Returns false if not subscribed
+-----------------------------------------------------------------------------*/
+bool SubscriptionHandler::SetInterval(uint8_t bamocarReg, uint8_t interval) {
+	int8_t index = TelemetryHandler::GetSignalIndex(bamocarReg);
+
+	// Only registers in the telemetry model can be subscribed
+	if (index < 0) {
+		return false;
+	}
+
+	// Queue the new rate, sent on the next free slot
+	subscriptions[index].interval = interval;
+	subscriptions[index].bPending = true;
+
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Queue every subscription to be sent again (startup or Bamocar reboot)
+-----------------------------------------------------------------------------*/
+void SubscriptionHandler::ResubscribeAll(void) {
+	for (uint8_t index = 0; index < NUM_SUBSCRIPTIONS; ++index) {
+		subscriptions[index].bPending = true;
+	}
+}
+
+/*-----------------------------------------------------------------------------
+ Send at most one pending or timed out subscription per spacing period
+-----------------------------------------------------------------------------*/
+void SubscriptionHandler::ServiceSubscriptions(void) {
+	CAN_message_t msgBamocarRequest;
+	uint32_t now = millis();
+
+	// Stagger requests so the bus is never flooded at startup
+	if (now - lastSendTime < SUBSCRIPTION_SPACING) {
+		return;
+	}
+
+	// Round robin so one timed out register can't starve the others
+	for (uint8_t count = 0; count < NUM_SUBSCRIPTIONS; ++count) {
+		uint8_t index = (nextIndex + count) % NUM_SUBSCRIPTIONS;
+		subscription_t * pSubscription = &subscriptions[index];
+		bamocarSignal signal = static_cast<bamocarSignal>(index);
+
+		// Stopped or single shot registers are not monitored
+		bool bCyclic = pSubscription->interval != TRANSMIT_ONCE && pSubscription->interval != TRANSMIT_STOP;
+
+		// Re-subscribe when the cyclic response times out (Bamocar rebooted or missed request)
+		bool bTimedOut = bCyclic && TelemetryHandler::GetStale(signal) && 
+			now - pSubscription->lastRequest >= SUBSCRIPTION_RETRY_TIME;
+
+		if (pSubscription->bPending || bTimedOut) {
+			msgBamocarRequest = readTemplate;
+			msgBamocarRequest.buf[BAMOCAR_READ_REG_OFFSET] = pSubscription->bamocarReg;
+			msgBamocarRequest.buf[BAMOCAR_INTERVAL_OFFSET] = pSubscription->interval;
+			SendCANMessage(msgBamocarRequest);
+			LatencyHandler::RecordRequest(pSubscription->bamocarReg);
+
+			// Stale detection follows the requested rate
+			if (bCyclic) {
+				TelemetryHandler::SetExpectedInterval(signal, pSubscription->interval);
+			}
+
+			pSubscription->lastRequest = now;
+			pSubscription->bPending = false;
+
+			lastSendTime = now;
+			nextIndex = (index + 1) % NUM_SUBSCRIPTIONS;
+
+			break;
+		}
+	}
+}
@@ -0,0 +1,153 @@
+#include "comms/telemetry.h"
+#include "comms/CAN.h"
+
+// Initialize variables
+volatile int16_t TelemetryHandler::values[NUM_BAMOCAR_SIGNALS] = {0};
+volatile uint32_t TelemetryHandler::timestamps[NUM_BAMOCAR_SIGNALS] = {0};
+volatile uint8_t TelemetryHandler::receivedFlags = 0;
+volatile uint32_t TelemetryHandler::sequence = 0;
+uint32_t TelemetryHandler::intervals[NUM_BAMOCAR_SIGNALS] = {
+	TRANSMIT_100MS, TRANSMIT_100MS, TRANSMIT_100MS,
+	TRANSMIT_100MS, TRANSMIT_100MS, TRANSMIT_100MS
+};
+
+/*-----------------------------------------------------------------------------
+ Get the signal index of a Bamocar register - Returns -1 if not subscribed
+-----------------------------------------------------------------------------*/
+int8_t TelemetryHandler::GetSignalIndex(uint8_t bamocarReg) {
+	switch (bamocarReg) {
+		case (REG_MOTOR_TEMP):
+			return static_cast<int8_t>(bamocarSignal::MOTOR_TEMP);
+
+		case (REG_BAMOCAR_TEMP):
+			return static_cast<int8_t>(bamocarSignal::BAMOCAR_TEMP);
+
+		case (REG_SPEED_FILTERED):
+			return static_cast<int8_t>(bamocarSignal::SPEED);
+
+		case (REG_CURRENT_PHASE_1):
+			return static_cast<int8_t>(bamocarSignal::PHASE_ONE);
+
+		case (REG_CURRENT_PHASE_2):
+			return static_cast<int8_t>(bamocarSignal::PHASE_TWO);
+
+		case (REG_CURRENT_PHASE_3):
+			return static_cast<int8_t>(bamocarSignal::PHASE_THREE);
+
+		default:
+			return -1;
+	}
+}
+
+/*-----------------------------------------------------------------------------
+ Convert a raw Bamocar register value to its scaled integer unit
+-----------------------------------------------------------------------------*/
+static int16_t ScaleSignal(bamocarSignal signal, int16_t raw) {
+	int32_t value = raw;
+
+	switch (signal) {
+		// Temperatures in 0.1 C
+		case (bamocarSignal::MOTOR_TEMP):
+		case (bamocarSignal::BAMOCAR_TEMP):
+			value = (value - BAMOCAR_TEMP_OFFSET) * 10 / BAMOCAR_TEMP_SLOPE;
+			break;
+
+		// Speed in RPM
+		case (bamocarSignal::SPEED):
+			value = value * BAMOCAR_SPEED_MAX_RPM / BAMOCAR_FULL_SCALE;
+			break;
+
+		// Phase currents in 0.1 A
+		default:
+			value = value * BAMOCAR_CURRENT_MAX_DA / BAMOCAR_FULL_SCALE;
+			break;
+	}
+
+	return static_cast<int16_t>(value);
+}
+
+/*-----------------------------------------------------------------------------
+ Decode a Bamocar response into the telemetry model (called from CAN ISR)
+-----------------------------------------------------------------------------*/
+bool TelemetryHandler::DecodeMessage(const CAN_message_t & message) {
+	// Response frames carry the register followed by 16-bit little endian data
+	if (message.id != ID_CAN_MESSAGE_TX || message.len < PAR_RX_DLC) {
+		return false;
+	}
+
+	int8_t index = GetSignalIndex( message.buf[0] );
+
+	// Ignore registers that are not part of the telemetry model
+	if (index < 0) {
+		return false;
+	}
+
+	int16_t raw = static_cast<int16_t>( message.buf[1] | (message.buf[2] << 8) );
+	int16_t value = ScaleSignal(static_cast<bamocarSignal>(index), raw);
+
+	// Odd sequence marks the snapshot as being written
+	++sequence;
+
+	values[index] = value;
+	timestamps[index] = millis();
+	receivedFlags |= (1 << index);
+
+	++sequence;
+
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Check if a signal missed its cyclic response - Returns true if stale
+-----------------------------------------------------------------------------*/
+bool TelemetryHandler::GetStale(bamocarSignal signal) {
+	uint8_t index = static_cast<uint8_t>(signal);
+
+	// Signals never received are always stale
+	if ( !(receivedFlags & (1 << index)) ) {
+		return true;
+	}
+
+	return millis() - timestamps[index] > intervals[index] + TELEMETRY_STALE_MARGIN;
+}
+
+/*-----------------------------------------------------------------------------
+ Obtain a consistent copy of all Bamocar signals without disabling interrupts
+-----------------------------------------------------------------------------*/
+bamocarTelemetry_t TelemetryHandler::GetTelemetry(void) {
+	int16_t valueCopy[NUM_BAMOCAR_SIGNALS];
+	uint32_t timestampCopy[NUM_BAMOCAR_SIGNALS];
+	uint8_t receivedCopy;
+	uint32_t start;
+	uint32_t now;
+
+	bamocarTelemetry_t telemetry;
+	telemetrySignal_t * signals[NUM_BAMOCAR_SIGNALS] = {
+		&telemetry.motorTemperature, &telemetry.bamocarTemperature, &telemetry.speed,
+		&telemetry.phaseCurrent[0], &telemetry.phaseCurrent[1], &telemetry.phaseCurrent[2]
+	};
+
+	// Retry the copy if the ISR wrote a signal part way through
+	do {
+		start = sequence;
+		receivedCopy = receivedFlags;
+
+		for (uint8_t index = 0; index < NUM_BAMOCAR_SIGNALS; ++index) {
+			valueCopy[index] = values[index];
+			timestampCopy[index] = timestamps[index];
+		}
+	} while ( (start & 1) || start != sequence );
+
+	// Sample time after the copy so no timestamp is newer than it
+	now = millis();
+
+	// Populate the typed telemetry model
+	for (uint8_t index = 0; index < NUM_BAMOCAR_SIGNALS; ++index) {
+		signals[index]->value = valueCopy[index];
+		signals[index]->timestamp = timestampCopy[index];
+		signals[index]->bStale = !(receivedCopy & (1 << index)) ||
+			now - timestampCopy[index] > intervals[index] + TELEMETRY_STALE_MARGIN;
+	}
+
+	return telemetry;
+}
@@ -0,0 +1,66 @@
+#include "comms/torque.h"
+#include "comms/CAN.h"
+
+// Initialize variables
+uint16_t TorqueHandler::lastTorque = 0;
+uint32_t TorqueHandler::lastSendTime = 0;
+bool TorqueHandler::bSent = false;
+volatile uint32_t TorqueHandler::sampleTime = 0;
+uint8_t TorqueHandler::monitorCounter = 0;
+uint16_t TorqueHandler::deadband = TORQUE_DEADBAND;
+uint16_t TorqueHandler::keepAliveTime = TORQUE_KEEPALIVE_TIME;
+
+// Frame templates
+static constexpr CAN_message_t torqueTemplate = MakeBamocarWriteTemplate(REG_DIG_TORQUE_SET);
+static constexpr CAN_message_t monitorTemplate = MakeFrameTemplate(ID_TORQUE_MONITOR, PAR_TORQUE_MONITOR_DLC);
+
+/*-----------------------------------------------------------------------------
+ Send a torque command on change or keep-alive - Returns true if sent
+-----------------------------------------------------------------------------*/
+bool TorqueHandler::TransmitTorque(uint16_t torque, uint32_t pedalTime) {
+	CAN_message_t msgTorque;
+	uint32_t now = millis();
+
+	// Difference from the command the Bamocar is currently holding
+	uint16_t change = (torque > lastTorque) ? torque - lastTorque : lastTorque - torque;
+
+	// Real changes (and any drop to zero torque) go out without delay
+	bool bChanged = !bSent || change > deadband || (torque == 0 && lastTorque != 0);
+
+	// Otherwise repeat the command so the Bamocar timeout never trips
+	bool bKeepAlive = now - lastSendTime >= keepAliveTime;
+
+	if ( !bChanged && !bKeepAlive ) {
+		return false;
+	}
+
+	// Set before the frame is queued - read by the transmit confirmation
+	sampleTime = pedalTime;
+
+	msgTorque = torqueTemplate;
+	PatchBamocarValue(msgTorque, torque);
+	SendCANMessage(msgTorque);
+
+	// The Bamocar frame layout is fixed - protected copy for the dashboard and logger
+	msgTorque = monitorTemplate;
+	EncodeTorqueMonitor({0, monitorCounter++, torque}, msgTorque.buf);
+	E2EHandler::Protect(msgTorque, E2E_TORQUE_MONITOR_CRC);
+	SendCANMessage(msgTorque);
+
+	lastTorque = torque;
+	lastSendTime = now;
+	bSent = true;
+
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Measure the pedal sample to bus delay of a sent torque command (called from CAN ISR)
+-----------------------------------------------------------------------------*/
+void TorqueHandler::ConfirmTorque(const CAN_message_t & message) {
+	uint32_t pedalTime = sampleTime;
+
+	if (pedalTime) {
+		LatencyHandler::RecordControlDelay( TimebaseHandler::GetFrameMicros(message) - pedalTime );
+	}
+}
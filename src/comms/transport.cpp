@@ -0,0 +1,279 @@
+#include "comms/transport.h"
+#include "comms/CAN.h"
+
+// Initialize variables
+uint8_t TransportHandler::rxBuffer[TRANSPORT_MAX_LENGTH] = {0};
+volatile uint16_t TransportHandler::rxLength = 0;
+volatile uint16_t TransportHandler::rxReceived = 0;
+volatile uint8_t TransportHandler::rxSequence = 0;
+volatile uint32_t TransportHandler::rxTimer = 0;
+volatile bool TransportHandler::bReceiving = false;
+volatile bool TransportHandler::bRxComplete = false;
+volatile bool TransportHandler::bFlowControlDue = false;
+volatile uint8_t TransportHandler::flowControlStatus = ISOTP_FC_CONTINUE;
+volatile bool TransportHandler::bFlowControl = false;
+volatile uint8_t TransportHandler::fcStatus = ISOTP_FC_CONTINUE;
+volatile uint8_t TransportHandler::fcBlockSize = 0;
+volatile uint8_t TransportHandler::fcSeparation = 0;
+uint8_t TransportHandler::txBuffer[TRANSPORT_MAX_LENGTH] = {0};
+uint16_t TransportHandler::txLength = 0;
+uint16_t TransportHandler::txSent = 0;
+uint8_t TransportHandler::txSequence = 0;
+uint8_t TransportHandler::blockRemaining = 0;
+uint32_t TransportHandler::separation = 0;
+uint32_t TransportHandler::txTimer = 0;
+transportState TransportHandler::state = transportState::IDLE;
+
+// Frame templates - ISO-TP frames are always padded to 8 bytes
+static constexpr CAN_message_t responseTemplate = MakeFrameTemplate(ID_TRANSPORT_RESPONSE, 8, TRANSPORT_PADDING);
+
+/*-----------------------------------------------------------------------------
+ Reassemble host requests and store flow control (called from CAN ISR)
+-----------------------------------------------------------------------------*/
+void TransportHandler::ReceiveFrame(const CAN_message_t & message) {
+	if (message.id != ID_TRANSPORT_REQUEST || message.len == 0) {
+		return;
+	}
+
+	const uint8_t * pBuf = message.buf;
+	uint8_t frameType = pBuf[0] >> 4;
+
+	switch (frameType) {
+		// Whole request in one frame
+		case (ISOTP_SINGLE_FRAME): {
+			uint8_t length = pBuf[0] & 0x0F;
+
+			// Previous request still being handled
+			if (bRxComplete || length == 0 || length > message.len - 1) {
+				break;
+			}
+
+			memcpy(rxBuffer, &pBuf[1], length);
+			rxLength = length;
+			bReceiving = false;
+			bRxComplete = true;
+			break;
+		}
+
+		// Start of a segmented request - the loop answers with flow control
+		case (ISOTP_FIRST_FRAME): {
+			uint16_t length = ((pBuf[0] & 0x0F) << 8) | pBuf[1];
+
+			if (bRxComplete || message.len < 8 || length < 8) {
+				break;
+			}
+
+			memcpy(rxBuffer, &pBuf[2], 6);
+			rxLength = length;
+			rxReceived = 6;
+			rxSequence = 1;
+			rxTimer = millis();
+			bReceiving = true;
+
+			flowControlStatus = ISOTP_FC_CONTINUE;
+			bFlowControlDue = true;
+			break;
+		}
+
+		case (ISOTP_CONSECUTIVE_FRAME): {
+			if (!bReceiving) {
+				break;
+			}
+
+			// Lost frame - drop the request, the host times out and retries
+			if ( (pBuf[0] & 0x0F) != rxSequence ) {
+				bReceiving = false;
+				break;
+			}
+
+			uint16_t remaining = rxLength - rxReceived;
+			uint8_t count = (remaining < 7) ? remaining : 7;
+
+			if (count > message.len - 1) {
+				bReceiving = false;
+				break;
+			}
+
+			memcpy(&rxBuffer[rxReceived], &pBuf[1], count);
+			rxReceived += count;
+			rxSequence = (rxSequence + 1) & 0x0F;
+			rxTimer = millis();
+
+			if (rxReceived >= rxLength) {
+				bReceiving = false;
+				bRxComplete = true;
+			}
+			break;
+		}
+
+		// Host pacing for our segmented response
+		case (ISOTP_FLOW_CONTROL):
+			if (message.len < 3) {
+				break;
+			}
+
+			fcStatus = pBuf[0] & 0x0F;
+			fcBlockSize = pBuf[1];
+			fcSeparation = pBuf[2];
+			bFlowControl = true;
+			break;
+
+		default:
+			break;
+	}
+}
+
+/*-----------------------------------------------------------------------------
+ Get the completed request - Returns false if none is waiting
+-----------------------------------------------------------------------------*/
+bool TransportHandler::GetRequest(const uint8_t *& pData, uint16_t & length) {
+	if (!bRxComplete) {
+		return false;
+	}
+
+	// The ISR leaves the buffer alone until ReleaseRequest
+	pData = rxBuffer;
+	length = rxLength;
+
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Send a flow control frame to the host
+-----------------------------------------------------------------------------*/
+void TransportHandler::SendFlowControl(uint8_t status) {
+	CAN_message_t message;
+
+	message = responseTemplate;
+	message.buf[0] = (ISOTP_FLOW_CONTROL << 4) | status;
+	message.buf[1] = TRANSPORT_BLOCK_SIZE;
+	message.buf[2] = TRANSPORT_SEPARATION;
+	SendCANMessage(message);
+}
+
+/*-----------------------------------------------------------------------------
+ Start sending the response in the transmit buffer - Returns false if busy
+-----------------------------------------------------------------------------*/
+bool TransportHandler::Send(uint16_t length) {
+	CAN_message_t message;
+
+	if (state != transportState::IDLE || length == 0 || length > TRANSPORT_MAX_LENGTH) {
+		return false;
+	}
+
+	message = responseTemplate;
+
+	// Short responses fit in a single frame
+	if (length <= 7) {
+		message.buf[0] = (ISOTP_SINGLE_FRAME << 4) | length;
+		memcpy(&message.buf[1], txBuffer, length);
+		SendCANMessage(message);
+
+		return true;
+	}
+
+	message.buf[0] = (ISOTP_FIRST_FRAME << 4) | (length >> 8);
+	message.buf[1] = length & 0xFF;
+	memcpy(&message.buf[2], txBuffer, 6);
+
+	// Discard flow control left over from an earlier transfer
+	bFlowControl = false;
+	SendCANMessage(message);
+
+	txLength = length;
+	txSent = 6;
+	txSequence = 1;
+	txTimer = micros();
+	state = transportState::WAIT_FLOW_CONTROL;
+
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Send consecutive frames within the host's block size and separation time
+-----------------------------------------------------------------------------*/
+void TransportHandler::SendConsecutiveFrames(void) {
+	CAN_message_t message;
+
+	for (uint8_t frame = 0; frame < TRANSPORT_FRAMES_PER_LOOP; ++frame) {
+		// Other traffic first - only use the bus when its TX queue is short
+		if ( micros() - txTimer < separation || GetTXQueueCount(ID_TRANSPORT_RESPONSE) >= TRANSPORT_TX_QUEUE_LIMIT ) {
+			return;
+		}
+
+		uint16_t remaining = txLength - txSent;
+		uint8_t count = (remaining < 7) ? remaining : 7;
+
+		message = responseTemplate;
+		message.buf[0] = (ISOTP_CONSECUTIVE_FRAME << 4) | txSequence;
+		memcpy(&message.buf[1], &txBuffer[txSent], count);
+		SendCANMessage(message);
+
+		txSent += count;
+		txSequence = (txSequence + 1) & 0x0F;
+		txTimer = micros();
+
+		if (txSent >= txLength) {
+			state = transportState::IDLE;
+			return;
+		}
+
+		// Block finished - wait for the next flow control
+		if (blockRemaining && --blockRemaining == 0) {
+			state = transportState::WAIT_FLOW_CONTROL;
+			return;
+		}
+	}
+}
+
+/*-----------------------------------------------------------------------------
+ Answer first frames and move the current response along (never blocks)
+-----------------------------------------------------------------------------*/
+void TransportHandler::ServiceTransport(void) {
+	if (bFlowControlDue) {
+		bFlowControlDue = false;
+		SendFlowControl(flowControlStatus);
+	}
+
+	// Host stopped sending part way through a request
+	if ( bReceiving && millis() - rxTimer > TRANSPORT_TIMEOUT ) {
+		bReceiving = false;
+	}
+
+	switch (state) {
+		case (transportState::WAIT_FLOW_CONTROL):
+			if (bFlowControl) {
+				bFlowControl = false;
+
+				if (fcStatus == ISOTP_FC_CONTINUE) {
+					blockRemaining = fcBlockSize;
+
+					// 0x00-0x7F in ms, 0xF1-0xF9 in 100 us steps
+					if (fcSeparation <= 0x7F) {
+						separation = fcSeparation * 1000UL;
+					} else if (fcSeparation >= 0xF1 && fcSeparation <= 0xF9) {
+						separation = (fcSeparation - 0xF0) * 100UL;
+					} else {
+						separation = 127000UL;
+					}
+
+					state = transportState::SENDING;
+				} else if (fcStatus == ISOTP_FC_WAIT) {
+					txTimer = micros();
+				} else {
+					state = transportState::IDLE;
+				}
+			} else if ( micros() - txTimer > TRANSPORT_TIMEOUT * 1000UL ) {
+				DebugPrintln("ISO-TP: FLOW CONTROL TIMEOUT");
+				state = transportState::IDLE;
+			}
+			break;
+
+		case (transportState::SENDING):
+			SendConsecutiveFrames();
+			break;
+
+		default:
+			break;
+	}
+}
@@ -70,12 +70,23 @@ void systemVehicle::ProcessState(void) {
 
     // Execute the current state the member function pointer points to
     (this->*state)();
+
+    // Share the resulting state and pedal requests with the dashboard
+    system.UpdateDashboardStatus();
+
+    // Live values for the parameter service
+    system.UpdateMeasurements();
 }
 
 /*-----------------------------------------------------------------------------
  PEDALS State - Load pedal configuration
 -----------------------------------------------------------------------------*/
 void systemVehicle::PEDALS(void) {
+    // Edited config files, or the CSV copies if the store has no bounds (parsed only then)
+    if ( ConfigHandler::ImportConfig() ) {
+        ParameterHandler::LoadParameters();
+    }
+
     // Check for a successful load of pedal bounds
     if ( !system.SetPedalBounds() ) {
         DebugErrorPrint("ERROR: PEDAL BOUNDS NOT SET");
@@ -90,6 +101,9 @@ void systemVehicle::PEDALS(void) {
         IRQHandler::ResetWDT();
     }
 
+    // Store the bounds in the session header
+    SessionHandler::RecordCalibration(system);
+
     // Assign member function pointer to next state
     state = &systemVehicle::INIT;
     DebugPrintln("STATE: INIT");
@@ -125,7 +139,7 @@ void systemVehicle::INIT(void) {
  PRECHARGE State - Wait for the tractive system to be energized
 -----------------------------------------------------------------------------*/
 void systemVehicle::PRECHARGE(void) {
-    analogPin pinSDCTap = system.GetSDCTapPin();
+    analogPin & pinSDCTap = system.GetSDCTapPin();
 
     system.SetStateBuffer(systemState::PRECHARGE);
 
@@ -155,7 +169,7 @@ void systemVehicle::PRECHARGE(void) {
     }
 
     // Wait until precharge time has elapsed
-    if ( system.GetChargeTimer() < CHARGE_TIME ) {
+    if ( system.GetChargeTimer() < ParameterHandler::GetUInt(parameter::CHARGE_MS) ) {
         return;
     }
 
@@ -234,9 +248,6 @@ void systemVehicle::RTD(void) {
  IDLE State - Wait for the driver pedal input to drive or brake
 -----------------------------------------------------------------------------*/
 void systemVehicle::IDLE(void) {
-    CAN_message_t msgTorque;
-    uint8_t torqueBuf[PAR_RX_DLC] = {0, 0, 0};
-
     system.SetStateBuffer(systemState::IDLE);
 
     // Transition to FAULT if any possible error occurs
@@ -253,32 +264,28 @@ void systemVehicle::IDLE(void) {
     }
 
     // Switch to DRIVE state after surpassing throttle threshold
-    if ( system.GetLowerPercentAPPS() * 100 > PERCENT_THRESHOLD ) {
+    if ( system.GetLowerPercentAPPS() * 100 > ParameterHandler::GetInt(parameter::THRESHOLD_PERCENT) ) {
         state = &systemVehicle::DRIVE;
         DebugPrintln("STATE: DRIVE");
         return;
     } 
 
     // Switch to BRAKE state after surpassing brake threshold
-    if ( system.GetBSE().GetPercentRequest() * 100 > PERCENT_BRAKE ) {
+    if ( system.GetBSE().GetPercentRequest() * 100 > ParameterHandler::GetInt(parameter::BRAKE_PERCENT) ) {
         state = &systemVehicle::BRAKE;
         DebugPrintln("STATE: BRAKE");
         return;
     }
 
 	// SKIPPING DURING TEST BENCHING
-    // Send torque command of zero to Bamocar
-    PopulateCANMessage(&msgTorque, ID_CAN_MESSAGE_RX, PAR_RX_DLC, torqueBuf, REG_DIG_TORQUE_SET);
-    SendCANMessage(msgTorque);
+    // Send torque command of zero to Bamocar (on change or keep-alive)
+    TorqueHandler::TransmitTorque(0);
 }
 
 /*-----------------------------------------------------------------------------
  DRIVE State - Wait for the driver pedal input to drive or brake
 -----------------------------------------------------------------------------*/
 void systemVehicle::DRIVE(void) {
-    CAN_message_t msgTorque;
-    uint8_t torqueBuf[PAR_RX_DLC] = {0, 0, 0};
-
     system.SetStateBuffer(systemState::DRIVE);
 
     // Transition to FAULT if any possible error occurs
@@ -295,28 +302,21 @@ void systemVehicle::DRIVE(void) {
     }
 
     // Transition to IDLE state if APPS receive minimal force (braking)
-    if ( system.GetLowerPercentAPPS() * 100 < PERCENT_THRESHOLD ) {
+    if ( system.GetLowerPercentAPPS() * 100 < ParameterHandler::GetInt(parameter::THRESHOLD_PERCENT) ) {
         state = &systemVehicle::IDLE;
         DebugPrintln("STATE: IDLE");
         return;
     }
 
-    // Update CAN message buffer with updated pedal readings
-    system.ProcessAPPS(torqueBuf);
-
 	// SKIPPING DURING TEST BENCHING
-    // Send torque command to Bamocar
-    PopulateCANMessage(&msgTorque, ID_CAN_MESSAGE_RX, PAR_RX_DLC, torqueBuf, REG_DIG_TORQUE_SET);
-    SendCANMessage(msgTorque);
+    // Send torque command from updated pedal readings to Bamocar (on change or keep-alive)
+    TorqueHandler::TransmitTorque( system.ProcessAPPS(), system.GetAPPS1().GetSampleTime() );
 }
 
 /*-----------------------------------------------------------------------------
  BRAKE State - Apply zero torque to motor and slow down vehicle
 -----------------------------------------------------------------------------*/
 void systemVehicle::BRAKE(void) {
-    CAN_message_t msgTorque;
-    uint8_t torqueBuf[PAR_RX_DLC] = {0, 0, 0};
-
     system.SetStateBuffer(systemState::BRAKE);
 
     // Transition to FAULT if any possible error occurs
@@ -333,23 +333,22 @@ void systemVehicle::BRAKE(void) {
     }
 
     // Transition to IDLE state if BSE receives minimal force
-    if ( system.GetBSE().GetPercentRequest() * 100 < PERCENT_BRAKE ) {
+    if ( system.GetBSE().GetPercentRequest() * 100 < ParameterHandler::GetInt(parameter::BRAKE_PERCENT) ) {
         state = &systemVehicle::IDLE;
         DebugPrintln("STATE: IDLE");
         return;
     }
 
 	// SKIPPING DURING TEST BENCHING
-    // Send torque command of zero to Bamocar
-    PopulateCANMessage(&msgTorque, ID_CAN_MESSAGE_RX, PAR_RX_DLC, torqueBuf, REG_DIG_TORQUE_SET);
-    SendCANMessage(msgTorque);
+    // Send torque command of zero to Bamocar (on change or keep-alive)
+    TorqueHandler::TransmitTorque(0);
 }
 
 /*-----------------------------------------------------------------------------
  FAULT State - Shut off power to the motor when an error occurs
 -----------------------------------------------------------------------------*/
 void systemVehicle::FAULT(void) {
-    analogPin pinSDCTap = system.GetSDCTapPin();
+    analogPin & pinSDCTap = system.GetSDCTapPin();
     uint8_t faultBuf = system.GetFaultBuffer();
 
     system.SetStateBuffer(systemState::FAULT);
@@ -0,0 +1,397 @@
+#include <stdarg.h>
+#include <math.h>
+
+#include "core/config.h"
+#include "daq/DAQ.h"
+
+// Initialize variables
+configBlob_t ConfigHandler::blob = {};
+bool ConfigHandler::bValid = false;
+
+/*-----------------------------------------------------------------------------
+ Append formatted text without running past the buffer
+-----------------------------------------------------------------------------*/
+static void AppendText(char * pText, size_t & length, size_t size, const char * pFormat, ...) {
+    va_list arguments;
+
+    va_start(arguments, pFormat);
+    int written = vsnprintf(pText + length, size - length, pFormat, arguments);
+    va_end(arguments);
+
+    length = (written > 0 && length + written < size) ? length + written : size - 1;
+}
+
+/*-----------------------------------------------------------------------------
+ End of the queued write starting at an offset (whole lines that fit) - Returns the offset after it
+-----------------------------------------------------------------------------*/
+static size_t GetChunkEnd(const char * pText, size_t start, size_t length) {
+    size_t end = (length - start < STORAGE_DATA_SIZE) ? length : start + STORAGE_DATA_SIZE - 1;
+
+    if (end == length) {
+        return end;
+    }
+
+    for (size_t index = end; index > start; --index) {
+        if (pText[index - 1] == '\n') {
+            return index;
+        }
+    }
+
+    return end;
+}
+
+/*-----------------------------------------------------------------------------
+ CRC-32 of an image up to its CRC
+-----------------------------------------------------------------------------*/
+uint32_t ConfigHandler::GetCRC(const configBlob_t & image) {
+    return UpdateCRC32( 0, reinterpret_cast<const uint8_t *>(&image), offsetof(configBlob_t, crc) );
+}
+
+/*-----------------------------------------------------------------------------
+ Copy the stored pedal bounds - Returns false if none were calibrated or imported
+-----------------------------------------------------------------------------*/
+bool ConfigHandler::GetPedalBounds(configPedals_t & pedals) {
+    if ( !bValid || !(blob.flags & CONFIG_FLAG_PEDALS) ) {
+        return false;
+    }
+
+    pedals = blob.pedals;
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Replace the parameters of the image (stored by the next save)
+-----------------------------------------------------------------------------*/
+void ConfigHandler::SetParameters(const parameterValue_t * pValues) {
+    memcpy(blob.parameters, pValues, sizeof(blob.parameters));
+
+    bValid = true;
+}
+
+/*-----------------------------------------------------------------------------
+ Replace the pedal bounds of the image (stored by the next save)
+-----------------------------------------------------------------------------*/
+void ConfigHandler::SetPedalBounds(const configPedals_t & pedals) {
+    blob.pedals = pedals;
+    blob.flags |= CONFIG_FLAG_PEDALS;
+}
+
+/*-----------------------------------------------------------------------------
+ Convert a version 1 image in place - Returns false if it is corrupt
+-----------------------------------------------------------------------------*/
+bool ConfigHandler::MigrateVersion1(void) {
+    configVersion1_t image;
+
+    memcpy(&image, &blob, sizeof(image));
+
+    uint32_t crc = UpdateCRC32( 0, reinterpret_cast<const uint8_t *>(&image), offsetof(configVersion1_t, crc) );
+
+    if (image.count != CONFIG_VERSION1_COUNT || image.crc != crc) {
+        return false;
+    }
+
+    // Parameters are unchanged - pedal bounds were only kept in pedal_bounds.csv
+    memset(&blob, 0, sizeof(blob));
+    blob.magic = CONFIG_MAGIC;
+    blob.version = CONFIG_VERSION;
+    blob.count = static_cast<uint8_t>(parameter::COUNT);
+    memcpy(blob.parameters, image.values, sizeof(image.values));
+    blob.crc = GetCRC(blob);
+
+    DebugPrintln("CONFIG: MIGRATED FROM VERSION 1");
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Load the image from EEPROM with one read (nothing is parsed at boot)
+-----------------------------------------------------------------------------*/
+void ConfigHandler::LoadConfig(void) {
+    EEPROM.get(CONFIG_EEPROM_ADDRESS, blob);
+
+    if (blob.magic == CONFIG_MAGIC && blob.version == 1) {
+        bValid = MigrateVersion1();
+    } else {
+        bValid = blob.magic == CONFIG_MAGIC && blob.version == CONFIG_VERSION &&
+            blob.count == static_cast<uint8_t>(parameter::COUNT) && blob.crc == GetCRC(blob);
+    }
+
+    if (bValid) {
+        DebugPrintln("CONFIG LOADED");
+        return;
+    }
+
+    // Missing or corrupt - rebuilt from the defaults and the CSV files
+    memset(&blob, 0, sizeof(blob));
+    DebugPrintln("CONFIG: NOT STORED OR CORRUPT");
+}
+
+/*-----------------------------------------------------------------------------
+ Store the image in EEPROM and queue its CSV copy - Returns false if the read back fails
+-----------------------------------------------------------------------------*/
+bool ConfigHandler::SaveConfig(void) {
+    configBlob_t check;
+
+    blob.magic = CONFIG_MAGIC;
+    blob.version = CONFIG_VERSION;
+    blob.count = static_cast<uint8_t>(parameter::COUNT);
+    blob.crc = GetCRC(blob);
+
+    // EEPROM.put only rewrites bytes that changed
+    EEPROM.put(CONFIG_EEPROM_ADDRESS, blob);
+    EEPROM.get(CONFIG_EEPROM_ADDRESS, check);
+
+    if ( memcmp(&blob, &check, sizeof(blob)) ) {
+        return false;
+    }
+
+    ExportConfig();
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Parse name,value rows into an image - Returns false on the first bad row
+-----------------------------------------------------------------------------*/
+bool ConfigHandler::ImportRows(csvReader & reader, configBlob_t & image) {
+    char name[CONFIG_NAME_SIZE];
+    uint8_t pedalRows = 0;
+
+    while ( !reader.GetEnd() ) {
+        if ( !reader.ReadText( name, sizeof(name) ) ) {
+            return false;
+        }
+
+        bool bUpper = !strcmp(name, CONFIG_PEDAL_UPPER);
+
+        // One bound per pedal sensor
+        if ( bUpper || !strcmp(name, CONFIG_PEDAL_LOWER) ) {
+            int32_t bounds[NUM_SENSORS];
+            uint16_t * pBounds = bUpper ? image.pedals.upper : image.pedals.lower;
+
+            if ( !reader.ReadRow(bounds, NUM_SENSORS, 0, TWO_BYTES) ) {
+                return false;
+            }
+
+            for (uint8_t index = 0; index < NUM_SENSORS; ++index) {
+                pBounds[index] = static_cast<uint16_t>(bounds[index]);
+            }
+
+            pedalRows |= bUpper ? 0x01 : 0x02;
+            continue;
+        }
+
+        uint8_t index = 0;
+
+        while ( index < static_cast<uint8_t>(parameter::COUNT) && strcmp(name, ParameterHandler::GetInfo(index).pName) ) {
+            ++index;
+        }
+
+        if ( index == static_cast<uint8_t>(parameter::COUNT) ) {
+            return reader.Fail(csvError::UNKNOWN_NAME);
+        }
+
+        // Checked against the same limits as a write over CAN
+        const parameterInfo_t & info = ParameterHandler::GetInfo(index);
+        int32_t value;
+
+        if (info.type == parameterType::FLOAT) {
+            int32_t minimum = static_cast<int32_t>(info.minimum * CONFIG_FIXED_SCALE);
+            int32_t maximum = static_cast<int32_t>(info.maximum * CONFIG_FIXED_SCALE);
+
+            if ( !reader.ReadFixed(value, CONFIG_DECIMALS, minimum, maximum) ) {
+                return false;
+            }
+
+            image.parameters[index].f = static_cast<float>(value) / CONFIG_FIXED_SCALE;
+        } else {
+            if ( !reader.ReadInteger( value, static_cast<int32_t>(info.minimum), static_cast<int32_t>(info.maximum) ) ) {
+                return false;
+            }
+
+            image.parameters[index].i = value;
+        }
+
+        if ( !reader.EndRow() ) {
+            return false;
+        }
+    }
+
+    if (reader.GetError() != csvError::NONE) {
+        return false;
+    }
+
+    // Half a calibration is not kept
+    if (pedalRows == 0x03) {
+        image.flags |= CONFIG_FLAG_PEDALS;
+    } else if (pedalRows) {
+        return reader.Fail(csvError::MISSING_FIELD);
+    }
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Apply a config file to an image, all rows or none - Returns false if missing or rejected
+-----------------------------------------------------------------------------*/
+bool ConfigHandler::ImportFile(const char * pFileName, configBlob_t & image) {
+    File fConfig = SD.open(pFileName, FILE_READ);
+
+    if (!fConfig) {
+        return false;
+    }
+
+    configBlob_t edited = image;
+    csvReader reader(fConfig);
+    bool bImported = ImportRows(reader, edited);
+
+    fConfig.close();
+
+    if (!bImported) {
+        PrintCSVError(pFileName, reader);
+        return false;
+    }
+
+    image = edited;
+
+    DebugPrint("CONFIG IMPORTED FROM "); DebugPrintln(pFileName);
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Apply the bounds of a pedal_bounds.csv row - Returns false if missing or rejected
+-----------------------------------------------------------------------------*/
+bool ConfigHandler::ImportLegacyPedals(configBlob_t & image) {
+    File fPedalBounds = SD.open(FILE_PEDAL_BOUNDS, FILE_READ);
+
+    if (!fPedalBounds) {
+        return false;
+    }
+
+    // Upper bounds of each sensor, then lower bounds
+    int32_t bounds[2 * NUM_SENSORS];
+    csvReader reader(fPedalBounds);
+    bool bImported = reader.ReadRow(bounds, 2 * NUM_SENSORS, 0, TWO_BYTES) && reader.EndFile();
+
+    fPedalBounds.close();
+
+    if (!bImported) {
+        PrintCSVError(FILE_PEDAL_BOUNDS, reader);
+        return false;
+    }
+
+    for (uint8_t index = 0; index < NUM_SENSORS; ++index) {
+        image.pedals.upper[index] = static_cast<uint16_t>(bounds[index]);
+        image.pedals.lower[index] = static_cast<uint16_t>(bounds[index + NUM_SENSORS]);
+    }
+
+    image.flags |= CONFIG_FLAG_PEDALS;
+
+    DebugPrint("CONFIG IMPORTED FROM "); DebugPrintln(FILE_PEDAL_BOUNDS);
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Load edited values, or rebuild missing bounds from the CSV copies - Returns true if the image changed
+-----------------------------------------------------------------------------*/
+bool ConfigHandler::ImportConfig(void) {
+    configBlob_t image = blob;
+
+    // Edits for humans - kept on the card if rejected so the error can be fixed
+    bool bEdited = ImportFile(CONFIG_IMPORT_FILE, image);
+    bool bRebuilt = false;
+
+    // Corrupt and version 1 images have no bounds - the last export, then the calibration file
+    if ( !(image.flags & CONFIG_FLAG_PEDALS) ) {
+        bRebuilt = ImportFile(CONFIG_FILE, image) || ImportLegacyPedals(image);
+    }
+
+    if (!bEdited && !bRebuilt) {
+        return false;
+    }
+
+    blob = image;
+    bValid = true;
+
+    if ( !SaveConfig() ) {
+        DebugErrorPrint("ERROR: CONFIG NOT SAVED");
+    }
+
+    if (bEdited) {
+        SD.remove(CONFIG_IMPORT_FILE);
+    }
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Queue the image as name,value rows for humans - Returns false if the SD queue has no room
+-----------------------------------------------------------------------------*/
+bool ConfigHandler::ExportConfig(void) {
+    char text[CONFIG_EXPORT_SIZE];
+    size_t length = 0;
+
+    AppendText(text, length, sizeof(text), "# ECU config version %d - edit a copy named %s to load it\r\n",
+        CONFIG_VERSION, CONFIG_IMPORT_FILE);
+
+    // Pedal bounds, then parameters in index order
+    for (uint8_t row = 0; row < 2 && (blob.flags & CONFIG_FLAG_PEDALS); ++row) {
+        const uint16_t * pBounds = row ? blob.pedals.lower : blob.pedals.upper;
+
+        AppendText(text, length, sizeof(text), "%s", row ? CONFIG_PEDAL_LOWER : CONFIG_PEDAL_UPPER);
+
+        for (uint8_t index = 0; index < NUM_SENSORS; ++index) {
+            AppendText(text, length, sizeof(text), ",%u", pBounds[index]);
+        }
+
+        AppendText(text, length, sizeof(text), "\r\n");
+    }
+
+    for (uint8_t index = 0; index < static_cast<uint8_t>(parameter::COUNT); ++index) {
+        const parameterInfo_t & info = ParameterHandler::GetInfo(index);
+
+        if (info.type == parameterType::FLOAT) {
+            long fixed = lroundf(blob.parameters[index].f * CONFIG_FIXED_SCALE);
+            unsigned long magnitude = (fixed < 0) ? -static_cast<unsigned long>(fixed) : fixed;
+
+            AppendText(text, length, sizeof(text), "%s,%s%lu.%03lu\r\n", info.pName, (fixed < 0) ? "-" : "",
+                magnitude / CONFIG_FIXED_SCALE, magnitude % CONFIG_FIXED_SCALE);
+        } else {
+            AppendText(text, length, sizeof(text), "%s,%ld\r\n", info.pName, static_cast<long>(blob.parameters[index].i));
+        }
+    }
+
+    // Whole lines per queued write - skipped rather than left half written
+    uint32_t jobs = 0;
+
+    for (size_t start = 0; start < length; start = GetChunkEnd(text, start, length)) {
+        ++jobs;
+    }
+
+    if (STORAGE_QUEUE_SIZE - StorageHandler::GetQueued() < jobs) {
+        DebugPrintln("ERROR: CONFIG EXPORT SKIPPED");
+        return false;
+    }
+
+    for (size_t start = 0; start < length; ) {
+        char chunk[STORAGE_DATA_SIZE];
+        size_t end = GetChunkEnd(text, start, length);
+
+        // The queued write ends its line itself (println)
+        size_t size = end - start;
+
+        size -= (size && text[start + size - 1] == '\n') ? 1 : 0;
+        size -= (size && text[start + size - 1] == '\r') ? 1 : 0;
+
+        memcpy(chunk, text + start, size);
+        chunk[size] = '\0';
+
+        WriteDataToFile(CONFIG_FILE, chunk, start ? !OVERWRITE : OVERWRITE);
+        start = end;
+    }
+
+    return true;
+}
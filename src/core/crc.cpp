@@ -0,0 +1,29 @@
+#include "core/crc.h"
+
+// Lookup tables (generated by the compiler, stored in flash)
+static constexpr crc32Table_t crc32Table = MakeCRC32Table();
+static constexpr crc8Table_t crc8Table = MakeCRC8Table();
+
+/*-----------------------------------------------------------------------------
+ Continue a CRC-32 over more data - Start with 0 (chains like zlib crc32)
+-----------------------------------------------------------------------------*/
+uint32_t UpdateCRC32(uint32_t crc, const uint8_t * pData, size_t length) {
+    crc = ~crc;
+
+    for (size_t index = 0; index < length; ++index) {
+        crc = crc32Table.entries[(crc ^ pData[index]) & 0xFF] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
+
+/*-----------------------------------------------------------------------------
+ Continue a CRC-8 over more data - Start with CRC8_INITIAL, finish with CRC8_FINAL_XOR
+-----------------------------------------------------------------------------*/
+uint8_t UpdateCRC8(uint8_t crc, const uint8_t * pData, size_t length) {
+    for (size_t index = 0; index < length; ++index) {
+        crc = crc8Table.entries[crc ^ pData[index]];
+    }
+
+    return crc;
+}
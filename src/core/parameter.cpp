@@ -0,0 +1,236 @@
+#include "core/parameter.h"
+#include "core/config.h"
+#include "comms/CAN.h"
+#include "sensors/hall.h"
+
+// Initialize variables
+const parameterInfo_t ParameterHandler::info[static_cast<uint8_t>(parameter::COUNT)] = {
+    // Safety limits stop at the FSAE rule values - tuning can only make them stricter
+    // Name                 Type                    Min    Max      Default
+    {"PERCENT_THRESHOLD",   parameterType::INT32,   1,     25,      PERCENT_THRESHOLD},
+    {"PERCENT_BRAKE",       parameterType::INT32,   5,     50,      PERCENT_BRAKE},
+    {"PERCENT_ACCEL",       parameterType::INT32,   5,     25,      PERCENT_ACCEL},       // EV.4.7 - 25 % APPS
+    {"APPS_AGREEMENT",      parameterType::INT32,   1,     10,      APPS_AGREEMENT},      // T.4.2.4 - 10 points
+    {"IMPLAUSIBILITY_TIME", parameterType::INT32,   0,     100,     IMPLAUSIBILITY_TIME}, // T.4.2.5 - 100 ms
+    {"CHARGE_TIME",         parameterType::INT32,   0,     10000,   CHARGE_TIME},
+    {"PUMP_KP",             parameterType::FLOAT,   0,     1000,    0},
+    {"PUMP_KI",             parameterType::FLOAT,   0,     1000,    0},
+    {"PUMP_KD",             parameterType::FLOAT,   0,     1000,    0},
+    {"BUS_OFF_RECOVERY",    parameterType::INT32,   0,     1000,    CAN_RECOVERY_TIME}
+};
+
+const parameterType ParameterHandler::measurementTypes[static_cast<uint8_t>(measurement::COUNT)] = {
+    parameterType::FLOAT,   // PERCENT_APPS
+    parameterType::FLOAT,   // PERCENT_BSE
+    parameterType::INT32,   // SDC_TAP
+    parameterType::INT32,   // STATE
+    parameterType::INT32,   // FAULTS
+    parameterType::INT32,   // MOTOR_TEMPERATURE
+    parameterType::INT32    // SPEED
+};
+
+parameterValue_t ParameterHandler::active[static_cast<uint8_t>(parameter::COUNT)] = {};
+parameterValue_t ParameterHandler::staged[static_cast<uint8_t>(parameter::COUNT)] = {};
+parameterValue_t ParameterHandler::measurements[static_cast<uint8_t>(measurement::COUNT)] = {};
+uint16_t ParameterHandler::revision = 0;
+canParamRequest_t ParameterHandler::request = {};
+volatile bool ParameterHandler::bRequestPending = false;
+
+// Frame templates
+static constexpr CAN_message_t responseTemplate = MakeFrameTemplate(ID_PARAM_RESPONSE, PAR_PARAM_RESPONSE_DLC);
+
+/*-----------------------------------------------------------------------------
+ Check a value against its parameter limits - Returns false if out of range
+-----------------------------------------------------------------------------*/
+static bool InRange(const parameterInfo_t & info, parameterValue_t value) {
+    if (info.type == parameterType::FLOAT) {
+        // NaN fails both comparisons
+        return value.f >= info.minimum && value.f <= info.maximum;
+    }
+
+    return value.i >= static_cast<int32_t>(info.minimum) && value.i <= static_cast<int32_t>(info.maximum);
+}
+
+/*-----------------------------------------------------------------------------
+ Reset active and staged values to the compile-time defaults
+-----------------------------------------------------------------------------*/
+void ParameterHandler::SetDefaults(void) {
+    for (uint8_t index = 0; index < static_cast<uint8_t>(parameter::COUNT); ++index) {
+        if (info[index].type == parameterType::FLOAT) {
+            active[index].f = info[index].defaultValue;
+        } else {
+            active[index].i = static_cast<int32_t>(info[index].defaultValue);
+        }
+
+        staged[index] = active[index];
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ Load the values of the config store (defaults if missing or corrupt)
+-----------------------------------------------------------------------------*/
+void ParameterHandler::LoadParameters(void) {
+    const parameterValue_t * pStored = ConfigHandler::GetParameters();
+
+    SetDefaults();
+
+    if (!pStored) {
+        // The store is rebuilt around the defaults
+        ConfigHandler::SetParameters(active);
+        DebugPrintln("PARAMETERS: USING DEFAULTS");
+        return;
+    }
+
+    // Limits may have tightened since the values were saved
+    for (uint8_t index = 0; index < static_cast<uint8_t>(parameter::COUNT); ++index) {
+        if ( InRange(info[index], pStored[index]) ) {
+            active[index] = pStored[index];
+            staged[index] = pStored[index];
+        } else {
+            DebugPrint("PARAMETERS: DEFAULT USED FOR "); DebugPrintln(info[index].pName);
+        }
+    }
+
+    ConfigHandler::SetParameters(active);
+    ++revision;
+
+    DebugPrintln("PARAMETERS LOADED");
+}
+
+/*-----------------------------------------------------------------------------
+ Store the active values with the rest of the config - Returns false if the read back fails
+-----------------------------------------------------------------------------*/
+bool ParameterHandler::SaveParameters(void) {
+    ConfigHandler::SetParameters(active);
+
+    return ConfigHandler::SaveConfig();
+}
+
+/*-----------------------------------------------------------------------------
+ Store a parameter request for the main loop (called from CAN ISR)
+-----------------------------------------------------------------------------*/
+void ParameterHandler::ReceiveRequest(const CAN_message_t & message) {
+    // One request at a time - the tool waits for each response
+    if (message.id != ID_PARAM_REQUEST || message.len != PAR_PARAM_REQUEST_DLC || bRequestPending) {
+        return;
+    }
+
+    request = DecodeParamRequest(message.buf);
+    bRequestPending = true;
+}
+
+/*-----------------------------------------------------------------------------
+ Stage a new value - Returns the response status
+-----------------------------------------------------------------------------*/
+uint8_t ParameterHandler::WriteStaged(uint8_t index, parameterValue_t value) {
+    if ( !InRange(info[index], value) ) {
+        return PARAM_STATUS_RANGE;
+    }
+
+    staged[index] = value;
+
+    return PARAM_STATUS_OK;
+}
+
+/*-----------------------------------------------------------------------------
+ Check the vehicle state - Returns true if the driver can request torque
+-----------------------------------------------------------------------------*/
+bool ParameterHandler::GetDriving(void) {
+    systemState state = static_cast<systemState>( measurements[static_cast<uint8_t>(measurement::STATE)].i );
+
+    return state == systemState::IDLE || state == systemState::DRIVE || state == systemState::BRAKE;
+}
+
+/*-----------------------------------------------------------------------------
+ Handle a pending request and send the response
+-----------------------------------------------------------------------------*/
+void ParameterHandler::ServiceParameters(void) {
+    CAN_message_t message;
+
+    if (!bRequestPending) {
+        return;
+    }
+
+    canParamRequest_t current = request;
+    canParamResponse_t response = {};
+
+    response.command = current.command | PARAM_CMD_RESPONSE;
+    response.index = current.index;
+
+    switch (current.command) {
+        case (PARAM_CMD_READ):
+        case (PARAM_CMD_WRITE):
+            if ( current.index >= static_cast<uint8_t>(parameter::COUNT) ) {
+                response.status = PARAM_STATUS_BAD_INDEX;
+                break;
+            }
+
+            if (current.command == PARAM_CMD_WRITE) {
+                parameterValue_t value;
+                value.raw = current.value;
+                response.status = WriteStaged(current.index, value);
+            }
+
+            response.type = static_cast<uint8_t>(info[current.index].type);
+            response.value = (current.command == PARAM_CMD_WRITE) ? staged[current.index].raw : active[current.index].raw;
+            break;
+
+        // Readers only run in the main loop, so the swap is never seen half done
+        case (PARAM_CMD_COMMIT):
+            // Limits never change under the driver
+            if ( GetDriving() ) {
+                response.status = PARAM_STATUS_STATE;
+                response.value = revision;
+                break;
+            }
+
+            memcpy(active, staged, sizeof(active));
+            response.value = ++revision;
+            DebugPrintln("PARAMETERS COMMITTED");
+            break;
+
+        case (PARAM_CMD_DISCARD):
+            memcpy(staged, active, sizeof(staged));
+            response.value = revision;
+            break;
+
+        // EEPROM writes block the loop for milliseconds
+        case (PARAM_CMD_SAVE):
+            if ( GetDriving() ) {
+                response.status = PARAM_STATUS_STATE;
+                response.value = revision;
+                break;
+            }
+
+            response.status = SaveParameters() ? PARAM_STATUS_OK : PARAM_STATUS_STORAGE;
+            response.value = revision;
+            break;
+
+        case (PARAM_CMD_MEASURE):
+            if ( current.index >= static_cast<uint8_t>(measurement::COUNT) ) {
+                response.status = PARAM_STATUS_BAD_INDEX;
+                break;
+            }
+
+            response.type = static_cast<uint8_t>(measurementTypes[current.index]);
+            response.value = measurements[current.index].raw;
+            break;
+
+        case (PARAM_CMD_INFO):
+            response.index = static_cast<uint8_t>(parameter::COUNT);
+            response.type = static_cast<uint8_t>(measurement::COUNT);
+            response.value = revision;
+            break;
+
+        default:
+            response.status = PARAM_STATUS_BAD_COMMAND;
+            break;
+    }
+
+    // Free the request slot for the ISR
+    bRequestPending = false;
+
+    message = responseTemplate;
+    EncodeParamResponse(response, message.buf);
+    SendCANMessage(message);
+}
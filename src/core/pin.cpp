@@ -45,7 +45,8 @@ digitalPin::digitalPin(const uint8_t pinValue, bool bPinMode) :
 analogPin::analogPin(const uint8_t pinValue, bool bPinMode) :
 	// Initialize a GPIO pin with a specified pin value and mode
 	GPIO {pinValue, bPinMode},
-	buffer( (size_t) 0 ) {}
+	buffer( (size_t) 0 ),
+	sampleTime(0) {}
 
 /*-----------------------------------------------------------------------------
  Analog pin constructor with a circular buffer
@@ -53,7 +54,21 @@ analogPin::analogPin(const uint8_t pinValue, bool bPinMode) :
 analogPin::analogPin(const uint8_t pinValue, bool bPinMode, size_t size) :
 	// Initialize a GPIO pin with a specified pin value and mode
 	GPIO {pinValue, bPinMode},
-	buffer(size) {}
+	buffer(size),
+	sampleTime(0) {}
+
+/*-----------------------------------------------------------------------------
+ Read the analog pin and time stamp the sample
+-----------------------------------------------------------------------------*/
+uint16_t analogPin::ReadRawPinAnalog(void) {
+	uint32_t start = micros();
+	uint16_t value = analogRead(pin);
+
+	// analogRead blocks for the whole conversion - the pin is sampled part way through
+	sampleTime = start + (micros() - start) / 2;
+
+	return value;
+}
 
 /*-----------------------------------------------------------------------------
  Debounce the incoming signal into the pin
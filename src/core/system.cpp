@@ -5,7 +5,7 @@
 -----------------------------------------------------------------------------*/
 void systemData::ActivateBrakeLight(void) {
     // Check if brake is significantly pressed to activate brake light
-    if ( BSE.GetPercentRequest() * 100 > PERCENT_BRAKE ) {
+    if ( BSE.GetPercentRequest() * 100 > ParameterHandler::GetInt(parameter::BRAKE_PERCENT) ) {
         pinBrakeLight.WriteOutput(HIGH);
     } else {
         pinBrakeLight.WriteOutput(LOW);
@@ -26,14 +26,8 @@ void systemData::UpdatePedalStructures(void) {
  Sample the SDC tap
 -----------------------------------------------------------------------------*/
 void systemData::UpdateSDCTapBuffer(void) {
-    // Get the signal buffer
-    circularBuffer buffer = pinSDCTap.GetBuffer();
-
-    // Get the latest pin reading and add to buffer
-    buffer.PushBuffer( pinSDCTap.ReadRawPinAnalog() );
-
-    // Set the SDC tap buffer
-    pinSDCTap.SetBuffer(buffer);
+    // Add the latest pin reading to the signal buffer
+    pinSDCTap.GetBuffer().PushBuffer( pinSDCTap.ReadRawPinAnalog() );
 }
 
 /*-----------------------------------------------------------------------------
@@ -51,8 +45,8 @@ bool systemData::CheckPedalImplausibility(void) {
             // Start millisecond timer
             pedalErrorTimer = 0;
             bPedalError = true;
-        } else if (pedalErrorTimer > IMPLAUSIBILITY_TIME) {
-            // Return true when error(s) occurs for 100 ms 
+        } else if (pedalErrorTimer > ParameterHandler::GetUInt(parameter::IMPLAUSIBILITY_MS)) {
+            // Return true when error(s) occurs for the implausibility time
             bResult = true;
             
             // Reset error check flag
@@ -75,7 +69,7 @@ bool systemData::ReadyToDrive(void) {
     bool bRTDButtonPressed = pinRTDButton.ReadPulsedPin( pinRTDButton.ReadDebouncedPin() );
 
     // Check brake and RTD button are pressed
-    return brakeRequest >= PERCENT_BRAKE && bRTDButtonPressed;
+    return brakeRequest >= ParameterHandler::GetInt(parameter::BRAKE_PERCENT) && bRTDButtonPressed;
 }
 
 /*-----------------------------------------------------------------------------
@@ -99,7 +93,7 @@ void systemData::DeactivateBamocar(void) {
 /*----------------------------------------------------------------------------- 
  Use the previous functions to process incoming APPS data
 -----------------------------------------------------------------------------*/
-void systemData::ProcessAPPS(uint8_t * pTorqueBuf) {
+uint16_t systemData::ProcessAPPS(void) {
     // Fetch and average analog data
     uint16_t torqueAPPS1 = APPS1.GetTorqueRequest();
     uint16_t torqueAPPS2 = APPS2.GetTorqueRequest();
@@ -107,11 +101,8 @@ void systemData::ProcessAPPS(uint8_t * pTorqueBuf) {
     // Obtain the lower signal
     uint16_t signal = (torqueAPPS1 < torqueAPPS2) ? torqueAPPS1 : torqueAPPS2;
 
-    // Set the data buffer equal to the processed signal
-    if ( CheckAPPS() ) {
-        pTorqueBuf[2] = signal & BYTE_ONE;
-        pTorqueBuf[1] = (signal & BYTE_TWO) >> 8;
-    }
+    // Only request torque while the signals agree
+    return CheckAPPS() ? signal : 0;
 }
 
 /*----------------------------------------------------------------------------- 
@@ -135,7 +126,7 @@ bool systemData::CheckAPPS(void) {
     float requestAPPS2 = APPS2.GetPercentRequest();
 
     // Return the lower percent request
-    return abs(requestAPPS1 - requestAPPS2) <= APPS_AGREEMENT;
+    return abs(requestAPPS1 - requestAPPS2) * 100 <= ParameterHandler::GetInt(parameter::AGREEMENT_PERCENT);
 }
 
 /*-----------------------------------------------------------------------------
@@ -155,7 +146,7 @@ bool systemData::CheckPedalPlausibility(void) {
     float requestBSE = BSE.GetPercentRequest() * 100;
     
     // Check if both pedals are pressed
-    return requestAPPS > PERCENT_ACCEL && requestBSE > PERCENT_BRAKE;
+    return requestAPPS > ParameterHandler::GetInt(parameter::ACCEL_PERCENT) && requestBSE > ParameterHandler::GetInt(parameter::BRAKE_PERCENT);
 }
 
 /*-----------------------------------------------------------------------------
@@ -205,60 +196,39 @@ bool systemData::CheckAllErrors(void) {
 }
 
 /*-----------------------------------------------------------------------------
- Extract encoded values from SD file to set bounds for percent requests
+ Set bounds for percent requests from the config store - Returns false if none are stored
 -----------------------------------------------------------------------------*/
 bool systemData::SetPedalBounds(void) {
-    bool bSuccessfulLoad = false;
-    size_t bufferLength;
+    configPedals_t pedals;
 
     // Obtain the pedal sensors
     hall * sensors[NUM_SENSORS] = {&APPS1, &APPS2, &BSE};
 
-    // Open file in SD card
-    File fPedalBounds = SD.open(FILE_PEDAL_BOUNDS, FILE_READ);
-
-    // Check file has opened
-    if (fPedalBounds) {
-        // Read sensor data and convert to array of integers
-        String pedalBoundString = fPedalBounds.readString();
-        const char * strPedalBounds = pedalBoundString.c_str();
-        uint16_t * pPedalBounds = SplitIntegerString(strPedalBounds, DELIMITER, bufferLength);
-
-        // Check number of values read matches number of bounds for sensors
-        if (pPedalBounds && bufferLength == 2 * NUM_SENSORS) {
-            // Iterate through each set of bounds per sensor
-            for (uint8_t index = 0; index < NUM_SENSORS; ++index) {
-                // Determine if the sensor voltage increases with actuation
-                bool bVoltageInverted = sensors[index]->GetVoltageInverted();
-
-                // Use direct or swapped bounds based on inversion
-                uint16_t upper = bVoltageInverted ? pPedalBounds[index + NUM_SENSORS] : pPedalBounds[index];
-                uint16_t lower = bVoltageInverted ? pPedalBounds[index] : pPedalBounds[index + NUM_SENSORS];
-
-                // Apply tolerance to lower bound
-                lower = static_cast<uint16_t>(lower * 0.97);
-
-                // Set the bounds
-                sensors[index]->SetPercentRequestUpperBound(upper);
-                sensors[index]->SetPercentRequestLowerBound(lower);
-            }
+    // Read from EEPROM at boot - nothing to parse
+    if ( !ConfigHandler::GetPedalBounds(pedals) ) {
+        return false;
+    }
 
-            bSuccessfulLoad = true;
+    // Iterate through each set of bounds per sensor
+    for (uint8_t index = 0; index < NUM_SENSORS; ++index) {
+        // Determine if the sensor voltage increases with actuation
+        bool bVoltageInverted = sensors[index]->GetVoltageInverted();
 
-            DebugPrintln("PEDAL BOUNDS SET");
-        }
+        // Use direct or swapped bounds based on inversion
+        uint16_t upper = bVoltageInverted ? pedals.lower[index] : pedals.upper[index];
+        uint16_t lower = bVoltageInverted ? pedals.upper[index] : pedals.lower[index];
 
-        // Free buffer from memory
-        if (pPedalBounds) {
-            free(pPedalBounds);
-            pPedalBounds = NULL;
-        }
+        // Apply tolerance to lower bound
+        lower = static_cast<uint16_t>(lower * 0.97);
 
-        // Close the file
-        fPedalBounds.close();
+        // Set the bounds
+        sensors[index]->SetPercentRequestUpperBound(upper);
+        sensors[index]->SetPercentRequestLowerBound(lower);
     }
 
-    return bSuccessfulLoad;
+    DebugPrintln("PEDAL BOUNDS SET");
+
+    return true;
 }
 
 /*-----------------------------------------------------------------------------
@@ -295,9 +265,20 @@ void systemData::RampPump(bool direction) {
 void systemData::RunPump(void) {
     static uint32_t prechargeTimer = millis();
     static bool bPumpActivated = false;
+    static uint16_t parameterRevision = 0;
+
+    // Apply new PID gains once per parameter commit
+    if ( parameterRevision != ParameterHandler::GetRevision() ) {
+        pump.TunePIDGains( ParameterHandler::GetFloat(parameter::PUMP_KP), ParameterHandler::GetFloat(parameter::PUMP_KI),
+            ParameterHandler::GetFloat(parameter::PUMP_KD) );
+        parameterRevision = ParameterHandler::GetRevision();
+    }
+
+    // Motor temperature decoded from Bamocar telemetry (Celsius)
+    int16_t motorTemperature = TelemetryHandler::GetMotorTemperature();
 
     // Check if pump has not been activated and motor temperature is high
-    if ( !bPumpActivated && IRQHandler::GetMotorTemperature() > 40 ) {
+    if ( !bPumpActivated && motorTemperature > 40 ) {
         // Initially turn on pin driving pump through precharge resistor
         pinPump.WriteOutput(HIGH);
 
@@ -312,7 +293,7 @@ void systemData::RunPump(void) {
             // Mark pump as activated
             bPumpActivated = true;
         }
-    } else if ( bPumpActivated && IRQHandler::GetMotorTemperature() < 20 ) {
+    } else if ( bPumpActivated && motorTemperature < 20 ) {
         // Turn off the pump
         pinPump.WriteOutput(LOW);
         pinPumpSwitch.WriteOutput(LOW);
@@ -322,6 +303,34 @@ void systemData::RunPump(void) {
     }
 }
 
+/*-----------------------------------------------------------------------------
+ Pass the vehicle state, faults and pedal requests to the dashboard frames
+-----------------------------------------------------------------------------*/
+void systemData::UpdateDashboardStatus(void) {
+    // Get the pedal percent requests
+    float requestAPPS = GetLowerPercentAPPS() * 100;
+    float requestBSE = BSE.GetPercentRequest() * 100;
+
+    // Limit percent requests to a single byte (0 - 100%)
+    uint8_t percentAPPS = static_cast<uint8_t>( constrain(requestAPPS, 0, 100) );
+    uint8_t percentBSE = static_cast<uint8_t>( constrain(requestBSE, 0, 100) );
+
+    DashboardHandler::SetVehicleStatus(stateBuf, faultBuf, percentAPPS, percentBSE);
+}
+
+/*-----------------------------------------------------------------------------
+ Publish live values for the parameter service
+-----------------------------------------------------------------------------*/
+void systemData::UpdateMeasurements(void) {
+    ParameterHandler::SetMeasurement( measurement::PERCENT_APPS, GetLowerPercentAPPS() * 100 );
+    ParameterHandler::SetMeasurement( measurement::PERCENT_BSE, BSE.GetPercentRequest() * 100 );
+    ParameterHandler::SetMeasurement( measurement::SDC_TAP, static_cast<int32_t>( pinSDCTap.GetBuffer().GetAverage() ) );
+    ParameterHandler::SetMeasurement( measurement::STATE, static_cast<int32_t>(stateBuf) );
+    ParameterHandler::SetMeasurement( measurement::FAULTS, static_cast<int32_t>(faultBuf) );
+    ParameterHandler::SetMeasurement( measurement::MOTOR_TEMPERATURE, static_cast<int32_t>( TelemetryHandler::GetMotorTemperature() ) );
+    ParameterHandler::SetMeasurement( measurement::SPEED, static_cast<int32_t>( TelemetryHandler::GetValue(bamocarSignal::SPEED) ) );
+}
+
 /*-----------------------------------------------------------------------------
  Output what errors occurred during a fault condition
 -----------------------------------------------------------------------------*/
@@ -0,0 +1,50 @@
+#include "core/timebase.h"
+
+// Initialize variables
+timebaseEpoch_t TimebaseHandler::epochs[2] = {};
+volatile uint8_t TimebaseHandler::active = 0;
+
+/*-----------------------------------------------------------------------------
+ Get the micros() time a frame finished on the bus using its hardware timestamp
+-----------------------------------------------------------------------------*/
+uint32_t TimebaseHandler::GetFrameMicros(const CAN_message_t & message) {
+    // Each controller has its own timer - FlexCAN_T4 stores the bus number in the frame
+    uint32_t timer = (message.bus == 1) ? FLEXCANb_TIMER(CAN1) : FLEXCANb_TIMER(CAN3);
+
+    // Timer ticks elapsed since the controller stamped the frame
+    uint32_t ticks = (timer - message.timestamp) & TIMEBASE_TIMER_MASK;
+
+    return micros() - ticks * TIMEBASE_TIMER_TICK_US;
+}
+
+/*-----------------------------------------------------------------------------
+ Widen a micros() time to the 64 bit ECU time (safe from ISRs)
+-----------------------------------------------------------------------------*/
+uint64_t TimebaseHandler::ExtendTime(uint32_t time) {
+    const timebaseEpoch_t & epoch = epochs[active];
+
+    // Signed so back dated frame times just before the epoch stay correct
+    return epoch.time + static_cast<int32_t>(time - epoch.micros);
+}
+
+/*-----------------------------------------------------------------------------
+ Start the ECU time at the current micros() (call first in setup)
+-----------------------------------------------------------------------------*/
+void TimebaseHandler::BeginTimebase(void) {
+    uint32_t now = micros();
+
+    epochs[active] = {now, now};
+}
+
+/*-----------------------------------------------------------------------------
+ Move the epoch forward (every loop - must run well within the 71 minute micros() wrap)
+-----------------------------------------------------------------------------*/
+void TimebaseHandler::ServiceTimebase(void) {
+    uint8_t next = active ^ 1;
+    uint32_t now = micros();
+
+    epochs[next] = {ExtendTime(now), now};
+
+    // Publish the epoch after it is complete
+    active = next;
+}
@@ -0,0 +1,126 @@
+#include "daq/datalog.h"
+#include "daq/trace.h"
+#include "core/FSM.h"
+
+// Initialize variables
+const char DatalogHandler::names[DATALOG_NUM_CHANNELS][CHANNEL_NAME_SIZE] = {
+	"APPS1", "APPS2", "BSE", "TORQUE", "STATE", "FAULTS",
+	"SPEED", "MOTOR_TEMP", "BAMOCAR_TEMP", "PHASE_ONE", "PHASE_TWO", "PHASE_THREE"
+};
+
+streamLogger DatalogHandler::logger(DATALOG_FILE_NAME, DATALOG_FILE_SIZE, DatalogHandler::WriteHeader);
+channelEncoder DatalogHandler::encoder(DATALOG_NUM_CHANNELS);
+uint64_t DatalogHandler::lastSample = 0;
+uint32_t DatalogHandler::samples = 0;
+uint8_t DatalogHandler::lastFaults = 0;
+sessionIndexEntry_t DatalogHandler::block = {};
+bool DatalogHandler::bBlockStarted = false;
+
+/*-----------------------------------------------------------------------------
+ Fill the first sector of a new data log
+-----------------------------------------------------------------------------*/
+void DatalogHandler::WriteHeader(uint8_t * pSector) {
+	channelFileHeader_t header = {};
+
+	static_assert(sizeof(header) == LOGGER_SECTOR_SIZE, "Channel log header must fill one sector");
+
+	memcpy(header.magic, CHANNEL_MAGIC, sizeof(CHANNEL_MAGIC));
+	header.version = CHANNEL_VERSION;
+	header.numChannels = DATALOG_NUM_CHANNELS;
+	header.keyframeInterval = CHANNEL_KEYFRAME_INTERVAL;
+	header.bufferSectors = LOGGER_BUFFER_SECTORS;
+	header.samplePeriod = DATALOG_SAMPLE_PERIOD;
+	header.startTime = millis();
+	header.startEpoch = TimebaseHandler::GetTime();
+	memcpy(header.names, names, sizeof(names));
+
+	memcpy(pSector, &header, sizeof(header));
+}
+
+/*-----------------------------------------------------------------------------
+ Start logging channels (call after BeginSession)
+-----------------------------------------------------------------------------*/
+bool DatalogHandler::BeginDatalog(void) {
+	if ( !logger.Begin(SessionHandler::GetSession(), SESSION_MAX_FILES) ) {
+		return false;
+	}
+
+	DebugPrint("DATA LOG: "); DebugPrintln( logger.GetFileName() );
+
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Encode one sample of every channel each sample period
+-----------------------------------------------------------------------------*/
+void DatalogHandler::SampleChannels(systemData & system) {
+	uint64_t now = TimebaseHandler::GetTime();
+	int32_t values[DATALOG_NUM_CHANNELS];
+	uint8_t record[CHANNEL_RECORD_MAX(DATALOG_NUM_CHANNELS)];
+	uint16_t length = 0;
+	uint32_t space = logger.GetFree();
+	bool bBufferStart = false;
+
+	if ( !logger.GetOpen() || now - lastSample < DATALOG_SAMPLE_PERIOD ) {
+		return;
+	}
+
+	lastSample = now;
+
+	values[static_cast<uint8_t>(datalogChannel::APPS1)] = system.GetAPPS1().GetRawOutput();
+	values[static_cast<uint8_t>(datalogChannel::APPS2)] = system.GetAPPS2().GetRawOutput();
+	values[static_cast<uint8_t>(datalogChannel::BSE)] = system.GetBSE().GetRawOutput();
+	values[static_cast<uint8_t>(datalogChannel::TORQUE)] = TorqueHandler::GetLastTorque();
+	values[static_cast<uint8_t>(datalogChannel::STATE)] = system.GetStateBuffer();
+	values[static_cast<uint8_t>(datalogChannel::FAULTS)] = system.GetFaultBuffer();
+	values[static_cast<uint8_t>(datalogChannel::SPEED)] = TelemetryHandler::GetValue(bamocarSignal::SPEED);
+	values[static_cast<uint8_t>(datalogChannel::MOTOR_TEMP)] = TelemetryHandler::GetValue(bamocarSignal::MOTOR_TEMP);
+	values[static_cast<uint8_t>(datalogChannel::BAMOCAR_TEMP)] = TelemetryHandler::GetValue(bamocarSignal::BAMOCAR_TEMP);
+	values[static_cast<uint8_t>(datalogChannel::PHASE_ONE)] = TelemetryHandler::GetValue(bamocarSignal::PHASE_ONE);
+	values[static_cast<uint8_t>(datalogChannel::PHASE_TWO)] = TelemetryHandler::GetValue(bamocarSignal::PHASE_TWO);
+	values[static_cast<uint8_t>(datalogChannel::PHASE_THREE)] = TelemetryHandler::GetValue(bamocarSignal::PHASE_THREE);
+
+	length = encoder.Encode(now, values, record);
+
+	// Every buffer starts with a keyframe so a decoder can begin at any buffer (or file)
+	bBufferStart = (space == LOGGER_BUFFER_SIZE || length > space);
+
+	if (bBufferStart) {
+		encoder.ForceKeyframe();
+		length = encoder.Encode(now, values, record);
+	}
+
+	// A lost record breaks the delta chain - restart it with a keyframe
+	if ( !logger.Write(record, length) ) {
+		encoder.ForceKeyframe();
+	} else if (bBufferStart) {
+		// Index the finished buffer and start summarizing this one
+		if (bBlockStarted) {
+			SessionHandler::AddIndexEntry(block);
+		}
+
+		block = {now, logger.GetBufferIndex(), 0, 0, 0};
+		bBlockStarted = true;
+	}
+
+	// States and faults seen in a buffer let host tools jump to events
+	block.states |= 1 << (system.GetStateBuffer() & 0x0F);
+	block.faults |= system.GetFaultBuffer();
+
+	// Write both streams through on a new fault so its lead-up survives a power cut
+	if (system.GetFaultBuffer() & ~lastFaults) {
+		logger.RequestFlush();
+		TraceHandler::RequestFlush();
+	}
+
+	lastFaults = system.GetFaultBuffer();
+
+	++samples;
+}
+
+/*-----------------------------------------------------------------------------
+ Move the next buffer to the SD card (called by StorageHandler) - Returns true if the card was used
+-----------------------------------------------------------------------------*/
+bool DatalogHandler::ServiceDatalog(void) {
+	return logger.Service();
+}
@@ -0,0 +1,282 @@
+#include "daq/fileservice.h"
+
+// Initialize variables
+bool FileServiceHandler::bActive = false;
+storageTransfer_t FileServiceHandler::transfer = {};
+
+/*-----------------------------------------------------------------------------
+ Little-endian field access
+-----------------------------------------------------------------------------*/
+static inline uint16_t GetU16(const uint8_t * pData) {
+	return pData[0] | (pData[1] << 8);
+}
+
+static inline uint32_t GetU32(const uint8_t * pData) {
+	return pData[0] | (pData[1] << 8) | (pData[2] << 16) | (static_cast<uint32_t>(pData[3]) << 24);
+}
+
+static inline void SetU16(uint8_t * pData, uint16_t value) {
+	pData[0] = value & 0xFF;
+	pData[1] = value >> 8;
+}
+
+static inline void SetU32(uint8_t * pData, uint32_t value) {
+	pData[0] = value & 0xFF;
+	pData[1] = (value >> 8) & 0xFF;
+	pData[2] = (value >> 16) & 0xFF;
+	pData[3] = value >> 24;
+}
+
+/*-----------------------------------------------------------------------------
+ Write the response command and status - Returns the bytes used
+-----------------------------------------------------------------------------*/
+uint16_t FileServiceHandler::SetStatus(uint8_t * pResponse, uint8_t command, uint8_t status) {
+	pResponse[0] = command | FILE_CMD_RESPONSE;
+	pResponse[1] = status;
+
+	return FILE_RESPONSE_HEADER;
+}
+
+/*-----------------------------------------------------------------------------
+ Map the result of a queued transfer to a response status
+-----------------------------------------------------------------------------*/
+uint8_t FileServiceHandler::GetStorageStatus(uint8_t status) {
+	switch (status) {
+		case (STORAGE_STATUS_OK):
+			return FILE_STATUS_OK;
+
+		case (STORAGE_STATUS_NOT_FOUND):
+			return FILE_STATUS_NOT_FOUND;
+
+		case (STORAGE_STATUS_BAD_RANGE):
+			return FILE_STATUS_BAD_REQUEST;
+
+		default:
+			return FILE_STATUS_IO_ERROR;
+	}
+}
+
+/*-----------------------------------------------------------------------------
+ Get the null terminated file name at the start of a request field
+-----------------------------------------------------------------------------*/
+const char * FileServiceHandler::GetFileName(const uint8_t * pRequest, uint16_t length, uint16_t & end) {
+	const uint8_t * pEnd = static_cast<const uint8_t *>( memchr(pRequest, '\0', length) );
+
+	// Missing terminator, empty name or too long for the storage queue
+	if (!pEnd || pEnd == pRequest || pEnd - pRequest >= STORAGE_NAME_SIZE) {
+		return NULL;
+	}
+
+	end = pEnd - pRequest + 1;
+
+	return reinterpret_cast<const char *>(pRequest);
+}
+
+/*-----------------------------------------------------------------------------
+ List the files in the root directory from an index through the storage queue
+-----------------------------------------------------------------------------*/
+uint16_t FileServiceHandler::ListFiles(const uint8_t * pRequest, uint16_t length, uint8_t * pResponse) {
+	if (!bActive) {
+		if (length < 3) {
+			return SetStatus(pResponse, FILE_CMD_LIST, FILE_STATUS_BAD_REQUEST);
+		}
+
+		// Entries are size (u32), name length (u8) and name - the host asks again from index + count
+		transfer.pData = &pResponse[FILE_LIST_HEADER];
+		transfer.offset = GetU16(&pRequest[1]);
+		transfer.length = TRANSPORT_MAX_LENGTH - FILE_LIST_HEADER;
+		transfer.bTruncate = false;
+
+		// Queue full - asked again next loop
+		bActive = StorageHandler::QueueTransfer("/", storageOperation::LIST, transfer);
+
+		return 0;
+	}
+
+	if (transfer.status == STORAGE_STATUS_PENDING) {
+		return 0;
+	}
+
+	bActive = false;
+
+	if (transfer.status != STORAGE_STATUS_OK) {
+		return SetStatus( pResponse, FILE_CMD_LIST, GetStorageStatus(transfer.status) );
+	}
+
+	SetStatus(pResponse, FILE_CMD_LIST, FILE_STATUS_OK);
+	SetU16(&pResponse[FILE_RESPONSE_HEADER], (transfer.size > transfer.offset) ? transfer.size - transfer.offset : 0);
+
+	return FILE_LIST_HEADER + transfer.moved;
+}
+
+/*-----------------------------------------------------------------------------
+ Read a range of a file (clamped to one transfer) through the storage queue
+-----------------------------------------------------------------------------*/
+uint16_t FileServiceHandler::ReadFile(const uint8_t * pRequest, uint16_t length, uint8_t * pResponse) {
+	if (!bActive) {
+		uint16_t nameEnd = 0;
+		const char * pName = (length > 7) ? GetFileName(&pRequest[7], length - 7, nameEnd) : NULL;
+
+		if (!pName) {
+			return SetStatus(pResponse, FILE_CMD_READ, FILE_STATUS_BAD_REQUEST);
+		}
+
+		uint16_t count = GetU16(&pRequest[5]);
+
+		transfer.pData = &pResponse[FILE_READ_HEADER];
+		transfer.offset = GetU32(&pRequest[1]);
+		transfer.length = (count > FILE_MAX_READ) ? FILE_MAX_READ : count;
+		transfer.bTruncate = false;
+
+		// Queue full - asked again next loop
+		bActive = StorageHandler::QueueTransfer(pName, storageOperation::READ, transfer);
+
+		return 0;
+	}
+
+	if (transfer.status == STORAGE_STATUS_PENDING) {
+		return 0;
+	}
+
+	bActive = false;
+
+	if (transfer.status != STORAGE_STATUS_OK) {
+		return SetStatus( pResponse, FILE_CMD_READ, GetStorageStatus(transfer.status) );
+	}
+
+	SetStatus(pResponse, FILE_CMD_READ, FILE_STATUS_OK);
+	SetU32(&pResponse[FILE_RESPONSE_HEADER], transfer.offset);
+
+	return FILE_READ_HEADER + transfer.moved;
+}
+
+/*-----------------------------------------------------------------------------
+ Write data into a file at an offset (no further than the current end) through the storage queue
+-----------------------------------------------------------------------------*/
+uint16_t FileServiceHandler::WriteFile(const uint8_t * pRequest, uint16_t length, uint8_t * pResponse) {
+	if (!bActive) {
+		uint16_t nameEnd = 0;
+		const char * pName = (length > 6) ? GetFileName(&pRequest[6], length - 6, nameEnd) : NULL;
+
+		if (!pName) {
+			return SetStatus(pResponse, FILE_CMD_WRITE, FILE_STATUS_BAD_REQUEST);
+		}
+
+		// Data stays in the request buffer - it is not released until the write is done
+		transfer.pData = const_cast<uint8_t *>(&pRequest[6 + nameEnd]);
+		transfer.offset = GetU32(&pRequest[1]);
+		transfer.length = length - 6 - nameEnd;
+		transfer.bTruncate = pRequest[5] & FILE_WRITE_TRUNCATE;
+
+		// Queue full - asked again next loop
+		bActive = StorageHandler::QueueTransfer(pName, storageOperation::WRITE, transfer);
+
+		return 0;
+	}
+
+	if (transfer.status == STORAGE_STATUS_PENDING) {
+		return 0;
+	}
+
+	bActive = false;
+
+	if (transfer.status != STORAGE_STATUS_OK) {
+		return SetStatus( pResponse, FILE_CMD_WRITE, GetStorageStatus(transfer.status) );
+	}
+
+	DebugPrint("FILE WRITTEN OVER CAN: "); DebugPrintln( reinterpret_cast<const char *>(&pRequest[6]) );
+
+	SetStatus(pResponse, FILE_CMD_WRITE, FILE_STATUS_OK);
+	SetU32(&pResponse[FILE_RESPONSE_HEADER], transfer.size);
+
+	return FILE_RESPONSE_HEADER + 4;
+}
+
+/*-----------------------------------------------------------------------------
+ CRC-32 of a whole file through the storage queue
+-----------------------------------------------------------------------------*/
+uint16_t FileServiceHandler::CalculateCRC(const uint8_t * pRequest, uint16_t length, uint8_t * pResponse) {
+	if (!bActive) {
+		uint16_t nameEnd = 0;
+		const char * pName = (length > 1) ? GetFileName(&pRequest[1], length - 1, nameEnd) : NULL;
+
+		if (!pName) {
+			return SetStatus(pResponse, FILE_CMD_CRC, FILE_STATUS_BAD_REQUEST);
+		}
+
+		transfer.pData = NULL;
+		transfer.offset = 0;
+		transfer.length = 0;
+		transfer.bTruncate = false;
+
+		// Queue full - asked again next loop
+		bActive = StorageHandler::QueueTransfer(pName, storageOperation::CRC, transfer);
+
+		return 0;
+	}
+
+	if (transfer.status == STORAGE_STATUS_PENDING) {
+		return 0;
+	}
+
+	bActive = false;
+
+	if (transfer.status != STORAGE_STATUS_OK) {
+		return SetStatus( pResponse, FILE_CMD_CRC, GetStorageStatus(transfer.status) );
+	}
+
+	SetStatus(pResponse, FILE_CMD_CRC, FILE_STATUS_OK);
+	SetU32(&pResponse[FILE_RESPONSE_HEADER], transfer.size);
+	SetU32(&pResponse[FILE_RESPONSE_HEADER + 4], transfer.crc);
+
+	return FILE_RESPONSE_HEADER + 8;
+}
+
+/*-----------------------------------------------------------------------------
+ Work on the host request once the last response has gone
+-----------------------------------------------------------------------------*/
+void FileServiceHandler::ServiceFiles(void) {
+	const uint8_t * pRequest = NULL;
+	uint16_t length = 0;
+	uint16_t responseLength = 0;
+
+	TransportHandler::ServiceTransport();
+
+	// Responses share one buffer - wait for the previous one to finish
+	if ( !TransportHandler::GetIdle() || !TransportHandler::GetRequest(pRequest, length) ) {
+		return;
+	}
+
+	uint8_t * pResponse = TransportHandler::GetTxBuffer();
+
+	switch (pRequest[0]) {
+		case (FILE_CMD_LIST):
+			responseLength = ListFiles(pRequest, length, pResponse);
+			break;
+
+		case (FILE_CMD_READ):
+			responseLength = ReadFile(pRequest, length, pResponse);
+			break;
+
+		case (FILE_CMD_WRITE):
+			responseLength = WriteFile(pRequest, length, pResponse);
+			break;
+
+		case (FILE_CMD_CRC):
+			responseLength = CalculateCRC(pRequest, length, pResponse);
+			break;
+
+		default:
+			responseLength = SetStatus(pResponse, pRequest[0], FILE_STATUS_BAD_REQUEST);
+			break;
+	}
+
+	// Still running - the request is kept and worked on again next loop
+	if (!responseLength) {
+		return;
+	}
+
+	// Request buffer is free for the host's next request
+	TransportHandler::ReleaseRequest();
+	TransportHandler::Send(responseLength);
+}
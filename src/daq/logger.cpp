@@ -0,0 +1,287 @@
+#include "daq/logger.h"
+
+/*-----------------------------------------------------------------------------
+ Streaming logger constructor
+-----------------------------------------------------------------------------*/
+streamLogger::streamLogger(const char * pFormat, uint32_t size, void (*pWriteHeader)(uint8_t * pSector)) :
+	pNameFormat(pFormat),
+	fileSize(size),
+	pHeader(pWriteHeader)
+{
+	head = 0;
+	tail = 0;
+	fill = 0;
+	dropped = 0;
+	written = 0;
+	active = 0;
+	fileName[0] = '\0';
+	spareName[0] = '\0';
+	spare = {};
+	bReserving = false;
+	bReserved = false;
+	sessionNumber = 0;
+	fileIndex = 0;
+	fileLimit = 0;
+	fileBytes = 0;
+	syncTimer = 0;
+	flushTimer = 0;
+	bFlush = false;
+	bSync = false;
+	bDirty = false;
+	bOpen = false;
+}
+
+/*-----------------------------------------------------------------------------
+ Open the first unused file and preallocate it while the card is not yet shared (setup only)
+ - Returns true on success
+-----------------------------------------------------------------------------*/
+bool streamLogger::OpenFile(void) {
+	FsFile & file = files[active];
+
+	// Never overwrite an earlier session
+	do {
+		if (fileIndex >= fileLimit) {
+			DebugPrint("ERROR: SESSION FILE LIMIT "); DebugPrintln(fileName);
+
+			return false;
+		}
+
+		snprintf(fileName, sizeof(fileName), pNameFormat, static_cast<unsigned>(sessionNumber), fileIndex++);
+	} while ( SD.sdfs.exists(fileName) );
+
+	file = SD.sdfs.open(fileName, O_WRONLY | O_CREAT | O_TRUNC);
+
+	// Contiguous clusters keep the sector runs free of FAT updates
+	if ( !file || !file.preAllocate(fileSize) ) {
+		DebugPrint("ERROR: OPENING "); DebugPrintln(fileName);
+		file.close();
+
+		return false;
+	}
+
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Write the header of the active file - Returns true on success
+-----------------------------------------------------------------------------*/
+bool streamLogger::StartFile(void) {
+	FsFile & file = files[active];
+	uint8_t sector[LOGGER_SECTOR_SIZE] = {};
+
+	// Header fills a whole sector so every buffer starts sector aligned
+	pHeader(sector);
+
+	if ( file.write(sector, LOGGER_SECTOR_SIZE) != LOGGER_SECTOR_SIZE ) {
+		DebugPrint("ERROR: WRITING "); DebugPrintln(fileName);
+		file.close();
+
+		return false;
+	}
+
+	fileBytes = LOGGER_SECTOR_SIZE;
+	syncTimer = millis();
+	flushTimer = syncTimer;
+	bDirty = true;
+
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Keep the next file of the session created and preallocated through the SD queue
+-----------------------------------------------------------------------------*/
+void streamLogger::ReserveFile(void) {
+	if ( bReserved || spare.status == STORAGE_STATUS_PENDING ) {
+		return;
+	}
+
+	// Allocation finished - a name already taken or a card error moves on to the next name
+	if (bReserving) {
+		bReserving = false;
+		bReserved = (spare.status == STORAGE_STATUS_OK);
+
+		if (bReserved) {
+			return;
+		}
+	}
+
+	if (fileIndex >= fileLimit) {
+		return;
+	}
+
+	snprintf(spareName, sizeof(spareName), pNameFormat, static_cast<unsigned>(sessionNumber), fileIndex);
+	spare.pFile = &files[active ^ 1];
+	spare.reserve = fileSize;
+
+	// Queue full - asked again on the next call
+	if ( StorageHandler::QueueTransfer(spareName, storageOperation::ALLOCATE, spare) ) {
+		bReserving = true;
+		++fileIndex;
+	}
+}
+
+/*-----------------------------------------------------------------------------
+ Close the full file and continue in the reserved one - Returns true if the card was used
+-----------------------------------------------------------------------------*/
+bool streamLogger::NextFile(void) {
+	// Buffers wait for the allocation (and records drop once they fill)
+	if (!bReserved) {
+		if ( !bReserving && fileIndex >= fileLimit ) {
+			DebugPrint("ERROR: SESSION FILE LIMIT "); DebugPrintln(fileName);
+			files[active].close();
+			bOpen = false;
+		}
+
+		return false;
+	}
+
+	files[active].close();
+
+	active ^= 1;
+	bReserved = false;
+	strncpy(fileName, spareName, sizeof(fileName));
+
+	if ( !StartFile() ) {
+		bOpen = false;
+	}
+
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Open the first file of a session (call after SetupSD) - Returns true on success
+-----------------------------------------------------------------------------*/
+bool streamLogger::Begin(uint32_t session, uint16_t maxFiles) {
+	sessionNumber = session;
+	fileIndex = 0;
+	fileLimit = maxFiles;
+	bOpen = OpenFile() && StartFile();
+
+	return bOpen;
+}
+
+/*-----------------------------------------------------------------------------
+ Copy a record into the filling buffer without blocking - Returns false if dropped
+-----------------------------------------------------------------------------*/
+bool streamLogger::Write(const void * pData, uint16_t length) {
+	uint32_t index = head;
+
+	// The buffer to fill is still waiting on the card
+	if (!bOpen || index - tail >= LOGGER_NUM_BUFFERS || length > LOGGER_BUFFER_SIZE) {
+		++dropped;
+		return false;
+	}
+
+	uint8_t * pBuffer = buffers[index % LOGGER_NUM_BUFFERS].data;
+
+	// Records never straddle two buffers - pad this one out and move on
+	if (fill + length > LOGGER_BUFFER_SIZE) {
+		memset(&pBuffer[fill], LOGGER_PADDING, LOGGER_BUFFER_SIZE - fill);
+		fill = 0;
+		head = ++index;
+
+		if (index - tail >= LOGGER_NUM_BUFFERS) {
+			++dropped;
+			return false;
+		}
+
+		pBuffer = buffers[index % LOGGER_NUM_BUFFERS].data;
+	}
+
+	memcpy(&pBuffer[fill], pData, length);
+	fill += length;
+
+	// Publish the buffer once it is full
+	if (fill == LOGGER_BUFFER_SIZE) {
+		fill = 0;
+		head = index + 1;
+	}
+
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Pad out the filling buffer and hand it to the writer (main loop only)
+-----------------------------------------------------------------------------*/
+void streamLogger::FlushBuffer(void) {
+	// The producer may be an ISR
+	noInterrupts();
+
+	// Only once the card has caught up - the buffer is then free to publish
+	if (fill && head == tail) {
+		memset(&buffers[head % LOGGER_NUM_BUFFERS].data[fill], LOGGER_PADDING, LOGGER_BUFFER_SIZE - fill);
+		fill = 0;
+		++head;
+	}
+
+	interrupts();
+
+	bSync |= bFlush;
+	bFlush = false;
+	flushTimer = millis();
+}
+
+/*-----------------------------------------------------------------------------
+ Run one card operation - a buffer write, a switch to the next file or a sync - which waits for
+ the card while it runs (called by StorageHandler within its budget) - Returns true if the card was used
+-----------------------------------------------------------------------------*/
+bool streamLogger::Service(void) {
+	uint32_t index = tail;
+	FsFile & file = files[active];
+
+	if (!bOpen) {
+		return false;
+	}
+
+	ReserveFile();
+
+	// Records in a quiet stream would otherwise wait for the buffer to fill
+	if ( index == head && (bFlush || millis() - flushTimer >= LOGGER_FLUSH_INTERVAL) ) {
+		FlushBuffer();
+	}
+
+	// A busy card would block the operation until it finishes programming
+	if ( file.isBusy() ) {
+		return false;
+	}
+
+	if (index != head) {
+		// Continue in the reserved file once the preallocated space is used
+		if (fileBytes + LOGGER_BUFFER_SIZE > fileSize) {
+			return NextFile();
+		}
+
+		// Sector aligned position - written as one multi-sector transfer
+		if ( file.write(buffers[index % LOGGER_NUM_BUFFERS].data, LOGGER_BUFFER_SIZE) != LOGGER_BUFFER_SIZE ) {
+			DebugPrint("ERROR: WRITING "); DebugPrintln(fileName);
+			bOpen = false;
+			return true;
+		}
+
+		fileBytes += LOGGER_BUFFER_SIZE;
+		++written;
+		flushTimer = millis();
+		bDirty = true;
+
+		// Release the buffer to the producer
+		tail = index + 1;
+
+		return true;
+	}
+
+	// Buffers written after the last sync are lost on power off
+	if ( bDirty && (bSync || millis() - syncTimer >= LOGGER_SYNC_INTERVAL) ) {
+		file.sync();
+
+		syncTimer = millis();
+		bSync = false;
+		bDirty = false;
+
+		return true;
+	}
+
+	// Nothing written since the last sync
+	bSync = false;
+
+	return false;
+}
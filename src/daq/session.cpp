@@ -0,0 +1,255 @@
+#include "daq/session.h"
+#include "daq/trace.h"
+#include "daq/datalog.h"
+#include "core/FSM.h"
+
+// Initialize variables
+sessionFileHeader_t SessionHandler::header = {};
+sessionIndexEntry_t SessionHandler::entries[SESSION_INDEX_PER_SECTOR];
+uint32_t SessionHandler::entryCount = 0;
+uint32_t SessionHandler::droppedEntries = 0;
+bool SessionHandler::bSectorFull = false;
+bool SessionHandler::bIndexDirty = false;
+bool SessionHandler::bHeaderDirty = false;
+uint32_t SessionHandler::flushTimer = 0;
+FsFile SessionHandler::file;
+bool SessionHandler::bOpen = false;
+
+static_assert(sizeof(sessionFileHeader_t) == SESSION_SECTOR_SIZE, "Session header must fill one sector");
+static_assert(SESSION_SECTOR_SIZE % sizeof(sessionIndexEntry_t) == 0, "Index entries must not cross sectors");
+static_assert(static_cast<uint8_t>(parameter::COUNT) <= SESSION_MAX_PARAMETERS, "Session header holds too few parameters");
+
+/*-----------------------------------------------------------------------------
+ Count the sessions on the card and the space they use
+-----------------------------------------------------------------------------*/
+sessionScan_t SessionHandler::ScanSessions(void) {
+	sessionScan_t scan = {0, 0, SESSION_MAX_NUMBER, 0, false};
+	File root = SD.open("/");
+
+	while (root) {
+		File entry = root.openNextFile();
+		uint32_t session = 0;
+
+		if (!entry) {
+			break;
+		}
+
+		if ( !entry.isDirectory() && ParseSessionNumber(entry.name(), session) ) {
+			// Only the session file counts towards the limit - every file counts towards the size
+			scan.count += !strcmp(&entry.name()[SESSION_NAME_DIGITS + 1], ".SES");
+			scan.bytes += entry.size();
+			scan.oldest = (session < scan.oldest) ? session : scan.oldest;
+			scan.newest = (session > scan.newest) ? session : scan.newest;
+			scan.bFound = true;
+		}
+
+		entry.close();
+	}
+
+	root.close();
+
+	return scan;
+}
+
+/*-----------------------------------------------------------------------------
+ Delete every file of a session - Returns false if nothing could be removed
+-----------------------------------------------------------------------------*/
+bool SessionHandler::RemoveSession(uint32_t session) {
+	char name[LOGGER_NAME_SIZE];
+	bool bRemoved = true;
+	bool bAny = false;
+
+	DebugPrint("REMOVING SESSION: "); DebugPrintln(session);
+
+	// Directory entries are not removed while the directory is open
+	while (bRemoved) {
+		File root = SD.open("/");
+		uint32_t number = 0;
+
+		bRemoved = false;
+		name[0] = '\0';
+
+		while (root) {
+			File entry = root.openNextFile();
+
+			if (!entry) {
+				break;
+			}
+
+			if ( !entry.isDirectory() && ParseSessionNumber(entry.name(), number) && number == session ) {
+				strncpy(name, entry.name(), sizeof(name) - 1);
+				name[sizeof(name) - 1] = '\0';
+				entry.close();
+				break;
+			}
+
+			entry.close();
+		}
+
+		root.close();
+
+		if (name[0] != '\0') {
+			bRemoved = SD.remove(name);
+			bAny |= bRemoved;
+		}
+
+		// Freeing a large cluster chain can take a while
+		IRQHandler::FeedWDT();
+	}
+
+	return bAny;
+}
+
+/*-----------------------------------------------------------------------------
+ Copy the active parameter values into the header
+-----------------------------------------------------------------------------*/
+void SessionHandler::RecordParameters(void) {
+	header.parameterRevision = ParameterHandler::GetRevision();
+	header.parameterCount = static_cast<uint8_t>(parameter::COUNT);
+
+	for (uint8_t index = 0; index < header.parameterCount; ++index) {
+		header.parameters[index] = ParameterHandler::GetUInt( static_cast<parameter>(index) );
+	}
+
+	bHeaderDirty = true;
+}
+
+/*-----------------------------------------------------------------------------
+ Remove old sessions past the limits and start a new one (call after SetupSD) - Returns true on success
+-----------------------------------------------------------------------------*/
+bool SessionHandler::BeginSession(void) {
+	// Room for this session if every stream reaches its file limit
+	constexpr uint64_t reserve = static_cast<uint64_t>(SESSION_MAX_FILES) * (TRACE_FILE_SIZE + DATALOG_FILE_SIZE);
+	static_assert(reserve < SESSION_MAX_BYTES, "One session exceeds the space for all sessions");
+
+	char name[LOGGER_NAME_SIZE];
+	sessionScan_t scan = ScanSessions();
+
+	while ( scan.bFound && (scan.count >= SESSION_MAX_COUNT || scan.bytes + reserve > SESSION_MAX_BYTES) ) {
+		// A card that refuses deletes keeps its sessions
+		if ( !RemoveSession(scan.oldest) ) {
+			break;
+		}
+
+		scan = ScanSessions();
+	}
+
+	memcpy(header.magic, SESSION_MAGIC, sizeof(SESSION_MAGIC));
+	header.version = SESSION_VERSION;
+	header.bufferSectors = LOGGER_BUFFER_SECTORS;
+	header.session = (scan.bFound && scan.newest < SESSION_MAX_NUMBER) ? scan.newest + 1 : 1;
+	header.buffersPerFile = (DATALOG_FILE_SIZE - LOGGER_SECTOR_SIZE) / LOGGER_BUFFER_SIZE;
+	header.startTime = millis();
+	header.startEpoch = TimebaseHandler::GetTime();
+	strncpy(header.build, SESSION_BUILD, SESSION_BUILD_SIZE - 1);
+#ifdef EV1_5
+	strncpy(header.vehicle, "EV1_5", SESSION_VEHICLE_SIZE - 1);
+#else
+	strncpy(header.vehicle, "EV1", SESSION_VEHICLE_SIZE - 1);
+#endif
+	RecordParameters();
+
+	memset(entries, SESSION_INDEX_UNUSED, sizeof(entries));
+
+	snprintf(name, sizeof(name), SESSION_FILE_NAME, static_cast<unsigned>(header.session));
+	file = SD.sdfs.open(name, O_RDWR | O_CREAT | O_TRUNC);
+
+	if ( !file || !WriteSector(0, &header) ) {
+		DebugPrint("ERROR: OPENING "); DebugPrintln(name);
+		file.close();
+
+		return false;
+	}
+
+	bOpen = true;
+	bHeaderDirty = false;
+	flushTimer = millis();
+
+	DebugPrint("SESSION: "); DebugPrintln(name);
+
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Store the pedal bounds in use (call once they are loaded)
+-----------------------------------------------------------------------------*/
+void SessionHandler::RecordCalibration(systemData & system) {
+	hall * sensors[NUM_SENSORS] = {&system.GetAPPS1(), &system.GetAPPS2(), &system.GetBSE()};
+
+	for (uint8_t index = 0; index < NUM_SENSORS; ++index) {
+		header.pedalBounds[2 * index] = sensors[index]->GetPercentRequestLowerBound();
+		header.pedalBounds[2 * index + 1] = sensors[index]->GetPercentRequestUpperBound();
+	}
+
+	bHeaderDirty = true;
+}
+
+/*-----------------------------------------------------------------------------
+ Add a channel log buffer to the index (main loop only)
+-----------------------------------------------------------------------------*/
+void SessionHandler::AddIndexEntry(const sessionIndexEntry_t & entry) {
+	// The full sector has not reached the card yet
+	if (!bOpen || bSectorFull) {
+		++droppedEntries;
+		return;
+	}
+
+	entries[entryCount % SESSION_INDEX_PER_SECTOR] = entry;
+	++entryCount;
+
+	bSectorFull = (entryCount % SESSION_INDEX_PER_SECTOR == 0);
+	bIndexDirty = true;
+}
+
+/*-----------------------------------------------------------------------------
+ Write one sector of the session file at a time - header changes, full and partial index sectors
+ - Returns true if the card was written
+-----------------------------------------------------------------------------*/
+bool SessionHandler::ServiceSession(void) {
+	if ( !bOpen || file.isBusy() ) {
+		return false;
+	}
+
+	// Parameters committed over CAN since the header was written
+	if ( header.parameterRevision != ParameterHandler::GetRevision() ) {
+		RecordParameters();
+	}
+
+	if (bHeaderDirty) {
+		bHeaderDirty = !WriteSector(0, &header);
+		return true;
+	}
+
+	if (bSectorFull) {
+		// Sector 0 is the header - index sector n holds entries from (n - 1) * SESSION_INDEX_PER_SECTOR
+		if ( WriteSector(1 + (entryCount - 1) / SESSION_INDEX_PER_SECTOR, entries) ) {
+			memset(entries, SESSION_INDEX_UNUSED, sizeof(entries));
+			bSectorFull = false;
+			bIndexDirty = false;
+		}
+
+		return true;
+	}
+
+	if ( bIndexDirty && millis() - flushTimer >= SESSION_INDEX_INTERVAL ) {
+		// Unused entries stay SESSION_INDEX_UNUSED until the sector is written again
+		bIndexDirty = !WriteSector(1 + entryCount / SESSION_INDEX_PER_SECTOR, entries);
+		flushTimer = millis();
+		return true;
+	}
+
+	return false;
+}
+
+/*-----------------------------------------------------------------------------
+ Write and commit one sector of the session file - Returns true on success
+-----------------------------------------------------------------------------*/
+bool SessionHandler::WriteSector(uint32_t sector, const void * pData) {
+	if ( !file.seekSet(static_cast<uint64_t>(sector) * SESSION_SECTOR_SIZE) ||
+		file.write(pData, SESSION_SECTOR_SIZE) != SESSION_SECTOR_SIZE ) {
+		DebugPrintln("ERROR: WRITING SESSION");
+		return false;
+	}
+
+	return file.sync();
+}
@@ -0,0 +1,387 @@
+#include "daq/storage.h"
+#include "daq/trace.h"
+#include "daq/datalog.h"
+#include "daq/session.h"
+
+// Initialize variables
+storageQueue_t StorageHandler::queue = {};
+storageStep StorageHandler::step = storageStep::REMOVE;
+File StorageHandler::file;
+uint8_t StorageHandler::transferStatus = STORAGE_STATUS_OK;
+uint8_t StorageHandler::nextStream = 0;
+uint32_t StorageHandler::busyCount = 0;
+uint32_t StorageHandler::peakTime = 0;
+
+/*-----------------------------------------------------------------------------
+ Check for queued writes to a file - Returns true if the file is not up to date
+-----------------------------------------------------------------------------*/
+bool StorageHandler::GetPending(const char * pFileName) {
+	for (uint32_t index = queue.tail; index != queue.head; ++index) {
+		if ( !strcmp(queue.jobs[index % STORAGE_QUEUE_SIZE].fileName, pFileName) ) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*-----------------------------------------------------------------------------
+ Queue a line for a file without touching the card - Returns false if the queue is full
+-----------------------------------------------------------------------------*/
+bool StorageHandler::QueueWrite(const char * pFileName, const char * pString, bool bOverwrite) {
+	uint32_t head = queue.head;
+
+	// Backpressure - the caller keeps the data or gives it up
+	if ( head - queue.tail >= STORAGE_QUEUE_SIZE || strlen(pFileName) >= STORAGE_NAME_SIZE ) {
+		++queue.rejected;
+		DebugPrint("ERROR: SD QUEUE FULL "); DebugPrintln(pFileName);
+
+		return false;
+	}
+
+	storageJob_t & job = queue.jobs[head % STORAGE_QUEUE_SIZE];
+
+	strncpy(job.fileName, pFileName, STORAGE_NAME_SIZE);
+	strncpy(job.data, pString, STORAGE_DATA_SIZE - 1);
+	job.data[STORAGE_DATA_SIZE - 1] = '\0';
+	job.bOverwrite = bOverwrite;
+	job.operation = storageOperation::APPEND;
+	job.pTransfer = nullptr;
+
+	queue.head = head + 1;
+	queue.highWater = (queue.head - queue.tail > queue.highWater) ? queue.head - queue.tail : queue.highWater;
+
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Queue a read or write of a caller buffer - Returns false if the queue is full
+-----------------------------------------------------------------------------*/
+bool StorageHandler::QueueTransfer(const char * pFileName, storageOperation operation, storageTransfer_t & transfer) {
+	uint32_t head = queue.head;
+
+	// No error count - the caller holds its request and asks again next loop
+	if ( head - queue.tail >= STORAGE_QUEUE_SIZE || strlen(pFileName) >= STORAGE_NAME_SIZE ) {
+		return false;
+	}
+
+	storageJob_t & job = queue.jobs[head % STORAGE_QUEUE_SIZE];
+
+	strncpy(job.fileName, pFileName, STORAGE_NAME_SIZE);
+	job.data[0] = '\0';
+	job.bOverwrite = false;
+	job.operation = operation;
+	job.pTransfer = &transfer;
+
+	transfer.moved = 0;
+	transfer.size = 0;
+	transfer.crc = 0;
+	transfer.status = STORAGE_STATUS_PENDING;
+
+	queue.head = head + 1;
+	queue.highWater = (queue.head - queue.tail > queue.highWater) ? queue.head - queue.tail : queue.highWater;
+
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Move one block of a queued read or write - Returns true when it has finished
+-----------------------------------------------------------------------------*/
+bool StorageHandler::RunTransfer(storageJob_t & job) {
+	storageTransfer_t & transfer = *job.pTransfer;
+
+	// First block - check the range and position the file
+	if (transfer.moved == 0) {
+		uint32_t size = file.size();
+
+		if (job.operation == storageOperation::READ) {
+			// Reading at or past the end returns no data
+			transfer.length = (transfer.offset >= size) ? 0 :
+				(size - transfer.offset < transfer.length) ? size - transfer.offset : transfer.length;
+		}
+		// Holes are not allowed - writers go in order
+		else if (transfer.offset > size) {
+			transferStatus = STORAGE_STATUS_BAD_RANGE;
+			return true;
+		}
+		else if ( transfer.bTruncate && !file.truncate(transfer.offset) ) {
+			transferStatus = STORAGE_STATUS_IO_ERROR;
+			return true;
+		}
+
+		if ( !file.seek(transfer.offset) ) {
+			transferStatus = STORAGE_STATUS_IO_ERROR;
+			return true;
+		}
+	}
+
+	uint16_t count = transfer.length - transfer.moved;
+
+	count = (count > STORAGE_TRANSFER_BLOCK) ? STORAGE_TRANSFER_BLOCK : count;
+
+	if (count) {
+		uint8_t * pData = &transfer.pData[transfer.moved];
+		int done = 0;
+
+		if (job.operation == storageOperation::READ) {
+			done = file.read(pData, count);
+		}
+		else {
+			done = file.write(pData, count);
+		}
+
+		if (done != count) {
+			transferStatus = STORAGE_STATUS_IO_ERROR;
+			return true;
+		}
+
+		transfer.moved += count;
+	}
+
+	return transfer.moved >= transfer.length;
+}
+
+/*-----------------------------------------------------------------------------
+ Fold one block of a file into its CRC - Returns true when it has finished
+-----------------------------------------------------------------------------*/
+bool StorageHandler::RunCRC(storageJob_t & job) {
+	uint8_t block[STORAGE_TRANSFER_BLOCK];
+	int count = file.read(block, sizeof(block));
+
+	if (count < 0) {
+		transferStatus = STORAGE_STATUS_IO_ERROR;
+		return true;
+	}
+
+	job.pTransfer->crc = UpdateCRC32(job.pTransfer->crc, block, count);
+
+	return count < static_cast<int>( sizeof(block) );
+}
+
+/*-----------------------------------------------------------------------------
+ Visit one directory entry and list it once past the start index - Returns true when finished
+-----------------------------------------------------------------------------*/
+bool StorageHandler::RunList(storageJob_t & job) {
+	storageTransfer_t & transfer = *job.pTransfer;
+	File entry = file.openNextFile();
+	bool bEnd = !entry;
+
+	if ( entry && !entry.isDirectory() ) {
+		const char * pName = entry.name();
+		size_t nameLength = strlen(pName);
+		uint32_t fileSize = entry.size();
+
+		nameLength = (nameLength > STORAGE_LIST_NAME) ? STORAGE_LIST_NAME : nameLength;
+
+		// Files before the start index are only counted
+		if (transfer.size < transfer.offset) {
+			++transfer.size;
+		}
+		// Buffer full - the caller asks again from the next index
+		else if (transfer.moved + STORAGE_LIST_ENTRY + nameLength > transfer.length) {
+			bEnd = true;
+		}
+		else {
+			uint8_t * pEntry = &transfer.pData[transfer.moved];
+
+			// Little-endian size, then the name length and name
+			pEntry[0] = fileSize & 0xFF;
+			pEntry[1] = (fileSize >> 8) & 0xFF;
+			pEntry[2] = (fileSize >> 16) & 0xFF;
+			pEntry[3] = fileSize >> 24;
+			pEntry[4] = nameLength;
+			memcpy(&pEntry[STORAGE_LIST_ENTRY], pName, nameLength);
+
+			transfer.moved += STORAGE_LIST_ENTRY + nameLength;
+			++transfer.size;
+		}
+	}
+
+	entry.close();
+
+	return bEnd;
+}
+
+/*-----------------------------------------------------------------------------
+ Open the file of a job in the mode its operation needs - Returns true on success
+-----------------------------------------------------------------------------*/
+bool StorageHandler::OpenFile(storageJob_t & job) {
+	switch (job.operation) {
+		case (storageOperation::READ):
+		case (storageOperation::CRC):
+		case (storageOperation::LIST):
+			file = SD.open(job.fileName, FILE_READ);
+			return static_cast<bool>(file);
+
+		case (storageOperation::WRITE):
+			file = SD.open(job.fileName, FILE_WRITE_BEGIN);
+			return static_cast<bool>(file);
+
+		// Never reuses a name - the stream moves on to the next one
+		case (storageOperation::ALLOCATE):
+			*job.pTransfer->pFile = SD.sdfs.open(job.fileName, O_WRONLY | O_CREAT | O_EXCL);
+			return static_cast<bool>(*job.pTransfer->pFile);
+
+		default:
+			file = SD.open(job.fileName, FILE_WRITE);
+			return static_cast<bool>(file);
+	}
+}
+
+/*-----------------------------------------------------------------------------
+ Run the next SD operation of the job at the tail of the queue
+-----------------------------------------------------------------------------*/
+void StorageHandler::RunStep(storageJob_t & job) {
+	bool bFinished = false;
+
+	switch (step) {
+		// Delete old data to overwrite file
+		case (storageStep::REMOVE):
+			if ( job.bOverwrite && SD.exists(job.fileName) ) {
+				SD.remove(job.fileName);
+				DebugPrint("OLD FILE DELETED: "); DebugPrintln(job.fileName);
+			}
+
+			step = storageStep::OPEN;
+			break;
+
+		case (storageStep::OPEN):
+			if ( !OpenFile(job) ) {
+				DebugPrint("ERROR: OPENING "); DebugPrintln(job.fileName);
+
+				if (job.pTransfer) {
+					job.pTransfer->status = (job.operation == storageOperation::READ || job.operation == storageOperation::CRC) ?
+						STORAGE_STATUS_NOT_FOUND : STORAGE_STATUS_IO_ERROR;
+				}
+
+				// Drop the job so one bad file can't block the queue
+				++queue.tail;
+				step = storageStep::REMOVE;
+				break;
+			}
+
+			transferStatus = STORAGE_STATUS_OK;
+			step = (job.operation == storageOperation::APPEND) ? storageStep::WRITE :
+				(job.operation == storageOperation::ALLOCATE) ? storageStep::ALLOCATE : storageStep::TRANSFER;
+			break;
+
+		case (storageStep::WRITE):
+			file.println(job.data);
+			step = storageStep::CLOSE;
+			break;
+
+		case (storageStep::TRANSFER):
+			bFinished = (job.operation == storageOperation::CRC) ? RunCRC(job) :
+				(job.operation == storageOperation::LIST) ? RunList(job) : RunTransfer(job);
+
+			step = bFinished ? storageStep::CLOSE : storageStep::TRANSFER;
+			break;
+
+		// Contiguous clusters keep the stream's sector runs free of FAT updates
+		case (storageStep::ALLOCATE):
+			if ( !job.pTransfer->pFile->preAllocate(job.pTransfer->reserve) ) {
+				DebugPrint("ERROR: ALLOCATING "); DebugPrintln(job.fileName);
+				transferStatus = STORAGE_STATUS_IO_ERROR;
+			}
+
+			step = storageStep::CLOSE;
+			break;
+
+		case (storageStep::CLOSE):
+			// The stream keeps a new file open - a failed one is left for the next name
+			if (job.operation == storageOperation::ALLOCATE) {
+				if (transferStatus != STORAGE_STATUS_OK) {
+					job.pTransfer->pFile->close();
+				}
+
+				job.pTransfer->status = transferStatus;
+			}
+			// Hand the buffer back only once the file is closed (and written through)
+			else if (job.pTransfer) {
+				// A listing counts files in the size instead
+				if (job.operation != storageOperation::LIST) {
+					job.pTransfer->size = file.size();
+				}
+
+				file.close();
+				job.pTransfer->status = transferStatus;
+			}
+			else {
+				file.close();
+				DebugPrint("DATA WRITTEN TO: "); DebugPrintln(job.fileName);
+			}
+
+			++queue.tail;
+			step = storageStep::REMOVE;
+			break;
+
+		default:
+			step = storageStep::REMOVE;
+			break;
+	}
+}
+
+/*-----------------------------------------------------------------------------
+ Give one stream a card operation, taking turns - Returns true if one was run
+-----------------------------------------------------------------------------*/
+bool StorageHandler::ServiceStreams(void) {
+	static bool (* const services[])(void) = {
+		TraceHandler::ServiceTrace, DatalogHandler::ServiceDatalog, SessionHandler::ServiceSession
+	};
+	constexpr uint8_t count = sizeof(services) / sizeof(services[0]);
+
+	for (uint8_t offset = 0; offset < count; ++offset) {
+		uint8_t index = (nextStream + offset) % count;
+
+		if ( services[index]() ) {
+			nextStream = (index + 1) % count;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*-----------------------------------------------------------------------------
+ Write one stream block and then queued jobs until the loop's SD budget is spent
+-----------------------------------------------------------------------------*/
+void StorageHandler::ServiceStorage(void) {
+	uint32_t start = micros();
+	bool bStreamed = false;
+
+	while ( micros() - start < STORAGE_BUDGET_US ) {
+		// A card still programming or erasing would block the next operation
+		if ( SD.sdfs.card()->isBusy() ) {
+			++busyCount;
+			break;
+		}
+
+		// Streams first - they drop records once their buffers fill
+		if (!bStreamed) {
+			bStreamed = true;
+
+			if ( ServiceStreams() ) {
+				continue;
+			}
+		}
+
+		if (queue.tail == queue.head) {
+			break;
+		}
+
+		RunStep( queue.jobs[queue.tail % STORAGE_QUEUE_SIZE] );
+	}
+
+	peakTime = (micros() - start > peakTime) ? micros() - start : peakTime;
+}
+
+/*-----------------------------------------------------------------------------
+ Output the SD queue and budget counters
+-----------------------------------------------------------------------------*/
+void StorageHandler::PrintStorage(void) {
+	DebugPrint("  SD QUEUED: "); DebugPrint( GetQueued() );
+	DebugPrint(" MAX: "); DebugPrint(queue.highWater);
+	DebugPrint(" REJECTED: "); DebugPrint(queue.rejected);
+	DebugPrint(" BUSY: "); DebugPrint(busyCount);
+	DebugPrint(" PEAK (US): "); DebugPrintln(peakTime);
+}
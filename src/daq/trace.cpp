@@ -0,0 +1,60 @@
+#include "daq/trace.h"
+
+// Initialize variables
+streamLogger TraceHandler::logger(TRACE_FILE_NAME, TRACE_FILE_SIZE, TraceHandler::WriteHeader);
+uint16_t TraceHandler::sequences[2] = {0, 0};
+
+/*-----------------------------------------------------------------------------
+ Fill the first sector of a new trace file
+-----------------------------------------------------------------------------*/
+void TraceHandler::WriteHeader(uint8_t * pSector) {
+	traceFileHeader_t header = {};
+
+	static_assert(sizeof(header) == LOGGER_SECTOR_SIZE, "Trace header must fill one sector");
+	static_assert(LOGGER_BUFFER_SIZE % TRACE_RECORD_SIZE == 0, "Trace records must not straddle buffers");
+
+	memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+	header.version = TRACE_VERSION;
+	header.recordSize = TRACE_RECORD_SIZE;
+	header.startTime = millis();
+	header.startEpoch = TimebaseHandler::GetTime();
+
+	memcpy(pSector, &header, sizeof(header));
+}
+
+/*-----------------------------------------------------------------------------
+ Start recording CAN frames (call after BeginSession)
+-----------------------------------------------------------------------------*/
+bool TraceHandler::BeginTrace(void) {
+	if ( !logger.Begin(SessionHandler::GetSession(), SESSION_MAX_FILES) ) {
+		return false;
+	}
+
+	DebugPrint("CAN TRACE: "); DebugPrintln( logger.GetFileName() );
+
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Queue a frame for the trace (RX and TX confirmations from the CAN ISRs)
+-----------------------------------------------------------------------------*/
+void TraceHandler::RecordFrame(const CAN_message_t & message, uint32_t timestamp, bool bTransmit) {
+	traceRecord_t record;
+	uint8_t len = (message.len > 8) ? 8 : message.len;
+
+	record.timestamp = timestamp;
+	record.header = (message.id & TRACE_ID_MASK) | (bTransmit << TRACE_TX_BIT) | (len << TRACE_LEN_SHIFT);
+
+	// Sequence advances even if the record is dropped so the replay sees the gap
+	record.sequence = sequences[bTransmit]++;
+	memcpy(record.buf, message.buf, 8);
+
+	logger.Write(&record, sizeof(record));
+}
+
+/*-----------------------------------------------------------------------------
+ Move the next buffer to the SD card (called by StorageHandler) - Returns true if the card was used
+-----------------------------------------------------------------------------*/
+bool TraceHandler::ServiceTrace(void) {
+	return logger.Service();
+}
@@ -3,7 +3,6 @@
 // Initialize variables
 volatile bool IRQHandler::bShutdownCircuitOpen = false;
 volatile bool IRQHandler::bButtonHeld = false;
-volatile uint8_t IRQHandler::motorTemperature = 0;
 volatile uint8_t IRQHandler::errorBuf = 0;
 volatile uint32_t IRQHandler::lastPressTime = 0;
 WDT_T4<WDT1> IRQHandler::WDT;
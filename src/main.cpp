@@ -12,6 +12,9 @@ systemVehicle vehicle;
  Setup
 -------------------------------------------------------------------------------------------------*/
 void setup() {
+    // Start the 64 bit ECU time used by CAN frames, samples and logs
+    TimebaseHandler::BeginTimebase();
+
     // Connect serial comms for debugging
     DebugBegin(SERIAL_RATE);
     DebugPrintln("SERIAL COMMS INITIALIZED");
@@ -19,9 +22,22 @@ void setup() {
     // Setup WDT for potential software hangs
     IRQHandler::ConfigureWDT();
 
+    // Load the pedal calibration, thresholds and gains from EEPROM (one read)
+    ConfigHandler::LoadConfig();
+    ParameterHandler::LoadParameters();
+
     // Setup the SD card for DAQ
     SetupSD();
 
+    // Start a new log session (oldest sessions past the count and size limits are removed)
+    SessionHandler::BeginSession();
+
+    // Record every CAN frame to the SD card
+    TraceHandler::BeginTrace();
+
+    // Log pedal, torque, state and Bamocar channels to the SD card
+    DatalogHandler::BeginDatalog();
+
     // SKIPPING DURING TEST BENCHING
 	// Initialize CAN communications
     ConfigureCANBus();
@@ -38,21 +54,57 @@ void setup() {
  Main Loop
 -------------------------------------------------------------------------------------------------*/
 void loop() {
+#ifdef LEGACY_DASHBOARD
     // Get status buffers sent to the dashboard
     uint8_t stateBuf = vehicle.GetSystemData().GetStateBuffer();
     uint8_t faultBuf = vehicle.GetSystemData().GetFaultBuffer();
+#endif
 
     // Feed the WDT
     IRQHandler::FeedWDT();
 
+    // Keep the 64 bit ECU time ahead of the micros() wrap
+    TimebaseHandler::ServiceTimebase();
+
+    // Received frames the CAN ISRs deferred under heavy bus load
+    AdmissionHandler::ServiceDeferred();
+
     /*-----------------------------------------------------------------------------
      FSM Current State Processing
     -----------------------------------------------------------------------------*/
     vehicle.ProcessState();
 
+    // Sample the channels of this loop into the data log
+    DatalogHandler::SampleChannels( vehicle.GetSystemData() );
+
 	/*-----------------------------------------------------------------------------
      Telemetry & Status CAN Messages
     -----------------------------------------------------------------------------*/
 	// SKIPPING DURING TEST BENCHING
+#ifdef LEGACY_DASHBOARD
     SendCANStatusMessages(&faultBuf, &stateBuf);
+#else
+    DashboardHandler::SendDashboardMessages();
+#endif
+
+    // Bridge Bamocar responses onto the telemetry bus
+    RoutingHandler::ServiceForwarding();
+
+    // Keep Bamocar cyclic responses alive (re-subscribe on timeout)
+    SubscriptionHandler::ServiceSubscriptions();
+
+    // CAN error counters, bus load and diagnostic frame
+    StatisticsHandler::ServiceStatistics();
+
+    // Restart a bus off controller and restore the Bamocar subscriptions
+    RecoveryHandler::ServiceRecovery();
+
+    // Write trace buffers and queued files within the SD time budget
+    StorageHandler::ServiceStorage();
+
+    // Parameter reads, writes and measurements from the host
+    ParameterHandler::ServiceParameters();
+
+    // Host file requests over ISO-TP (lowest priority work in the loop)
+    FileServiceHandler::ServiceFiles();
 }	
@@ -57,14 +57,14 @@ void circularBuffer::PushBuffer(uint16_t value) {
         // Add new value to total sum
         total += *pHead;
 
+        // Advance the head to the next element
+        ++pHead;
+
         // Wrap around when reaching the end of buffer
         if (pHead == pBuffer + capacity) {
             pHead = pBuffer;
         }
 
-        // Advance the head to the next element
-        ++pHead;
-
         // Update current element counter and tail
         if (count == capacity) {
             // Advance the tail to the next element
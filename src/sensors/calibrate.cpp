@@ -11,7 +11,7 @@ void systemData::CalibratePedals() {
 	pedalCalibrate state = pedalCalibrate::UPDATE_PEDALS;
 	uint8_t buttonCounter = 0;
 	bool bDone = false;
-	char strPedalData[50] = "";
+	configPedals_t pedals = {};
 
 	// Turn off brake light
 	pinBrakeLight.WriteOutput(LOW);
@@ -49,8 +49,6 @@ void systemData::CalibratePedals() {
 			 Set the Upper Bounds for Pedal Percent Requests
 			-----------------------------------------------------------------------------*/
 			case (pedalCalibrate::PERCENT_REQ_UPPER): {
-				char strUpperBounds[25] = "";
-
 				// Set upper bounds
 				boundAPPS1 = APPS1.GetCookedOutput();
 				boundAPPS2 = APPS2.GetCookedOutput();
@@ -61,9 +59,10 @@ void systemData::CalibratePedals() {
 				APPS2.SetPercentRequestUpperBound(boundAPPS2);
 				BSE.SetPercentRequestUpperBound(boundBSE);
 
-				// Add pedal bound values to the string
-				snprintf(strUpperBounds, 25, "%d,%d,%d,", boundAPPS1, boundAPPS2, boundBSE);
-				strncat(strPedalData, strUpperBounds, 50 - strlen(strPedalData) - 1);
+				// Keep the bounds for the config store
+				pedals.upper[0] = boundAPPS1;
+				pedals.upper[1] = boundAPPS2;
+				pedals.upper[2] = boundBSE;
 
 				state = pedalCalibrate::UPDATE_PEDALS;
 
@@ -76,8 +75,6 @@ void systemData::CalibratePedals() {
 			 Set the Lower Bounds for Pedal Percent Requests
 			-----------------------------------------------------------------------------*/
 			case (pedalCalibrate::PERCENT_REQ_LOWER): {
-				char strLowerBounds[25] = "";
-
 				// Set upper bounds
 				boundAPPS1 = APPS1.GetCookedOutput();
 				boundAPPS2 = APPS2.GetCookedOutput();
@@ -88,9 +85,10 @@ void systemData::CalibratePedals() {
 				APPS2.SetPercentRequestLowerBound(boundAPPS2);
 				BSE.SetPercentRequestLowerBound(boundBSE);
 
-				// Add pedal bound values to the string
-				snprintf(strLowerBounds, 25, "%d,%d,%d", boundAPPS1, boundAPPS2, boundBSE);
-				strncat(strPedalData, strLowerBounds, 50 - strlen(strPedalData) - 1);
+				// Keep the bounds for the config store
+				pedals.lower[0] = boundAPPS1;
+				pedals.lower[1] = boundAPPS2;
+				pedals.lower[2] = boundBSE;
 
 				state = pedalCalibrate::DONE;
 
@@ -101,8 +99,12 @@ void systemData::CalibratePedals() {
 			 Output the bounds before ending calibration
 			-----------------------------------------------------------------------------*/
 			case (pedalCalibrate::DONE): {
-				// Update SD file with new data
-				WriteDataToFile(FILE_PEDAL_BOUNDS, strPedalData, OVERWRITE);
+				// Store the bounds in EEPROM (config.csv is queued for the SD card)
+				ConfigHandler::SetPedalBounds(pedals);
+
+				if ( !ConfigHandler::SaveConfig() ) {
+					DebugErrorPrint("ERROR: CONFIG NOT SAVED");
+				}
 
 				// Calibration complete
 				bDone = true;
@@ -0,0 +1,856 @@
+/*-------------------------------------------------------------------------------------------------
+ Host Log Analysis
+ Summarises the control path and fault history of the sessions recorded by the ECU, e.g. a whole
+ event weekend of SD cards. Channel logs are split into chunks of buffers and every CAN trace is a
+ task of its own on a work stealing pool, so one long session spreads over every core as well as
+ many short ones. The last task of a session stitches its chunks back together in file order.
+
+ Reports for each session and in total:
+   Pedal to torque frame latency - from the last channel log sample before the torque command
+       changed to the new command's frame on the bus (CAN trace), so it includes up to one sample
+       period of sampling resolution
+   Time in each systemState (gaps from dropped buffers are counted as unlogged)
+   Faults by ERROR_CODE_* - times set, total and longest time set
+   APPS disagreement - difference in percent of pedal travel from the raw readings and the pedal
+       bounds in the session header, and the time spent over the agreement parameter
+
+ Build: pio run -e analyze
+ Usage: .pio/build/analyze/program [-j threads] [-v] [-b us] card_dir|S00001.SES ...
+   -j  Worker threads (default one per hardware thread)
+   -v  Print the full report of every session, not only the total
+   -b  Exit with 1 if the p99 latency of any session is over this many us (regression check)
+-------------------------------------------------------------------------------------------------*/
+#include <dirent.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include <algorithm>
+
+#include "logfile.h"
+#include "workpool.h"
+
+/*------------------------------------------
+ Macros - Analysis
+------------------------------------------*/
+#define ANALYZE_CHUNK_BUFFERS    1024    // Channel log buffers per task (8 MB)
+#define ANALYZE_GAP_PERIODS      10      // Longer gaps between samples are unlogged time
+#define ANALYZE_MATCH_WINDOW     100000  // Longest wait for a torque change's frame (us)
+#define ANALYZE_LATENCY_BINS     17      // Bin n holds [2^n, 2^(n+1)) us (LATENCY_NUM_BINS)
+#define ANALYZE_DISAGREE_BINS    101     // 1 % bins, the last holds 100 % and over
+#define ANALYZE_NUM_STATES       9
+#define ANALYZE_NUM_FAULTS       5
+
+/*------------------------------------------
+ Macros - Firmware Values (their headers need the Teensy core)
+------------------------------------------*/
+#define ANALYZE_TORQUE_ID        0x201   // ID_CAN_MESSAGE_RX - Bamocar write
+#define ANALYZE_TORQUE_REG       0x90    // REG_DIG_TORQUE_SET
+#define ANALYZE_TORQUE_DLC       3       // PAR_RX_DLC
+#define ANALYZE_ADC_RESOLUTION   1023    // ADC_RESOLUTION
+#define ANALYZE_COOKED_SCALE     65535   // TWO_BYTES - scale of the pedal bounds (hall::AverageSignal)
+#define ANALYZE_AGREEMENT_INDEX  3       // parameter::AGREEMENT_PERCENT
+#define ANALYZE_AGREEMENT        10      // APPS_AGREEMENT (sessions without parameters)
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+// Constant value of a channel from start until the next run (or the last sample)
+typedef struct analysisRun {
+    uint64_t start;
+    uint64_t end;
+    int32_t value;
+} analysisRun_t;
+
+// Torque command change in a channel log
+typedef struct torqueChange {
+    uint64_t before;      // Last sample with the previous command
+    uint64_t after;       // First sample with the new command
+    int32_t torque;
+} torqueChange_t;
+
+// Torque command frame in a CAN trace
+typedef struct torqueFrame {
+    uint64_t time;
+    int32_t torque;
+} torqueFrame_t;
+
+typedef struct disagreeStats {
+    uint64_t samples;
+    double total;         // % (mean = total / samples)
+    double maximum;       // %
+    uint64_t bins[ANALYZE_DISAGREE_BINS];
+} disagreeStats_t;
+
+// Channels the analysis reads (-1 if the log does not have it)
+typedef struct analysisColumns {
+    int32_t apps1;
+    int32_t apps2;
+    int32_t torque;
+    int32_t state;
+    int32_t faults;
+} analysisColumns_t;
+
+/*-------------------------------------------------------------------------------------------------
+ Run list - a channel compressed to its changes, with gaps over a limit left open
+-------------------------------------------------------------------------------------------------*/
+class runList {
+    public:
+        // Getters
+        const std::vector<analysisRun_t> & GetRuns(void) const { return runs; }
+
+        // Data methods
+        void Add(uint64_t time, int32_t value, uint64_t gap);
+        void Append(const runList & next, uint64_t gap);
+
+    private:
+        std::vector<analysisRun_t> runs;
+};
+
+/*-----------------------------------------------------------------------------
+ Add a sample - the previous run lasts until it unless the gap is too long
+-----------------------------------------------------------------------------*/
+void runList::Add(uint64_t time, int32_t value, uint64_t gap) {
+    if ( !runs.empty() && time - runs.back().end <= gap ) {
+        runs.back().end = time;
+
+        if (runs.back().value == value) {
+            return;
+        }
+    }
+
+    runs.push_back( {time, time, value} );
+}
+
+/*-----------------------------------------------------------------------------
+ Continue with the runs of the following chunk
+-----------------------------------------------------------------------------*/
+void runList::Append(const runList & next, uint64_t gap) {
+    size_t first = 0;
+
+    if ( next.runs.empty() ) {
+        return;
+    }
+
+    if ( !runs.empty() && next.runs[0].start - runs.back().end <= gap ) {
+        runs.back().end = next.runs[0].start;
+
+        // Same value on both sides of the boundary is one run
+        if (runs.back().value == next.runs[0].value) {
+            runs.back().end = next.runs[0].end;
+            first = 1;
+        }
+    }
+
+    runs.insert(runs.end(), next.runs.begin() + first, next.runs.end());
+}
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures - Tasks & Reports
+-------------------------------------------------------------------------------------------------*/
+// Buffers of one channel log decoded by one task
+typedef struct chunkResult {
+    std::string path;
+    uint64_t firstBuffer;
+    uint64_t numBuffers;
+
+    logCounts_t counts;
+    runList states;
+    runList faults;
+    runList over;                         // Disagreement over the agreement parameter (0 or 1)
+    disagreeStats_t disagree;
+    std::vector<torqueChange_t> changes;
+
+    // Edges for stitching to the neighbouring chunks
+    bool bSampled;
+    uint64_t firstTime;
+    uint64_t lastTime;
+    int32_t firstTorque;
+    int32_t lastTorque;
+} chunkResult_t;
+
+// One CAN trace file decoded by one task
+typedef struct traceResult {
+    logCounts_t counts;
+    std::vector<torqueFrame_t> frames;
+} traceResult_t;
+
+typedef struct analysisReport {
+    uint64_t sessions;
+    logCounts_t counts;
+    uint64_t logged;                      // us covered by samples
+    uint64_t unlogged;                    // us of gaps between samples
+
+    std::vector<uint32_t> latencies;      // us (sorted once complete)
+    uint64_t latencyBins[ANALYZE_LATENCY_BINS];
+    uint64_t unmatched;                   // Torque changes without a frame in the trace
+    bool bTraced;
+
+    uint64_t stateTimes[ANALYZE_NUM_STATES];
+    uint64_t stateEntries[ANALYZE_NUM_STATES];
+
+    uint64_t faultCounts[ANALYZE_NUM_FAULTS];
+    uint64_t faultTimes[ANALYZE_NUM_FAULTS];
+    uint64_t faultLongest[ANALYZE_NUM_FAULTS];
+
+    disagreeStats_t disagree;
+    uint64_t overCount;
+    uint64_t overTime;
+    uint64_t overLongest;
+    int32_t threshold;                    // % (-1 - mixed in a total)
+} analysisReport_t;
+
+typedef struct analysisSession {
+    logSession_t session;
+    analysisColumns_t columns;
+    uint64_t gap;                         // Longest gap between two samples still logged (us)
+    uint16_t bounds[4];                   // Lower, upper of APPS1 and APPS2 (0 - not calibrated)
+    int32_t threshold;
+
+    std::vector<chunkResult_t> chunks;
+    std::vector<traceResult_t> traces;
+    std::atomic<size_t> remaining;        // Tasks still running - the last one merges
+
+    analysisReport_t report;
+    bool bFailed;
+} analysisSession_t;
+
+// Names of the systemState and ERROR_CODE_* values
+static const char * stateNames[ANALYZE_NUM_STATES] = {
+    "PRECHARGE", "RTD", "IDLE", "DRIVE", "BRAKE", "FAULT", "INIT", "CALIBRATE", "PEDALS"
+};
+
+static const char * faultNames[ANALYZE_NUM_FAULTS] = {
+    "SHUTDOWN", "DISAGREE", "APPS_BSE", "OOR", "CAN_BUS"
+};
+
+/*-----------------------------------------------------------------------------
+ Column of a named channel - Returns -1 if the log does not have it
+-----------------------------------------------------------------------------*/
+static int32_t GetColumn(const channelFileHeader_t & header, const char * pName) {
+    for (uint16_t index = 0; index < header.numChannels; ++index) {
+        if ( !strncmp(header.names[index], pName, CHANNEL_NAME_SIZE) ) {
+            return index;
+        }
+    }
+
+    return -1;
+}
+
+/*-----------------------------------------------------------------------------
+ Pedal travel of a raw APPS reading in percent (hall::GetPercentRequest without the filter)
+-----------------------------------------------------------------------------*/
+static double GetPedalPercent(int32_t raw, uint16_t lower, uint16_t upper) {
+    int32_t cooked = (ANALYZE_COOKED_SCALE * raw) / ANALYZE_ADC_RESOLUTION;
+
+    return 100.0 * (cooked - lower) / (upper - lower);
+}
+
+/*-----------------------------------------------------------------------------
+ Add one difference to the disagreement statistics
+-----------------------------------------------------------------------------*/
+static void AddDisagree(disagreeStats_t & stats, double difference) {
+    size_t bin = (difference < ANALYZE_DISAGREE_BINS - 1) ? static_cast<size_t>(difference) : ANALYZE_DISAGREE_BINS - 1;
+
+    ++stats.bins[bin];
+    ++stats.samples;
+    stats.total += difference;
+    stats.maximum = (difference > stats.maximum) ? difference : stats.maximum;
+}
+
+/*-----------------------------------------------------------------------------
+ Merge disagreement statistics
+-----------------------------------------------------------------------------*/
+static void MergeDisagree(disagreeStats_t & stats, const disagreeStats_t & other) {
+    for (size_t bin = 0; bin < ANALYZE_DISAGREE_BINS; ++bin) {
+        stats.bins[bin] += other.bins[bin];
+    }
+
+    stats.samples += other.samples;
+    stats.total += other.total;
+    stats.maximum = (other.maximum > stats.maximum) ? other.maximum : stats.maximum;
+}
+
+/*-----------------------------------------------------------------------------
+ Merge decode counts
+-----------------------------------------------------------------------------*/
+static void MergeCounts(logCounts_t & counts, const logCounts_t & other) {
+    counts.samples += other.samples;
+    counts.skipped += other.skipped;
+    counts.corrupt += other.corrupt;
+    counts.bytes += other.bytes;
+    counts.files += other.files;
+    counts.frames += other.frames;
+    counts.dropped += other.dropped;
+}
+
+/*-----------------------------------------------------------------------------
+ Log2 latency bin (LatencyHandler::GetBin)
+-----------------------------------------------------------------------------*/
+static uint8_t GetLatencyBin(uint32_t latency) {
+    uint8_t bin = (latency > 1) ? 31 - __builtin_clz(latency) : 0;
+
+    return (bin < ANALYZE_LATENCY_BINS) ? bin : ANALYZE_LATENCY_BINS - 1;
+}
+
+/*-----------------------------------------------------------------------------
+ Decode a chunk of a channel log into its runs, torque changes and disagreement
+-----------------------------------------------------------------------------*/
+static void AnalyzeChunk(const analysisSession_t & analysis, chunkResult_t & chunk) {
+    const analysisColumns_t & columns = analysis.columns;
+    bool bCalibrated = analysis.bounds[0] != analysis.bounds[1] && analysis.bounds[2] != analysis.bounds[3];
+    uint64_t gap = analysis.gap;
+    mappedFile file;
+
+    chunk.bSampled = false;
+
+    logSampleHandler_t onSample = [&](uint64_t time, const int32_t * pValues) {
+        if (columns.state >= 0) {
+            chunk.states.Add(time, pValues[columns.state], gap);
+        }
+
+        if (columns.faults >= 0) {
+            chunk.faults.Add(time, pValues[columns.faults], gap);
+        }
+
+        // The command only changes when its frame is sent
+        if ( columns.torque >= 0 && chunk.bSampled && pValues[columns.torque] != chunk.lastTorque && time - chunk.lastTime <= gap ) {
+            chunk.changes.push_back( {chunk.lastTime, time, pValues[columns.torque]} );
+        }
+
+        if (bCalibrated && columns.apps1 >= 0 && columns.apps2 >= 0) {
+            double difference = fabs( GetPedalPercent(pValues[columns.apps1], analysis.bounds[0], analysis.bounds[1]) -
+                GetPedalPercent(pValues[columns.apps2], analysis.bounds[2], analysis.bounds[3]) );
+
+            AddDisagree(chunk.disagree, difference);
+            chunk.over.Add(time, difference > analysis.threshold, gap);
+        }
+
+        int32_t torque = (columns.torque >= 0) ? pValues[columns.torque] : 0;
+
+        if (!chunk.bSampled) {
+            chunk.firstTime = time;
+            chunk.firstTorque = torque;
+            chunk.bSampled = true;
+        }
+
+        chunk.lastTime = time;
+        chunk.lastTorque = torque;
+    };
+
+    if ( !file.Open( chunk.path.c_str() ) || !DecodeChannelLog(file, chunk.firstBuffer, 0, chunk.counts, onSample, chunk.numBuffers) ) {
+        fprintf(stderr, "analyze: cannot decode %s\n", chunk.path.c_str());
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ Collect the torque command frames of a CAN trace
+-----------------------------------------------------------------------------*/
+static void AnalyzeTrace(const std::string & path, traceResult_t & trace) {
+    mappedFile file;
+
+    logFrameHandler_t onFrame = [&](uint64_t time, const traceRecord_t & record) {
+        bool bTransmit = (record.header >> TRACE_TX_BIT) & 0x01;
+
+        if ( bTransmit && (record.header & TRACE_ID_MASK) == ANALYZE_TORQUE_ID &&
+            (record.header >> TRACE_LEN_SHIFT) >= ANALYZE_TORQUE_DLC && record.buf[0] == ANALYZE_TORQUE_REG ) {
+            trace.frames.push_back( {time, record.buf[1] | (record.buf[2] << 8)} );
+        }
+    };
+
+    if ( !file.Open( path.c_str() ) || !DecodeTrace(file, trace.counts, onFrame) ) {
+        fprintf(stderr, "analyze: %s is not a version %u CAN trace\n", path.c_str(), TRACE_VERSION);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ Add the time and edges of one bit of a run list to a report's counters
+-----------------------------------------------------------------------------*/
+static void CountRuns(const std::vector<analysisRun_t> & runs, uint8_t bit, uint64_t & count, uint64_t & time, uint64_t & longest) {
+    uint64_t streak = 0;
+
+    for (size_t index = 0; index < runs.size(); ++index) {
+        const analysisRun_t & run = runs[index];
+        bool bSet = (run.value >> bit) & 0x01;
+        bool bContinued = index > 0 && runs[index - 1].end == run.start && ( (runs[index - 1].value >> bit) & 0x01 );
+
+        if (!bSet) {
+            streak = 0;
+            continue;
+        }
+
+        streak = bContinued ? streak + (run.end - run.start) : run.end - run.start;
+        count += bContinued ? 0 : 1;
+        time += run.end - run.start;
+        longest = (streak > longest) ? streak : longest;
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ Stitch the chunks of a session in order and build its report (runs on the last task)
+-----------------------------------------------------------------------------*/
+static void FinishSession(analysisSession_t & analysis) {
+    analysisReport_t & report = analysis.report;
+    runList states;
+    runList faults;
+    runList over;
+    std::vector<torqueChange_t> changes;
+    std::vector<torqueFrame_t> frames;
+    const chunkResult_t * pPrevious = nullptr;
+
+    report.sessions = 1;
+    report.threshold = analysis.threshold;
+
+    for (const chunkResult_t & chunk : analysis.chunks) {
+        states.Append(chunk.states, analysis.gap);
+        faults.Append(chunk.faults, analysis.gap);
+        over.Append(chunk.over, analysis.gap);
+        MergeDisagree(report.disagree, chunk.disagree);
+        MergeCounts(report.counts, chunk.counts);
+
+        // A change between two chunks is only seen here
+        if ( pPrevious && chunk.bSampled && analysis.columns.torque >= 0 && chunk.firstTorque != pPrevious->lastTorque &&
+            chunk.firstTime - pPrevious->lastTime <= analysis.gap ) {
+            changes.push_back( {pPrevious->lastTime, chunk.firstTime, chunk.firstTorque} );
+        }
+
+        changes.insert(changes.end(), chunk.changes.begin(), chunk.changes.end());
+        pPrevious = chunk.bSampled ? &chunk : pPrevious;
+    }
+
+    for (const traceResult_t & trace : analysis.traces) {
+        frames.insert(frames.end(), trace.frames.begin(), trace.frames.end());
+        MergeCounts(report.counts, trace.counts);
+    }
+
+    std::stable_sort(frames.begin(), frames.end(), [](const torqueFrame_t & a, const torqueFrame_t & b) { return a.time < b.time; });
+
+    // Keep-alive frames repeat the previous command - the first frame with the new one is the change
+    report.bTraced = !analysis.traces.empty();
+    size_t next = 0;
+
+    for (const torqueChange_t & change : changes) {
+        if (!report.bTraced) {
+            break;
+        }
+
+        while (next < frames.size() && frames[next].time < change.before) {
+            ++next;
+        }
+
+        size_t index = next;
+
+        while ( index < frames.size() && frames[index].time <= change.after + ANALYZE_MATCH_WINDOW && frames[index].torque != change.torque ) {
+            ++index;
+        }
+
+        if (index < frames.size() && frames[index].torque == change.torque && frames[index].time <= change.after + ANALYZE_MATCH_WINDOW) {
+            uint32_t latency = static_cast<uint32_t>(frames[index].time - change.before);
+
+            report.latencies.push_back(latency);
+            ++report.latencyBins[ GetLatencyBin(latency) ];
+        } else {
+            ++report.unmatched;
+        }
+    }
+
+    std::sort(report.latencies.begin(), report.latencies.end());
+
+    // Time in state, and gaps between runs as unlogged time
+    const std::vector<analysisRun_t> & stateRuns = states.GetRuns();
+
+    for (size_t index = 0; index < stateRuns.size(); ++index) {
+        const analysisRun_t & run = stateRuns[index];
+        bool bContinued = index > 0 && stateRuns[index - 1].end == run.start;
+
+        report.logged += run.end - run.start;
+        report.unlogged += (index > 0 && !bContinued) ? run.start - stateRuns[index - 1].end : 0;
+
+        if (run.value >= 0 && run.value < ANALYZE_NUM_STATES) {
+            report.stateTimes[run.value] += run.end - run.start;
+            report.stateEntries[run.value] += (bContinued && stateRuns[index - 1].value == run.value) ? 0 : 1;
+        }
+    }
+
+    for (uint8_t bit = 0; bit < ANALYZE_NUM_FAULTS; ++bit) {
+        CountRuns(faults.GetRuns(), bit, report.faultCounts[bit], report.faultTimes[bit], report.faultLongest[bit]);
+    }
+
+    CountRuns(over.GetRuns(), 0, report.overCount, report.overTime, report.overLongest);
+
+    // Release the chunks - only the report is printed
+    std::vector<chunkResult_t>().swap(analysis.chunks);
+    std::vector<traceResult_t>().swap(analysis.traces);
+}
+
+/*-----------------------------------------------------------------------------
+ Merge the task results of a session once its last task finishes
+-----------------------------------------------------------------------------*/
+static void FinishTask(analysisSession_t & analysis) {
+    if (--analysis.remaining == 0) {
+        FinishSession(analysis);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ Load a session and queue a task per chunk of channel log and per CAN trace
+-----------------------------------------------------------------------------*/
+static void StartSession(workPool & pool, analysisSession_t & analysis) {
+    logSession_t & session = analysis.session;
+    std::string sessionPath = session.path;
+
+    if ( !LoadSession(sessionPath.c_str(), session) ) {
+        analysis.bFailed = true;
+        return;
+    }
+
+    for (const std::string & path : session.datalogs) {
+        mappedFile file;
+        const channelFileHeader_t * pHeader = file.Open( path.c_str() ) ? GetChannelHeader(file) : nullptr;
+
+        if (!pHeader) {
+            fprintf(stderr, "analyze: %s is not a version %u channel log\n", path.c_str(), CHANNEL_VERSION);
+            analysis.bFailed = true;
+            return;
+        }
+
+        // Every channel log of a session has the same channels
+        if ( analysis.chunks.empty() ) {
+            analysis.columns = {GetColumn(*pHeader, "APPS1"), GetColumn(*pHeader, "APPS2"), GetColumn(*pHeader, "TORQUE"),
+                GetColumn(*pHeader, "STATE"), GetColumn(*pHeader, "FAULTS")};
+            analysis.gap = static_cast<uint64_t>(pHeader->samplePeriod) * ANALYZE_GAP_PERIODS;
+        }
+
+        uint64_t buffers = GetBufferCount(file, *pHeader);
+
+        for (uint64_t first = 0; first < buffers; first += ANALYZE_CHUNK_BUFFERS) {
+            chunkResult_t chunk = {};
+
+            chunk.path = path;
+            chunk.firstBuffer = first;
+            chunk.numBuffers = ANALYZE_CHUNK_BUFFERS;
+            analysis.chunks.push_back( std::move(chunk) );
+        }
+    }
+
+    memcpy(analysis.bounds, session.header.pedalBounds, sizeof(analysis.bounds));
+    analysis.threshold = (session.header.parameterCount > ANALYZE_AGREEMENT_INDEX) ?
+        static_cast<int32_t>(session.header.parameters[ANALYZE_AGREEMENT_INDEX]) : ANALYZE_AGREEMENT;
+    analysis.traces.resize( session.traces.size() );
+    analysis.remaining = analysis.chunks.size() + analysis.traces.size() + 1;
+
+    for (chunkResult_t & chunk : analysis.chunks) {
+        pool.Submit([&analysis, &chunk]() {
+            AnalyzeChunk(analysis, chunk);
+            FinishTask(analysis);
+        });
+    }
+
+    for (size_t index = 0; index < analysis.traces.size(); ++index) {
+        pool.Submit([&analysis, index]() {
+            AnalyzeTrace(analysis.session.traces[index], analysis.traces[index]);
+            FinishTask(analysis);
+        });
+    }
+
+    // This task counts too, so a session without any logs is still merged
+    FinishTask(analysis);
+}
+
+/*-----------------------------------------------------------------------------
+ Add a session report to the total
+-----------------------------------------------------------------------------*/
+static void MergeReport(analysisReport_t & total, const analysisReport_t & report) {
+    total.sessions += report.sessions;
+    MergeCounts(total.counts, report.counts);
+    total.logged += report.logged;
+    total.unlogged += report.unlogged;
+
+    total.latencies.insert(total.latencies.end(), report.latencies.begin(), report.latencies.end());
+    total.unmatched += report.unmatched;
+    total.bTraced = total.bTraced || report.bTraced;
+
+    for (uint8_t bin = 0; bin < ANALYZE_LATENCY_BINS; ++bin) {
+        total.latencyBins[bin] += report.latencyBins[bin];
+    }
+
+    for (uint8_t state = 0; state < ANALYZE_NUM_STATES; ++state) {
+        total.stateTimes[state] += report.stateTimes[state];
+        total.stateEntries[state] += report.stateEntries[state];
+    }
+
+    for (uint8_t bit = 0; bit < ANALYZE_NUM_FAULTS; ++bit) {
+        total.faultCounts[bit] += report.faultCounts[bit];
+        total.faultTimes[bit] += report.faultTimes[bit];
+        total.faultLongest[bit] = (report.faultLongest[bit] > total.faultLongest[bit]) ? report.faultLongest[bit] : total.faultLongest[bit];
+    }
+
+    MergeDisagree(total.disagree, report.disagree);
+    total.overCount += report.overCount;
+    total.overTime += report.overTime;
+    total.overLongest = (report.overLongest > total.overLongest) ? report.overLongest : total.overLongest;
+    total.threshold = (total.sessions == report.sessions || total.threshold == report.threshold) ? report.threshold : -1;
+}
+
+/*-----------------------------------------------------------------------------
+ Latency at a fraction of the sorted latencies (nearest rank)
+-----------------------------------------------------------------------------*/
+static uint32_t GetPercentile(const std::vector<uint32_t> & latencies, double fraction) {
+    size_t rank = static_cast<size_t>( ceil(fraction * latencies.size()) );
+
+    return latencies[ (rank > 0) ? rank - 1 : 0 ];
+}
+
+/*-----------------------------------------------------------------------------
+ Upper edge of the disagreement bin holding a fraction of the samples (%)
+-----------------------------------------------------------------------------*/
+static uint32_t GetDisagreePercentile(const disagreeStats_t & stats, double fraction) {
+    uint64_t count = 0;
+
+    for (uint32_t bin = 0; bin < ANALYZE_DISAGREE_BINS; ++bin) {
+        count += stats.bins[bin];
+
+        if (count >= fraction * stats.samples) {
+            return bin + 1;
+        }
+    }
+
+    return ANALYZE_DISAGREE_BINS;
+}
+
+/*-----------------------------------------------------------------------------
+ Print the one line summary of a session
+-----------------------------------------------------------------------------*/
+static void PrintSessionLine(const analysisSession_t & analysis) {
+    const analysisReport_t & report = analysis.report;
+    uint64_t faults = 0;
+
+    for (uint8_t bit = 0; bit < ANALYZE_NUM_FAULTS; ++bit) {
+        faults += report.faultCounts[bit];
+    }
+
+    printf("S%05u  %9.3f s  %9" PRIu64 " samples  %9" PRIu64 " frames", analysis.session.header.session,
+        report.logged / 1e6, report.counts.samples, report.counts.frames);
+
+    if ( !report.latencies.empty() ) {
+        printf("  latency p50 %5u p99 %5u max %5u us", GetPercentile(report.latencies, 0.5),
+            GetPercentile(report.latencies, 0.99), report.latencies.back());
+    } else {
+        printf("  latency %-31s", report.bTraced ? "-" : "no CAN trace");
+    }
+
+    printf("  faults %3" PRIu64 "  APPS disagree max %5.1f %%\n", faults, report.disagree.maximum);
+}
+
+/*-----------------------------------------------------------------------------
+ Print a full report
+-----------------------------------------------------------------------------*/
+static void PrintReport(const char * pTitle, const analysisReport_t & report) {
+    const std::vector<uint32_t> & latencies = report.latencies;
+
+    printf("\n== %s: %" PRIu64 " sessions, %.3f s logged (%.3f s unlogged), %" PRIu64 " samples, %" PRIu64 " frames (%" PRIu64 " dropped), %" PRIu64 " corrupt buffers ==\n",
+        pTitle, report.sessions, report.logged / 1e6, report.unlogged / 1e6, report.counts.samples, report.counts.frames,
+        report.counts.dropped, report.counts.corrupt);
+
+    printf("pedal to torque frame latency (us):");
+
+    if ( latencies.empty() ) {
+        printf(" %s, %" PRIu64 " unmatched\n", report.bTraced ? "no torque changes matched" : "no CAN trace", report.unmatched);
+    } else {
+        uint64_t total = 0;
+
+        for (uint32_t latency : latencies) {
+            total += latency;
+        }
+
+        printf(" n %zu unmatched %" PRIu64 " min %u mean %" PRIu64 " p50 %u p90 %u p99 %u p99.9 %u max %u\n",
+            latencies.size(), report.unmatched, latencies.front(), total / latencies.size(), GetPercentile(latencies, 0.5),
+            GetPercentile(latencies, 0.9), GetPercentile(latencies, 0.99), GetPercentile(latencies, 0.999), latencies.back());
+
+        // Non-empty bins as 2^n:count
+        printf("  histogram:");
+
+        for (uint8_t bin = 0; bin < ANALYZE_LATENCY_BINS; ++bin) {
+            if (report.latencyBins[bin]) {
+                printf(" %u:%" PRIu64, bin, report.latencyBins[bin]);
+            }
+        }
+
+        printf("\n");
+    }
+
+    printf("%-14s %12s %8s %8s\n", "state", "time", "share", "entries");
+
+    for (uint8_t state = 0; state < ANALYZE_NUM_STATES; ++state) {
+        if (report.stateEntries[state]) {
+            printf("  %-12s %10.3f s %6.1f %% %8" PRIu64 "\n", stateNames[state], report.stateTimes[state] / 1e6,
+                report.logged ? 100.0 * report.stateTimes[state] / report.logged : 0.0, report.stateEntries[state]);
+        }
+    }
+
+    printf("%-14s %8s %12s %12s\n", "fault", "count", "total", "longest");
+
+    for (uint8_t bit = 0; bit < ANALYZE_NUM_FAULTS; ++bit) {
+        printf("  %-12s %8" PRIu64 " %10.3f s %10.3f s\n", faultNames[bit], report.faultCounts[bit],
+            report.faultTimes[bit] / 1e6, report.faultLongest[bit] / 1e6);
+    }
+
+    const disagreeStats_t & disagree = report.disagree;
+
+    printf("APPS disagreement (raw readings, %% of travel):");
+
+    if (!disagree.samples) {
+        printf(" pedals not calibrated\n");
+        return;
+    }
+
+    printf(" n %" PRIu64 " mean %.2f p99 <%u max %.2f\n", disagree.samples, disagree.total / disagree.samples,
+        GetDisagreePercentile(disagree, 0.99), disagree.maximum);
+
+    if (report.threshold >= 0) {
+        printf("  over %d %%: %" PRIu64 " times, %.3f s, longest %.3f s\n", report.threshold, report.overCount,
+            report.overTime / 1e6, report.overLongest / 1e6);
+    } else {
+        printf("  over agreement parameter: %" PRIu64 " times, %.3f s, longest %.3f s\n", report.overCount,
+            report.overTime / 1e6, report.overLongest / 1e6);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ Add the session files under a path (directories are searched recursively)
+-----------------------------------------------------------------------------*/
+static void AddSessions(const std::string & path, std::vector<std::string> & paths) {
+    struct stat status;
+    uint32_t session = 0;
+
+    if ( stat(path.c_str(), &status) != 0 ) {
+        fprintf(stderr, "analyze: cannot open %s\n", path.c_str());
+        return;
+    }
+
+    if ( !S_ISDIR(status.st_mode) ) {
+        paths.push_back(path);
+        return;
+    }
+
+    DIR * pDirectory = opendir( path.c_str() );
+    struct dirent * pEntry = nullptr;
+
+    while ( pDirectory && (pEntry = readdir(pDirectory)) != nullptr ) {
+        std::string name = pEntry->d_name;
+        std::string child = path + "/" + name;
+
+        if (name == "." || name == "..") {
+            continue;
+        }
+
+        if ( stat(child.c_str(), &status) == 0 && S_ISDIR(status.st_mode) ) {
+            AddSessions(child, paths);
+        } else if ( ParseSessionNumber(name.c_str(), session) && name.size() > 4 && name.compare(name.size() - 4, 4, ".SES") == 0 ) {
+            paths.push_back(child);
+        }
+    }
+
+    if (pDirectory) {
+        closedir(pDirectory);
+    }
+}
+
+/*-------------------------------------------------------------------------------------------------
+ Main
+-------------------------------------------------------------------------------------------------*/
+int main(int argc, char ** argv) {
+    std::vector<std::string> paths;
+    std::vector<std::unique_ptr<analysisSession_t>> sessions;
+    analysisReport_t total = {};
+    uint32_t threads = 0;
+    uint32_t budget = 0;
+    bool bVerbose = false;
+    bool bFailed = false;
+    int option;
+
+    while ( (option = getopt(argc, argv, "j:vb:")) != -1 ) {
+        switch (option) {
+            case ('j'):
+                threads = strtoul(optarg, NULL, 10);
+                break;
+
+            case ('v'):
+                bVerbose = true;
+                break;
+
+            case ('b'):
+                budget = strtoul(optarg, NULL, 10);
+                break;
+
+            default:
+                return 2;
+        }
+    }
+
+    if (optind >= argc) {
+        fprintf(stderr, "usage: %s [-j threads] [-v] [-b us] card_dir|session.SES ...\n", argv[0]);
+        return 2;
+    }
+
+    for (int index = optind; index < argc; ++index) {
+        AddSessions(argv[index], paths);
+    }
+
+    std::sort(paths.begin(), paths.end());
+
+    {
+        workPool pool(threads);
+
+        for (const std::string & path : paths) {
+            sessions.emplace_back(new analysisSession_t());
+            sessions.back()->session.path = path;
+        }
+
+        for (std::unique_ptr<analysisSession_t> & pAnalysis : sessions) {
+            analysisSession_t * pSession = pAnalysis.get();
+
+            pool.Submit([&pool, pSession]() { StartSession(pool, *pSession); });
+        }
+
+        pool.Wait();
+
+        fprintf(stderr, "analyze: %zu sessions on %u threads (%" PRIu64 " tasks stolen)\n", sessions.size(),
+            pool.GetThreads(), pool.GetSteals());
+    }
+
+    for (const std::unique_ptr<analysisSession_t> & pAnalysis : sessions) {
+        const analysisReport_t & report = pAnalysis->report;
+
+        if (pAnalysis->bFailed) {
+            bFailed = true;
+            continue;
+        }
+
+        PrintSessionLine(*pAnalysis);
+        MergeReport(total, report);
+
+        if ( budget && !report.latencies.empty() && GetPercentile(report.latencies, 0.99) > budget ) {
+            fprintf(stderr, "analyze: S%05u p99 latency %u us is over the %u us budget\n", pAnalysis->session.header.session,
+                GetPercentile(report.latencies, 0.99), budget);
+            bFailed = true;
+        }
+    }
+
+    if (bVerbose) {
+        for (const std::unique_ptr<analysisSession_t> & pAnalysis : sessions) {
+            char title[LOGFILE_NAME_SIZE];
+
+            if (!pAnalysis->bFailed) {
+                snprintf(title, sizeof(title), "S%05u", pAnalysis->session.header.session);
+                PrintReport(title, pAnalysis->report);
+            }
+        }
+    }
+
+    std::sort(total.latencies.begin(), total.latencies.end());
+    PrintReport("total", total);
+
+    return bFailed ? 1 : 0;
+}
@@ -0,0 +1,207 @@
+// Safe guards
+#ifndef WORKPOOL_H
+#define WORKPOOL_H
+
+/*-------------------------------------------------------------------------------------------------
+ Work stealing thread pool for the host tools - every worker owns a deque, runs its own tasks newest
+ first and steals the oldest task of another worker when it runs out
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+typedef std::function<void(void)> workTask_t;
+
+/*-------------------------------------------------------------------------------------------------
+ Thread pool - tasks may submit more tasks, Wait returns once every task has run
+-------------------------------------------------------------------------------------------------*/
+class workPool {
+    public:
+        // Constructor
+        workPool(uint32_t threads);
+        ~workPool(void);
+
+        workPool(const workPool &) = delete;
+        workPool & operator=(const workPool &) = delete;
+
+        // Getters
+        uint32_t GetThreads(void) const { return static_cast<uint32_t>( workers.size() ); }
+        uint64_t GetSteals(void) const { return steals; }
+
+        // Data methods
+        void Submit(workTask_t task);
+        void Wait(void);
+
+    private:
+        // Helpers
+        bool TakeTask(uint32_t self, workTask_t & task);
+        void RunWorker(uint32_t self);
+
+        typedef struct workQueue {
+            std::mutex mutex;
+            std::deque<workTask_t> tasks;
+        } workQueue_t;
+
+        std::vector<std::unique_ptr<workQueue_t>> queues;
+        std::vector<std::thread> workers;
+
+        // Sleeping workers wait on wake, Wait on idle
+        std::mutex sleepMutex;
+        std::condition_variable wake;
+        std::condition_variable idle;
+        bool bStop;
+
+        std::atomic<int64_t> queued;    // Tasks in the deques
+        std::atomic<int64_t> pending;   // Tasks submitted and not finished
+        std::atomic<uint64_t> steals;
+        std::atomic<uint32_t> nextQueue;
+
+        // Worker running on this thread (tasks submitted by a worker go to its own deque)
+        static thread_local workPool * pCurrentPool;
+        static thread_local uint32_t currentWorker;
+};
+
+// Initialize variables
+inline thread_local workPool * workPool::pCurrentPool = nullptr;
+inline thread_local uint32_t workPool::currentWorker = 0;
+
+/*-----------------------------------------------------------------------------
+ Start the workers (0 threads - one per hardware thread)
+-----------------------------------------------------------------------------*/
+inline workPool::workPool(uint32_t threads) : bStop(false), queued(0), pending(0), steals(0), nextQueue(0) {
+    threads = threads ? threads : std::thread::hardware_concurrency();
+    threads = threads ? threads : 1;
+
+    for (uint32_t index = 0; index < threads; ++index) {
+        queues.emplace_back(new workQueue_t);
+    }
+
+    for (uint32_t index = 0; index < threads; ++index) {
+        workers.emplace_back(&workPool::RunWorker, this, index);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ Finish every task and stop the workers
+-----------------------------------------------------------------------------*/
+inline workPool::~workPool(void) {
+    Wait();
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        bStop = true;
+    }
+
+    wake.notify_all();
+
+    for (std::thread & worker : workers) {
+        worker.join();
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ Queue a task - on the caller's own deque from a worker, round robin otherwise
+-----------------------------------------------------------------------------*/
+inline void workPool::Submit(workTask_t task) {
+    uint32_t index = (pCurrentPool == this) ? currentWorker : nextQueue++ % queues.size();
+
+    ++pending;
+
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back( std::move(task) );
+    }
+
+    ++queued;
+
+    // Taking the lock orders the count before a sleeping worker's check
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+
+    wake.notify_one();
+}
+
+/*-----------------------------------------------------------------------------
+ Block until every submitted task (and every task they submitted) has run
+-----------------------------------------------------------------------------*/
+inline void workPool::Wait(void) {
+    std::unique_lock<std::mutex> lock(sleepMutex);
+
+    idle.wait(lock, [this]() { return pending == 0; });
+}
+
+/*-----------------------------------------------------------------------------
+ Pop the newest own task or steal the oldest of another worker - Returns false if all are empty
+-----------------------------------------------------------------------------*/
+inline bool workPool::TakeTask(uint32_t self, workTask_t & task) {
+    for (uint32_t offset = 0; offset < queues.size(); ++offset) {
+        workQueue_t & queue = *queues[(self + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if ( queue.tasks.empty() ) {
+            continue;
+        }
+
+        // Own tasks depth first (their data is still in cache), stolen ones breadth first
+        if (offset == 0) {
+            task = std::move( queue.tasks.back() );
+            queue.tasks.pop_back();
+        } else {
+            task = std::move( queue.tasks.front() );
+            queue.tasks.pop_front();
+            ++steals;
+        }
+
+        --queued;
+
+        return true;
+    }
+
+    return false;
+}
+
+/*-----------------------------------------------------------------------------
+ Run tasks until the pool stops
+-----------------------------------------------------------------------------*/
+inline void workPool::RunWorker(uint32_t self) {
+    workTask_t task;
+
+    pCurrentPool = this;
+    currentWorker = self;
+
+    while (true) {
+        if ( TakeTask(self, task) ) {
+            task();
+            task = nullptr;
+
+            if (--pending == 0) {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                idle.notify_all();
+            }
+
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+
+        wake.wait(lock, [this]() { return bStop || queued > 0; });
+
+        if (bStop && queued <= 0) {
+            return;
+        }
+    }
+}
+
+// End safe guards
+#endif /* WORKPOOL_H */
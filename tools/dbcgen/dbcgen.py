@@ -0,0 +1,224 @@
+#!/usr/bin/env python3
+"""
+Generate constexpr CAN encode/decode functions from a DBC file.
+
+Usage: dbcgen.py <input.dbc> <output.h>
+
+Only little endian (Intel, @1) signals are supported. Each message becomes a
+struct of raw integer fields plus Encode<Name>/Decode<Name> functions made of
+straight-line shifts and masks. The output is only rewritten when it changes.
+"""
+import os
+import re
+import sys
+
+RE_MESSAGE = re.compile(r'^BO_\s+(\d+)\s+(\w+)\s*:\s*(\d+)\s+(\w+)')
+RE_SIGNAL = re.compile(
+    r'^SG_\s+(\w+)\s*:\s*(\d+)\|(\d+)@([01])([+-])\s*'
+    r'\(([^,]+),([^)]+)\)\s*\[([^|]*)\|([^\]]*)\]\s*"([^"]*)"')
+
+
+class Signal:
+    def __init__(self, name, start, length, signed, factor, offset, unit):
+        self.name = name
+        self.start = start
+        self.length = length
+        self.signed = signed
+        self.factor = factor
+        self.offset = offset
+        self.unit = unit
+
+    @property
+    def field(self):
+        return self.name[0].lower() + self.name[1:]
+
+    @property
+    def ctype(self):
+        for bits in (8, 16, 32, 64):
+            if self.length <= bits:
+                return ('int%d_t' if self.signed else 'uint%d_t') % bits
+        raise ValueError('signal %s longer than 64 bits' % self.name)
+
+    @property
+    def rawtype(self):
+        return 'uint64_t' if self.length > 32 else 'uint32_t'
+
+
+class Message:
+    def __init__(self, frame_id, name, dlc, sender):
+        self.frame_id = frame_id
+        self.name = name
+        self.dlc = dlc
+        self.sender = sender
+        self.signals = []
+
+    @property
+    def camel(self):
+        return ''.join(part.capitalize() for part in self.name.split('_'))
+
+
+def parse(path):
+    messages = []
+    with open(path) as dbc:
+        for number, line in enumerate(dbc, 1):
+            line = line.strip()
+            match = RE_MESSAGE.match(line)
+            if match:
+                frame_id, name, dlc, sender = match.groups()
+                messages.append(Message(int(frame_id), name, int(dlc), sender))
+                continue
+
+            match = RE_SIGNAL.match(line)
+            if match:
+                if not messages:
+                    sys.exit('%s:%d: signal outside of a message' % (path, number))
+
+                name, start, length, order, sign, factor, offset, _, _, unit = match.groups()
+                if order != '1':
+                    sys.exit('%s:%d: big endian signal %s is not supported' % (path, number, name))
+
+                signal = Signal(name, int(start), int(length), sign == '-',
+                                float(factor), float(offset), unit)
+                message = messages[-1]
+                if signal.start + signal.length > 8 * message.dlc:
+                    sys.exit('%s:%d: signal %s does not fit in %d bytes' % (path, number, name, message.dlc))
+
+                message.signals.append(signal)
+            elif line.startswith('SG_'):
+                sys.exit('%s:%d: unable to parse signal' % (path, number))
+
+    return messages
+
+
+def mask(bits):
+    return '0x%X' % ((1 << bits) - 1)
+
+
+def byte_terms(signal, index):
+    # Portion of the signal that lands in byte 'index'
+    low = max(signal.start, 8 * index)
+    high = min(signal.start + signal.length - 1, 8 * index + 7)
+    if low > high:
+        return None
+    return low, high
+
+
+def encode_byte(message, index):
+    terms = []
+    for signal in message.signals:
+        bits = byte_terms(signal, index)
+        if not bits:
+            continue
+
+        low, high = bits
+        value = 'static_cast<%s>(msg.%s)' % (signal.rawtype, signal.field)
+        if low - signal.start:
+            value = '(%s >> %d)' % (value, low - signal.start)
+        # Bits above the top of the byte are dropped by the final cast
+        if high != 8 * index + 7:
+            value = '(%s & %s)' % (value, mask(high - low + 1))
+        if low - 8 * index:
+            value = '(%s << %d)' % (value, low - 8 * index)
+        terms.append(value)
+
+    return ' | '.join(terms) if terms else '0'
+
+
+def decode_signal(signal):
+    terms = []
+    for index in range(signal.start // 8, (signal.start + signal.length - 1) // 8 + 1):
+        low, high = byte_terms(signal, index)
+        value = 'static_cast<%s>(buf[%d])' % (signal.rawtype, index)
+        if low - 8 * index:
+            value = '(%s >> %d)' % (value, low - 8 * index)
+        # Bytes used up to their top bit need no mask
+        if high != 8 * index + 7:
+            value = '(%s & %s)' % (value, mask(high - low + 1))
+        if low - signal.start:
+            value = '(%s << %d)' % (value, low - signal.start)
+        terms.append(value)
+
+    raw = ' | '.join(terms)
+    if signal.signed:
+        # Sign extend through the top bit of the signal
+        top = '0x%XU' % (1 << (signal.length - 1))
+        signed = 'int64_t' if signal.rawtype == 'uint64_t' else 'int32_t'
+        raw = 'static_cast<%s>(((%s) ^ %s) - %s)' % (signed, raw, top, top)
+
+    return 'static_cast<%s>(%s)' % (signal.ctype, raw)
+
+
+def generate(messages, source):
+    out = []
+    out.append('// Safe guards')
+    out.append('#ifndef PROTOCOL_H')
+    out.append('#define PROTOCOL_H')
+    out.append('')
+    out.append('/*-------------------------------------------------------------------------------------------------')
+    out.append(' Generated from %s by tools/dbcgen/dbcgen.py - DO NOT EDIT' % source)
+    out.append('-------------------------------------------------------------------------------------------------*/')
+    out.append('#include <stdint.h>')
+    out.append('')
+    out.append('/*------------------------------------------')
+    out.append(' Macros - Message IDs & DLCs')
+    out.append('------------------------------------------*/')
+    for message in messages:
+        out.append('#define %-24s 0x%03X' % ('ID_' + message.name, message.frame_id))
+        out.append('#define %-24s %d' % ('PAR_' + message.name + '_DLC', message.dlc))
+
+    for message in messages:
+        out.append('')
+        out.append('/*-------------------------------------------------------------------------------------------------')
+        out.append(' %s (0x%03X) - Sent by %s' % (message.name, message.frame_id, message.sender))
+        out.append('-------------------------------------------------------------------------------------------------*/')
+        out.append('typedef struct can%s {' % message.camel)
+        for signal in message.signals:
+            scale = '' if signal.factor == 1 and signal.offset == 0 else \
+                ' x %g + %g' % (signal.factor, signal.offset)
+            unit = (' ' + signal.unit) if signal.unit else ''
+            out.append('    %-9s %-16s // Bits %d-%d%s%s' % (
+                signal.ctype, signal.field + ';', signal.start,
+                signal.start + signal.length - 1, scale, unit))
+        out.append('} can%s_t;' % message.camel)
+        out.append('')
+        out.append('constexpr void Encode%s(const can%s_t & msg, uint8_t * buf) {' % (message.camel, message.camel))
+        for index in range(message.dlc):
+            out.append('    buf[%d] = static_cast<uint8_t>(%s);' % (index, encode_byte(message, index)))
+        out.append('}')
+        out.append('')
+        out.append('constexpr can%s_t Decode%s(const uint8_t * buf) {' % (message.camel, message.camel))
+        out.append('    can%s_t msg = {};' % message.camel)
+        for signal in message.signals:
+            out.append('    msg.%s = %s;' % (signal.field, decode_signal(signal)))
+        out.append('    return msg;')
+        out.append('}')
+
+    out.append('')
+    out.append('// End safe guards')
+    out.append('#endif /* PROTOCOL_H */')
+    return '\n'.join(out) + '\n'
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit('usage: dbcgen.py <input.dbc> <output.h>')
+
+    source, target = sys.argv[1], sys.argv[2]
+
+    # Name the DBC relative to the project so the header is identical on every checkout
+    project = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+    header = generate(parse(source), os.path.relpath(os.path.abspath(source), project).replace(os.sep, '/'))
+
+    # Leave the header untouched when nothing changed to avoid full rebuilds
+    if os.path.exists(target):
+        with open(target, newline='') as existing:
+            if existing.read() == header:
+                return
+
+    with open(target, 'w', newline='\n') as output:
+        output.write(header)
+    print('dbcgen: wrote %s' % target)
+
+
+if __name__ == '__main__':
+    main()
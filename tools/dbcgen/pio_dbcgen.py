@@ -0,0 +1,15 @@
+# PlatformIO pre-build hook - regenerate comms/protocol.h from the DBC before compiling
+import os
+import subprocess
+import sys
+
+Import("env")
+
+project = env.subst("$PROJECT_DIR")
+
+subprocess.check_call([
+    sys.executable,
+    os.path.join(project, "tools", "dbcgen", "dbcgen.py"),
+    os.path.join(project, "dbc", "ECU.dbc"),
+    os.path.join(project, "include", "comms", "protocol.h"),
+])
@@ -0,0 +1,506 @@
+/*-------------------------------------------------------------------------------------------------
+ Host Data Log Decoder & Exporter
+ Decodes the channel logs recorded by the ECU in one streaming pass over memory mapped files, so a
+ log of any size decodes without being read into RAM. Given session files (Snnnnn.SES) it decodes
+ every channel log of each session, using the block index to start at a time or to list fault
+ events without reading the logs. Given channel logs (SnnnnnLmmm.BIN) it decodes each one, finding
+ -t with a binary search over the buffer keyframes.
+
+ Without -o the samples are printed as CSV (one row per sample, ECU time in us). With -o every
+ input is exported on its own, inputs decoding on -j threads at once:
+   CSV       <dir>/Snnnnn.csv
+   Columnar  <dir>/Snnnnn/time_us.u64 and <dir>/Snnnnn/<channel>.i32 (little endian arrays with one
+             element per sample - e.g. numpy.fromfile(path, "<i4"))
+
+ Build: pio run -e decode
+ Usage: .pio/build/decode/program [-t seconds] [-q] S00001.SES [S00002.SES ...]
+        .pio/build/decode/program -o dir [-c] [-j threads] [-t seconds] S00001.SES [S00002.SES ...]
+        .pio/build/decode/program -e S00001.SES
+        .pio/build/decode/program [-t seconds] [-q] S00001L000.BIN [S00001L001.BIN ...]
+   -o  Export each input to this directory instead of printing
+   -c  Export columnar binary instead of CSV (with -o)
+   -j  Inputs exported at once (default - one per hardware thread)
+   -t  Start this many seconds after the start of the session (or of each channel log)
+   -e  List the session header and the fault events in its index
+   -q  Only print the summary (samples and bytes per sample)
+-------------------------------------------------------------------------------------------------*/
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include <atomic>
+#include <thread>
+
+#include "logfile.h"
+
+/*------------------------------------------
+ Macros - Exporter
+------------------------------------------*/
+#define EXPORT_STREAM_SIZE       (1024 * 1024)   // stdio buffer of each CSV
+#define EXPORT_COLUMN_CHUNK      65536           // Samples held per column between writes
+#define EXPORT_DIGITS_SIZE       24              // Longest decimal of a 64 bit value and its sign
+#define EXPORT_ROW_SIZE          ( (CHANNEL_MAX_CHANNELS + 1) * (EXPORT_DIGITS_SIZE + 1) )
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+// One session or channel log - decoded by one thread
+typedef struct decodeJob {
+    std::string path;
+    bool bSession;
+    bool bFailed;
+    logCounts_t counts;
+} decodeJob_t;
+
+typedef struct decodeOptions {
+    const char * pOutput;     // Export directory (NULL - print CSV)
+    bool bColumnar;
+    bool bEvents;
+    bool bQuiet;
+    uint64_t offset;          // Start after the start of the session or file (us)
+    uint32_t threads;         // 0 - one per hardware thread
+} decodeOptions_t;
+
+static decodeOptions_t options = {NULL, false, false, false, 0, 0};
+
+// Printed inputs share one header row
+static bool bColumns = false;
+
+/*-------------------------------------------------------------------------------------------------
+ CSV export - rows are formatted by hand (printf is most of the decode time otherwise)
+-------------------------------------------------------------------------------------------------*/
+class csvExport {
+    public:
+        // Constructor
+        csvExport(void) : pFile(nullptr), bOwned(false) {}
+        ~csvExport(void) { Close(); }
+
+        // Data methods
+        bool Open(const char * pPath);
+        void WriteColumns(const channelFileHeader_t & header);
+        void WriteRow(uint64_t time, const int32_t * pValues, uint16_t numChannels);
+        bool Close(void);
+
+    private:
+        FILE * pFile;
+        bool bOwned;
+        std::vector<char> stream;
+};
+
+/*-----------------------------------------------------------------------------
+ Create the CSV (NULL - stdout) - Returns false if it cannot be created
+-----------------------------------------------------------------------------*/
+bool csvExport::Open(const char * pPath) {
+    bOwned = (pPath != NULL);
+    pFile = bOwned ? fopen(pPath, "wb") : stdout;
+
+    // stdout is buffered once by main
+    if (pFile && bOwned) {
+        stream.resize(EXPORT_STREAM_SIZE);
+        setvbuf(pFile, stream.data(), _IOFBF, stream.size());
+    }
+
+    return pFile != nullptr;
+}
+
+/*-----------------------------------------------------------------------------
+ Write the column names
+-----------------------------------------------------------------------------*/
+void csvExport::WriteColumns(const channelFileHeader_t & header) {
+    fputs("time_us", pFile);
+
+    for (uint16_t index = 0; index < header.numChannels; ++index) {
+        fprintf(pFile, ",%.*s", CHANNEL_NAME_SIZE, header.names[index]);
+    }
+
+    fputc('\n', pFile);
+}
+
+/*-----------------------------------------------------------------------------
+ Store the decimal digits of a magnitude ending at pEnd - Returns the first character
+-----------------------------------------------------------------------------*/
+static char * FormatDecimal(uint64_t magnitude, bool bNegative, char * pEnd) {
+    do {
+        *--pEnd = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude);
+
+    if (bNegative) {
+        *--pEnd = '-';
+    }
+
+    return pEnd;
+}
+
+/*-----------------------------------------------------------------------------
+ Write one sample
+-----------------------------------------------------------------------------*/
+void csvExport::WriteRow(uint64_t time, const int32_t * pValues, uint16_t numChannels) {
+    char row[EXPORT_ROW_SIZE];
+    char digits[EXPORT_DIGITS_SIZE];
+    char * pEnd = digits + sizeof(digits);
+    char * pStart = FormatDecimal(time, false, pEnd);
+    size_t used = pEnd - pStart;
+
+    memcpy(row, pStart, used);
+
+    for (uint16_t index = 0; index < numChannels; ++index) {
+        // Magnitude in 64 bits so INT32_MIN negates
+        int64_t value = pValues[index];
+
+        pStart = FormatDecimal( (value < 0) ? -value : value, value < 0, pEnd );
+        row[used++] = ',';
+        memcpy(&row[used], pStart, pEnd - pStart);
+        used += pEnd - pStart;
+    }
+
+    row[used++] = '\n';
+    fwrite(row, 1, used, pFile);
+}
+
+/*-----------------------------------------------------------------------------
+ Flush and close the CSV - Returns false if a write failed
+-----------------------------------------------------------------------------*/
+bool csvExport::Close(void) {
+    bool bOk = true;
+
+    if (pFile) {
+        bOk = (fflush(pFile) == 0) && !ferror(pFile);
+        bOk = (!bOwned || fclose(pFile) == 0) && bOk;
+    }
+
+    pFile = nullptr;
+
+    return bOk;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ Columnar export - one little endian array per column, written a chunk at a time
+-------------------------------------------------------------------------------------------------*/
+class columnExport {
+    public:
+        // Constructor
+        columnExport(void) : numChannels(0), count(0), bOk(true) {}
+        ~columnExport(void) { Close(); }
+
+        // Data methods
+        bool Open(const std::string & directory, const channelFileHeader_t & header);
+        void WriteRow(uint64_t time, const int32_t * pValues);
+        bool Close(void);
+
+    private:
+        // Helpers
+        void Flush(void);
+
+        std::vector<FILE *> files;        // Time, then each channel
+        std::vector<uint64_t> times;
+        std::vector<int32_t> values;      // EXPORT_COLUMN_CHUNK per channel, channel after channel
+        uint16_t numChannels;
+        uint32_t count;
+        bool bOk;
+};
+
+/*-----------------------------------------------------------------------------
+ Create the directory and a file per column - Returns false if any cannot be created
+-----------------------------------------------------------------------------*/
+bool columnExport::Open(const std::string & directory, const channelFileHeader_t & header) {
+    if ( mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST ) {
+        return false;
+    }
+
+    numChannels = header.numChannels;
+    times.resize(EXPORT_COLUMN_CHUNK);
+    values.resize(static_cast<size_t>(EXPORT_COLUMN_CHUNK) * numChannels);
+    files.push_back( fopen( (directory + "/time_us.u64").c_str(), "wb" ) );
+
+    for (uint16_t index = 0; index < numChannels; ++index) {
+        std::string name( header.names[index], strnlen(header.names[index], CHANNEL_NAME_SIZE) );
+
+        files.push_back( fopen( (directory + "/" + name + ".i32").c_str(), "wb" ) );
+    }
+
+    for (FILE * pFile : files) {
+        bOk = bOk && pFile;
+    }
+
+    return bOk;
+}
+
+/*-----------------------------------------------------------------------------
+ Append the held chunk to every column
+-----------------------------------------------------------------------------*/
+void columnExport::Flush(void) {
+    bOk = bOk && fwrite(times.data(), sizeof(uint64_t), count, files[0]) == count;
+
+    for (uint16_t index = 0; index < numChannels; ++index) {
+        const int32_t * pColumn = &values[static_cast<size_t>(index) * EXPORT_COLUMN_CHUNK];
+
+        bOk = bOk && fwrite(pColumn, sizeof(int32_t), count, files[index + 1]) == count;
+    }
+
+    count = 0;
+}
+
+/*-----------------------------------------------------------------------------
+ Add one sample to every column
+-----------------------------------------------------------------------------*/
+void columnExport::WriteRow(uint64_t time, const int32_t * pValues) {
+    times[count] = time;
+
+    for (uint16_t index = 0; index < numChannels; ++index) {
+        values[static_cast<size_t>(index) * EXPORT_COLUMN_CHUNK + count] = pValues[index];
+    }
+
+    if (++count == EXPORT_COLUMN_CHUNK) {
+        Flush();
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ Write the last chunk and close every column - Returns false if a write failed
+-----------------------------------------------------------------------------*/
+bool columnExport::Close(void) {
+    if (count && bOk) {
+        Flush();
+    }
+
+    for (FILE * pFile : files) {
+        bOk = pFile && (fclose(pFile) == 0) && bOk;
+    }
+
+    files.clear();
+
+    return bOk;
+}
+
+/*-----------------------------------------------------------------------------
+ Export path of an input - its name without the extension in the output directory
+-----------------------------------------------------------------------------*/
+static std::string GetExportPath(const std::string & path) {
+    size_t slash = path.find_last_of('/');
+    std::string name = (slash == std::string::npos) ? path : path.substr(slash + 1);
+
+    return std::string(options.pOutput) + "/" + name.substr( 0, name.find_last_of('.') );
+}
+
+/*-----------------------------------------------------------------------------
+ Print the session header and every run of index entries with faults
+-----------------------------------------------------------------------------*/
+static void PrintEvents(const logSession_t & session) {
+    const sessionFileHeader_t & header = session.header;
+    const std::vector<sessionIndexEntry_t> & entries = session.entries;
+
+    printf("session %u build \"%.*s\" vehicle %.*s parameters rev %u\n", header.session,
+        SESSION_BUILD_SIZE, header.build, SESSION_VEHICLE_SIZE, header.vehicle, header.parameterRevision);
+    printf("pedal bounds APPS1 %u-%u APPS2 %u-%u BSE %u-%u\n", header.pedalBounds[0], header.pedalBounds[1],
+        header.pedalBounds[2], header.pedalBounds[3], header.pedalBounds[4], header.pedalBounds[5]);
+    printf("start_s,end_s,faults,file,buffer\n");
+
+    for (size_t index = 0; index < entries.size(); ++index) {
+        const sessionIndexEntry_t & first = entries[index];
+
+        if (!first.faults) {
+            continue;
+        }
+
+        // Merge the buffers of one fault into a single event
+        uint8_t faults = first.faults;
+
+        while (index + 1 < entries.size() && entries[index + 1].faults) {
+            faults |= entries[++index].faults;
+        }
+
+        uint64_t end = (index + 1 < entries.size()) ? entries[index + 1].time : entries[index].time;
+
+        printf("%.3f,%.3f,0x%02X,%u,%u\n", (first.time - header.startEpoch) / 1e6, (end - header.startEpoch) / 1e6,
+            faults, first.buffer / header.buffersPerFile, first.buffer % header.buffersPerFile);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ Decode one input to its export (or stdout) - Returns false if it is invalid or the export failed
+-----------------------------------------------------------------------------*/
+static bool RunJob(decodeJob_t & job) {
+    logSession_t session;
+    mappedFile file;
+    const channelFileHeader_t * pHeader = nullptr;
+    csvExport csv;
+    columnExport columns;
+    bool bPrint = (options.pOutput == NULL);
+    bool bWrite = !(bPrint && options.bQuiet);
+
+    if (job.bSession) {
+        if ( !LoadSession(job.path.c_str(), session) ) {
+            return false;
+        }
+
+        if (options.bEvents) {
+            PrintEvents(session);
+            return true;
+        }
+
+        // Every channel log of a session has the same channels - a session without any has no export
+        if ( session.datalogs.empty() ) {
+            return true;
+        }
+
+        if ( !file.Open( session.datalogs[0].c_str() ) || !(pHeader = GetChannelHeader(file)) ) {
+            fprintf(stderr, "decode: %s is not a version %u channel log\n", session.datalogs[0].c_str(), CHANNEL_VERSION);
+            return false;
+        }
+    } else if ( !file.Open( job.path.c_str() ) || !(pHeader = GetChannelHeader(file)) ) {
+        fprintf(stderr, "decode: %s is not a version %u channel log\n", job.path.c_str(), CHANNEL_VERSION);
+        return false;
+    }
+
+    channelFileHeader_t header = *pHeader;
+    std::string exportPath = bPrint ? std::string() : GetExportPath(job.path);
+
+    if (bWrite && options.bColumnar) {
+        if ( !columns.Open(exportPath, header) ) {
+            fprintf(stderr, "decode: cannot create %s\n", exportPath.c_str());
+            return false;
+        }
+    } else if (bWrite) {
+        if ( !csv.Open( bPrint ? NULL : (exportPath + ".csv").c_str() ) ) {
+            fprintf(stderr, "decode: cannot create %s.csv\n", exportPath.c_str());
+            return false;
+        }
+
+        if (!bPrint || !bColumns) {
+            csv.WriteColumns(header);
+            bColumns = bPrint;
+        }
+    }
+
+    logSampleHandler_t onSample = [&](uint64_t time, const int32_t * pValues) {
+        if (!bWrite) {
+            return;
+        } else if (options.bColumnar) {
+            columns.WriteRow(time, pValues);
+        } else {
+            csv.WriteRow(time, pValues, header.numChannels);
+        }
+    };
+
+    bool bDecoded = false;
+
+    if (job.bSession) {
+        file.Close();
+        bDecoded = DecodeSession(session, options.offset, job.counts, onSample);
+    } else {
+        uint64_t startTime = options.offset ? header.startEpoch + options.offset : 0;
+
+        bDecoded = DecodeChannelLog(file, startTime ? SeekChannelLog(file, header, startTime) : 0, startTime, job.counts, onSample);
+    }
+
+    if ( bWrite && !(options.bColumnar ? columns.Close() : csv.Close()) ) {
+        fprintf(stderr, "decode: writing %s failed\n", bPrint ? "stdout" : exportPath.c_str());
+        return false;
+    }
+
+    return bDecoded;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ Main
+-------------------------------------------------------------------------------------------------*/
+int main(int argc, char ** argv) {
+    std::vector<decodeJob_t> jobs;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> next(0);
+    logCounts_t counts = {};
+    int option;
+
+    while ( (option = getopt(argc, argv, "o:cj:t:eq")) != -1 ) {
+        switch (option) {
+            case ('o'):
+                options.pOutput = optarg;
+                break;
+
+            case ('c'):
+                options.bColumnar = true;
+                break;
+
+            case ('j'):
+                options.threads = strtoul(optarg, NULL, 10);
+                break;
+
+            case ('t'):
+                options.offset = static_cast<uint64_t>(strtod(optarg, NULL) * 1000000);
+                break;
+
+            case ('e'):
+                options.bEvents = true;
+                break;
+
+            case ('q'):
+                options.bQuiet = true;
+                break;
+
+            default:
+                return 2;
+        }
+    }
+
+    if ( optind >= argc || (options.bColumnar && !options.pOutput) ) {
+        fprintf(stderr, "usage: %s [-o dir [-c] [-j threads]] [-t seconds] [-e] [-q] session.SES... | log...\n", argv[0]);
+        return 2;
+    }
+
+    static char stream[EXPORT_STREAM_SIZE];
+
+    setvbuf(stdout, stream, _IOFBF, sizeof(stream));
+
+    if ( options.pOutput && mkdir(options.pOutput, 0755) != 0 && errno != EEXIST ) {
+        fprintf(stderr, "decode: cannot create %s\n", options.pOutput);
+        return 1;
+    }
+
+    for (int index = optind; index < argc; ++index) {
+        const char * pExtension = strrchr(argv[index], '.');
+
+        jobs.push_back( {argv[index], pExtension && !strcmp(pExtension, ".SES"), false, {}} );
+    }
+
+    // Printed output stays in input order - exports are separate files
+    size_t threads = options.threads ? options.threads : std::thread::hardware_concurrency();
+
+    threads = (!options.pOutput || options.bEvents || !threads) ? 1 : threads;
+    threads = (threads > jobs.size()) ? jobs.size() : threads;
+
+    for (size_t index = 0; index < threads; ++index) {
+        workers.emplace_back([&]() {
+            for (size_t job = next++; job < jobs.size(); job = next++) {
+                jobs[job].bFailed = !RunJob(jobs[job]);
+            }
+        });
+    }
+
+    for (std::thread & worker : workers) {
+        worker.join();
+    }
+
+    bool bFailed = false;
+
+    for (const decodeJob_t & job : jobs) {
+        bFailed = bFailed || job.bFailed;
+        counts.samples += job.counts.samples;
+        counts.skipped += job.counts.skipped;
+        counts.corrupt += job.counts.corrupt;
+        counts.bytes += job.counts.bytes;
+        counts.files += job.counts.files;
+    }
+
+    if (bFailed || options.bEvents) {
+        return bFailed ? 1 : 0;
+    }
+
+    fprintf(stderr, "decode: %" PRIu64 " channel logs, %" PRIu64 " samples, %.1f bytes per sample, %" PRIu64 " skipped, %" PRIu64 " corrupt buffers\n",
+        counts.files, counts.samples, counts.samples ? static_cast<double>(counts.bytes) / (counts.samples + counts.skipped) : 0.0,
+        counts.skipped, counts.corrupt);
+
+    return 0;
+}
@@ -0,0 +1,456 @@
+// Safe guards
+#ifndef LOGFILE_H
+#define LOGFILE_H
+
+/*-------------------------------------------------------------------------------------------------
+ Host access to ECU log sessions - memory mapped channel logs decoded in one streaming pass
+ (shared by the host decode and analysis tools)
+-------------------------------------------------------------------------------------------------*/
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "daq/channel.h"
+#include "daq/sessionfile.h"
+#include "daq/tracefile.h"
+
+/*------------------------------------------
+ Macros - Log Files
+------------------------------------------*/
+#define LOGFILE_NAME_SIZE        32
+#define LOGFILE_RELEASE_SIZE     (64UL * 1024 * 1024) // Decoded pages handed back to the kernel at a time
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+typedef struct logCounts {
+    uint64_t samples;
+    uint64_t skipped;     // Records before the first keyframe of a buffer
+    uint64_t corrupt;     // Buffers abandoned at a bad record
+    uint64_t bytes;       // Record bytes (padding excluded)
+    uint64_t files;
+    uint64_t frames;      // CAN trace records
+    uint64_t dropped;     // Frames missing from the trace sequence
+} logCounts_t;
+
+// One power cycle - the session file and the logs found next to it
+typedef struct logSession {
+    std::string path;
+    sessionFileHeader_t header;
+    std::vector<sessionIndexEntry_t> entries;
+    std::vector<std::string> datalogs;    // SnnnnnLmmm.BIN in file order (stops at the first gap)
+    std::vector<std::string> traces;      // SnnnnnTmmm.BIN in file order
+} logSession_t;
+
+// Called for every decoded sample - values are in channel order of the file header
+typedef std::function<void(uint64_t time, const int32_t * pValues)> logSampleHandler_t;
+
+// Called for every traced CAN frame - time is the ECU time (us) it finished on the bus
+typedef std::function<void(uint64_t time, const traceRecord_t & record)> logFrameHandler_t;
+
+/*-------------------------------------------------------------------------------------------------
+ Read only memory mapping of a whole file (pages are only read when touched)
+-------------------------------------------------------------------------------------------------*/
+class mappedFile {
+    public:
+        // Constructor
+        mappedFile(void) : pData(nullptr), size(0) {}
+        ~mappedFile(void) { Close(); }
+
+        mappedFile(const mappedFile &) = delete;
+        mappedFile & operator=(const mappedFile &) = delete;
+
+        // Getters
+        const uint8_t * GetData(void) const { return pData; }
+        uint64_t GetSize(void) const { return size; }
+
+        // Data methods
+        bool Open(const char * pPath);
+        void Close(void);
+        void Release(uint64_t offset, uint64_t length) const;
+
+    private:
+        const uint8_t * pData;
+        uint64_t size;
+};
+
+/*-----------------------------------------------------------------------------
+ Map a file for sequential reading - Returns false if it cannot be mapped
+-----------------------------------------------------------------------------*/
+inline bool mappedFile::Open(const char * pPath) {
+    struct stat status;
+    int descriptor = open(pPath, O_RDONLY);
+
+    Close();
+
+    if (descriptor < 0) {
+        return false;
+    }
+
+    if ( fstat(descriptor, &status) != 0 || status.st_size == 0 ) {
+        close(descriptor);
+        return false;
+    }
+
+    void * pMap = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+    // The mapping keeps its own reference to the file
+    close(descriptor);
+
+    if (pMap == MAP_FAILED) {
+        return false;
+    }
+
+    pData = static_cast<const uint8_t *>(pMap);
+    size = status.st_size;
+
+    // Read ahead aggressively and drop pages behind the decoder
+    madvise(pMap, size, MADV_SEQUENTIAL);
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Unmap the file
+-----------------------------------------------------------------------------*/
+inline void mappedFile::Close(void) {
+    if (pData) {
+        munmap( const_cast<uint8_t *>(pData), size );
+    }
+
+    pData = nullptr;
+    size = 0;
+}
+
+/*-----------------------------------------------------------------------------
+ Tell the kernel a decoded range will not be read again (keeps resident memory flat)
+-----------------------------------------------------------------------------*/
+inline void mappedFile::Release(uint64_t offset, uint64_t length) const {
+    uint64_t page = sysconf(_SC_PAGESIZE);
+    uint64_t start = (offset + page - 1) / page * page;
+    uint64_t end = (offset + length > size) ? size : offset + length;
+
+    if (end > start) {
+        madvise(const_cast<uint8_t *>(pData) + start, (end - start) / page * page, MADV_DONTNEED);
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ Check the first sector of a channel log - Returns the header or nullptr if invalid
+-----------------------------------------------------------------------------*/
+inline const channelFileHeader_t * GetChannelHeader(const mappedFile & file) {
+    const channelFileHeader_t * pHeader = reinterpret_cast<const channelFileHeader_t *>( file.GetData() );
+
+    if ( file.GetSize() < sizeof(channelFileHeader_t) || memcmp(pHeader->magic, CHANNEL_MAGIC, sizeof(CHANNEL_MAGIC)) ||
+        pHeader->version != CHANNEL_VERSION || pHeader->numChannels > CHANNEL_MAX_CHANNELS || !pHeader->bufferSectors ) {
+        return nullptr;
+    }
+
+    return pHeader;
+}
+
+/*-----------------------------------------------------------------------------
+ Number of logger buffers in a channel log (the last may be cut short)
+-----------------------------------------------------------------------------*/
+inline uint64_t GetBufferCount(const mappedFile & file, const channelFileHeader_t & header) {
+    uint64_t bufferSize = static_cast<uint64_t>(header.bufferSectors) * CHANNEL_HEADER_SIZE;
+
+    return (file.GetSize() - CHANNEL_HEADER_SIZE + bufferSize - 1) / bufferSize;
+}
+
+/*-----------------------------------------------------------------------------
+ Time of the keyframe starting a buffer - Returns false if the buffer does not start with one
+-----------------------------------------------------------------------------*/
+inline bool GetBufferTime(const mappedFile & file, const channelFileHeader_t & header, uint64_t buffer, uint64_t & time) {
+    uint64_t bufferSize = static_cast<uint64_t>(header.bufferSectors) * CHANNEL_HEADER_SIZE;
+    uint64_t offset = CHANNEL_HEADER_SIZE + buffer * bufferSize;
+    channelDecoder decoder(header.numChannels);
+    uint32_t length = 0;
+
+    if (offset >= file.GetSize()) {
+        return false;
+    }
+
+    uint64_t end = (offset + bufferSize > file.GetSize()) ? file.GetSize() : offset + bufferSize;
+
+    if ( decoder.Decode(file.GetData() + offset, file.GetData() + end, length) != channelRecord::SAMPLE ) {
+        return false;
+    }
+
+    time = decoder.GetTime();
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Find the last buffer that starts at or before a time - Returns the buffer index
+-----------------------------------------------------------------------------*/
+inline uint64_t SeekChannelLog(const mappedFile & file, const channelFileHeader_t & header, uint64_t time) {
+    uint64_t low = 0;
+    uint64_t high = GetBufferCount(file, header);
+
+    // Keyframe time of each buffer increases through the file
+    while (low + 1 < high) {
+        uint64_t middle = (low + high) / 2;
+        uint64_t middleTime = 0;
+
+        if ( GetBufferTime(file, header, middle, middleTime) && middleTime <= time ) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+/*-----------------------------------------------------------------------------
+ Decode a mapped channel log from a buffer (numBuffers of them, default to the end), skipping samples
+ before a time - Returns false if invalid
+-----------------------------------------------------------------------------*/
+inline bool DecodeChannelLog(const mappedFile & file, uint64_t firstBuffer, uint64_t startTime, logCounts_t & counts,
+    const logSampleHandler_t & onSample, uint64_t numBuffers = UINT64_MAX) {
+    const channelFileHeader_t * pHeader = GetChannelHeader(file);
+
+    if (!pHeader) {
+        return false;
+    }
+
+    uint64_t bufferSize = static_cast<uint64_t>(pHeader->bufferSectors) * CHANNEL_HEADER_SIZE;
+    uint64_t released = 0;
+    uint64_t end = file.GetSize();
+
+    if (numBuffers != UINT64_MAX && CHANNEL_HEADER_SIZE + (firstBuffer + numBuffers) * bufferSize < end) {
+        end = CHANNEL_HEADER_SIZE + (firstBuffer + numBuffers) * bufferSize;
+    }
+
+    ++counts.files;
+
+    for (uint64_t offset = CHANNEL_HEADER_SIZE + firstBuffer * bufferSize; offset < end; offset += bufferSize) {
+        // Buffers decode on their own - a dropped buffer only loses its own samples
+        channelDecoder decoder(pHeader->numChannels);
+        const uint8_t * pRecord = file.GetData() + offset;
+        const uint8_t * pEnd = file.GetData() + ( (offset + bufferSize > file.GetSize()) ? file.GetSize() : offset + bufferSize );
+
+        while (pRecord < pEnd) {
+            uint32_t length = 0;
+            channelRecord result = decoder.Decode(pRecord, pEnd, length);
+
+            if (result == channelRecord::PADDING) {
+                break;
+            }
+
+            if (result == channelRecord::CORRUPT) {
+                ++counts.corrupt;
+                break;
+            }
+
+            pRecord += length;
+
+            if (result == channelRecord::UNSYNCED) {
+                counts.bytes += length;
+                ++counts.skipped;
+                continue;
+            }
+
+            if (decoder.GetTime() < startTime) {
+                continue;
+            }
+
+            counts.bytes += length;
+            ++counts.samples;
+
+            onSample( decoder.GetTime(), decoder.GetValues() );
+        }
+
+        if (offset + bufferSize - released >= LOGFILE_RELEASE_SIZE) {
+            file.Release(released, offset + bufferSize - released);
+            released = offset + bufferSize;
+        }
+    }
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Decode a mapped CAN trace - Returns false if it is not a trace file
+-----------------------------------------------------------------------------*/
+inline bool DecodeTrace(const mappedFile & file, logCounts_t & counts, const logFrameHandler_t & onFrame) {
+    const traceFileHeader_t * pHeader = reinterpret_cast<const traceFileHeader_t *>( file.GetData() );
+
+    if ( file.GetSize() < sizeof(traceFileHeader_t) || memcmp(pHeader->magic, TRACE_MAGIC, sizeof(pHeader->magic)) ||
+        pHeader->version != TRACE_VERSION || pHeader->recordSize != TRACE_RECORD_SIZE ) {
+        return false;
+    }
+
+    // micros() stamps widen against the file's ECU time like TimebaseHandler::ExtendTime
+    uint64_t time = pHeader->startEpoch;
+    uint32_t previous = static_cast<uint32_t>(pHeader->startEpoch);
+    uint16_t sequences[2] = {0, 0};
+    bool bSequenceValid[2] = {false, false};
+    uint64_t released = 0;
+
+    ++counts.files;
+
+    for (uint64_t offset = TRACE_BLOCK_SIZE; offset + sizeof(traceRecord_t) <= file.GetSize(); offset += sizeof(traceRecord_t)) {
+        traceRecord_t record;
+
+        memcpy(&record, file.GetData() + offset, sizeof(record));
+
+        // Rest of a buffer written out before it filled
+        if (record.header == TRACE_PADDING) {
+            continue;
+        }
+
+        // Preallocated space past the last sync
+        if ( (record.header >> TRACE_LEN_SHIFT) > 8 ) {
+            break;
+        }
+
+        bool bTransmit = (record.header >> TRACE_TX_BIT) & 0x01;
+
+        // Buffers of the two directions interleave, so allow small steps backwards
+        time += static_cast<int32_t>(record.timestamp - previous);
+        previous = record.timestamp;
+
+        // Gaps in a direction's sequence are frames dropped by the recorder
+        if (bSequenceValid[bTransmit]) {
+            counts.dropped += static_cast<uint16_t>(record.sequence - sequences[bTransmit] - 1);
+        }
+
+        sequences[bTransmit] = record.sequence;
+        bSequenceValid[bTransmit] = true;
+        ++counts.frames;
+
+        onFrame(time, record);
+
+        if (offset - released >= LOGFILE_RELEASE_SIZE) {
+            file.Release(released, offset - released);
+            released = offset;
+        }
+    }
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Check a path names a stream file with its header - the ECU creates the next file ahead
+ and leaves it empty until the current one is full
+-----------------------------------------------------------------------------*/
+inline bool GetFileStarted(const std::string & path) {
+    struct stat status;
+
+    return stat(path.c_str(), &status) == 0 && S_ISREG(status.st_mode) && status.st_size >= SESSION_SECTOR_SIZE;
+}
+
+/*-----------------------------------------------------------------------------
+ Path of a numbered session file next to the session file
+-----------------------------------------------------------------------------*/
+inline std::string GetSessionPath(const std::string & sessionPath, const char * pFormat, uint32_t session, uint32_t file) {
+    size_t slash = sessionPath.find_last_of('/');
+    char name[LOGFILE_NAME_SIZE];
+
+    snprintf(name, sizeof(name), pFormat, session, file);
+
+    return ( (slash == std::string::npos) ? std::string() : sessionPath.substr(0, slash + 1) ) + name;
+}
+
+/*-----------------------------------------------------------------------------
+ Load a session header, its written index entries and its log names - Returns false if invalid
+-----------------------------------------------------------------------------*/
+inline bool LoadSession(const char * pPath, logSession_t & session) {
+    mappedFile file;
+
+    if ( !file.Open(pPath) || file.GetSize() < sizeof(sessionFileHeader_t) ) {
+        fprintf(stderr, "cannot open session %s\n", pPath);
+        return false;
+    }
+
+    memcpy(&session.header, file.GetData(), sizeof(session.header));
+
+    if ( memcmp(session.header.magic, SESSION_MAGIC, sizeof(SESSION_MAGIC)) || session.header.version != SESSION_VERSION ||
+        !session.header.buffersPerFile ) {
+        fprintf(stderr, "%s is not a version %u session file\n", pPath, SESSION_VERSION);
+        return false;
+    }
+
+    session.path = pPath;
+    session.entries.clear();
+    session.datalogs.clear();
+    session.traces.clear();
+
+    // The last sector is padded with unused entries until it fills
+    for (uint64_t offset = SESSION_SECTOR_SIZE; offset + sizeof(sessionIndexEntry_t) <= file.GetSize(); offset += sizeof(sessionIndexEntry_t)) {
+        sessionIndexEntry_t entry;
+
+        memcpy(&entry, file.GetData() + offset, sizeof(entry));
+
+        if (entry.time == UINT64_MAX) {
+            break;
+        }
+
+        session.entries.push_back(entry);
+    }
+
+    for (uint32_t index = 0; ; ++index) {
+        std::string path = GetSessionPath(session.path, SESSION_DATALOG_NAME, session.header.session, index);
+
+        if ( !GetFileStarted(path) ) {
+            break;
+        }
+
+        session.datalogs.push_back(path);
+    }
+
+    for (uint32_t index = 0; ; ++index) {
+        std::string path = GetSessionPath(session.path, SESSION_TRACE_NAME, session.header.session, index);
+
+        if ( !GetFileStarted(path) ) {
+            break;
+        }
+
+        session.traces.push_back(path);
+    }
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Decode the channel logs of a session from an offset after its start (0 - everything)
+ Returns false if a channel log is invalid
+-----------------------------------------------------------------------------*/
+inline bool DecodeSession(const logSession_t & session, uint64_t offset, logCounts_t & counts, const logSampleHandler_t & onSample) {
+    const sessionFileHeader_t & header = session.header;
+    uint64_t startTime = offset ? header.startEpoch + offset : 0;
+    uint64_t buffer = 0;
+
+    // Last indexed buffer starting at or before the time (later buffers are found by decoding)
+    for (const sessionIndexEntry_t & entry : session.entries) {
+        if (offset && entry.time <= startTime) {
+            buffer = entry.buffer;
+        }
+    }
+
+    for (size_t index = buffer / header.buffersPerFile; index < session.datalogs.size(); ++index) {
+        mappedFile file;
+        uint64_t first = (index == buffer / header.buffersPerFile) ? buffer % header.buffersPerFile : 0;
+
+        if ( !file.Open( session.datalogs[index].c_str() ) || !DecodeChannelLog(file, first, startTime, counts, onSample) ) {
+            fprintf(stderr, "%s is not a channel log\n", session.datalogs[index].c_str());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// End safe guards
+#endif /* LOGFILE_H */
@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+"""
+Host client for the ECU file service (ISO-TP over CAN, Linux SocketCAN).
+
+Usage: ecufile.py [-i can0] [-t timeout] ls
+       ecufile.py [-i can0] [-t timeout] get <remote> [local]
+       ecufile.py [-i can0] [-t timeout] put <local> [remote]
+       ecufile.py [-i can0] [-t timeout] crc <remote>
+
+Transfers are split into requests that fit one ISO-TP message and checked
+against the ECU's CRC-32 when complete. The kernel ISO-TP stack (can-isotp,
+mainline since 5.10) handles segmentation and flow control. To test without a
+car, bridge the host replay build to a virtual bus:
+
+    sudo ip link add dev vcan0 type vcan && sudo ip link set up vcan0
+    .pio/build/native/program -c vcan0 -s <sd_dir> -q &
+    tools/isotp/ecufile.py -i vcan0 ls
+"""
+import argparse
+import os
+import socket
+import struct
+import sys
+import zlib
+
+ID_TRANSPORT_REQUEST = 0x7F0
+ID_TRANSPORT_RESPONSE = 0x7F8
+TRANSPORT_MAX_LENGTH = 4095
+TRANSPORT_PADDING = 0xCC
+
+FILE_CMD_LIST = 0x01
+FILE_CMD_READ = 0x02
+FILE_CMD_WRITE = 0x03
+FILE_CMD_CRC = 0x04
+FILE_CMD_RESPONSE = 0x40
+FILE_WRITE_TRUNCATE = 0x01
+
+FILE_MAX_READ = TRANSPORT_MAX_LENGTH - 6
+
+STATUS_TEXT = {
+    0x01: 'not found',
+    0x02: 'bad request',
+    0x03: 'SD card error',
+}
+
+# linux/can/isotp.h
+SOL_CAN_ISOTP = 106
+CAN_ISOTP_OPTS = 1
+CAN_ISOTP_TX_PADDING = 0x004
+
+
+class FileServiceError(Exception):
+    pass
+
+
+class FileClient:
+    def __init__(self, interface, timeout):
+        if not hasattr(socket, 'CAN_ISOTP'):
+            raise FileServiceError('this Python has no SocketCAN ISO-TP support')
+
+        self.sock = socket.socket(socket.AF_CAN, socket.SOCK_DGRAM, socket.CAN_ISOTP)
+        self.sock.setsockopt(SOL_CAN_ISOTP, CAN_ISOTP_OPTS,
+                             struct.pack('=IIBBBB', CAN_ISOTP_TX_PADDING, 0, 0,
+                                         TRANSPORT_PADDING, 0, 0))
+        self.sock.bind((interface, ID_TRANSPORT_RESPONSE, ID_TRANSPORT_REQUEST))
+        self.sock.settimeout(timeout)
+
+    def request(self, command, payload):
+        message = bytes([command]) + payload
+        if len(message) > TRANSPORT_MAX_LENGTH:
+            raise FileServiceError('request too long')
+
+        self.sock.send(message)
+
+        try:
+            response = self.sock.recv(TRANSPORT_MAX_LENGTH)
+        except socket.timeout:
+            raise FileServiceError('no response from the ECU')
+
+        if len(response) < 2 or response[0] != command | FILE_CMD_RESPONSE:
+            raise FileServiceError('unexpected response %s' % response[:8].hex())
+        if response[1]:
+            raise FileServiceError(STATUS_TEXT.get(response[1], 'status %d' % response[1]))
+
+        return response[2:]
+
+    def list(self):
+        files = []
+
+        # Each response holds as many entries as fit - ask again from the next index
+        while True:
+            body = self.request(FILE_CMD_LIST, struct.pack('<H', len(files)))
+            (count,) = struct.unpack_from('<H', body)
+            offset = 2
+
+            for _ in range(count):
+                size, length = struct.unpack_from('<IB', body, offset)
+                name = body[offset + 5:offset + 5 + length].decode('ascii', 'replace')
+                files.append((name, size))
+                offset += 5 + length
+
+            if count == 0:
+                return files
+
+    def crc(self, name):
+        body = self.request(FILE_CMD_CRC, name.encode('ascii') + b'\0')
+        return struct.unpack_from('<II', body)
+
+    def read(self, name, progress=None):
+        data = bytearray()
+
+        while True:
+            body = self.request(FILE_CMD_READ, struct.pack('<IH', len(data), FILE_MAX_READ) +
+                                name.encode('ascii') + b'\0')
+            (offset,) = struct.unpack_from('<I', body)
+            if offset != len(data):
+                raise FileServiceError('read returned offset %d, expected %d' % (offset, len(data)))
+
+            chunk = body[4:]
+            if not chunk:
+                break
+
+            data += chunk
+            if progress:
+                progress(len(data))
+
+        size, crc = self.crc(name)
+        if size != len(data) or crc != zlib.crc32(data):
+            raise FileServiceError('CRC mismatch reading %s' % name)
+
+        return bytes(data)
+
+    def write(self, name, data, progress=None):
+        header = 6 + len(name) + 1
+        chunk = TRANSPORT_MAX_LENGTH - header
+        offset = 0
+
+        # Truncate on the first request so an empty file is also written
+        while True:
+            flags = FILE_WRITE_TRUNCATE if offset == 0 else 0
+            piece = data[offset:offset + chunk]
+            body = self.request(FILE_CMD_WRITE, struct.pack('<IB', offset, flags) +
+                                name.encode('ascii') + b'\0' + piece)
+            offset += len(piece)
+
+            (size,) = struct.unpack_from('<I', body)
+            if size != offset:
+                raise FileServiceError('file is %d bytes after writing %d' % (size, offset))
+            if progress:
+                progress(offset)
+            if offset >= len(data):
+                break
+
+        size, crc = self.crc(name)
+        if size != len(data) or crc != zlib.crc32(data):
+            raise FileServiceError('CRC mismatch writing %s' % name)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='ECU SD card file service over ISO-TP')
+    parser.add_argument('-i', '--interface', default='can0')
+    parser.add_argument('-t', '--timeout', type=float, default=2.0,
+                        help='seconds to wait for each response')
+    commands = parser.add_subparsers(dest='command', required=True)
+    commands.add_parser('ls')
+    get = commands.add_parser('get')
+    get.add_argument('remote')
+    get.add_argument('local', nargs='?')
+    put = commands.add_parser('put')
+    put.add_argument('local')
+    put.add_argument('remote', nargs='?')
+    crc = commands.add_parser('crc')
+    crc.add_argument('remote')
+    args = parser.parse_args()
+
+    def progress(count):
+        sys.stderr.write('\r%d bytes' % count)
+
+    try:
+        client = FileClient(args.interface, args.timeout)
+
+        if args.command == 'ls':
+            for name, size in client.list():
+                print('%10d  %s' % (size, name))
+        elif args.command == 'get':
+            data = client.read(args.remote, progress)
+            with open(args.local or os.path.basename(args.remote), 'wb') as local:
+                local.write(data)
+            sys.stderr.write('\n')
+        elif args.command == 'put':
+            with open(args.local, 'rb') as local:
+                data = local.read()
+            client.write(args.remote or os.path.basename(args.local), data, progress)
+            sys.stderr.write('\n')
+        elif args.command == 'crc':
+            size, value = client.crc(args.remote)
+            print('%08x  %d  %s' % (value, size, args.remote))
+    except (FileServiceError, OSError) as error:
+        sys.stderr.write('ecufile: %s\n' % error)
+        return 1
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
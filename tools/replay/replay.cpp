@@ -0,0 +1,809 @@
+/*-------------------------------------------------------------------------------------------------
+ Host CAN Trace Replay
+ Feeds the SnnnnnTmmm.BIN trace files recorded by the ECU back through the receive callback of each frame's
+ routed bus and the main loop on a virtual clock. Every frame the firmware sends is printed so runs
+ of two builds can be diffed (frames bridged between the buses are printed as FW).
+
+ Build: pio run -e native
+ Usage: .pio/build/native/program [-s sd_root] [-p loop_us] [-a pin=value] [-d pin=value] [-q]
+            S00001T000.BIN [S00001T001.BIN ...]
+        .pio/build/native/program -c can_interface [-s sd_root] [-a pin=value] [-d pin=value] [-q]
+        .pio/build/native/program -f seconds [-x scale] [-s sd_root] [-a pin=value] [-d pin=value]
+   -c  Bridge the firmware to a SocketCAN interface in real time instead of replaying (Linux only,
+       e.g. vcan0 for testing tools/isotp/ecufile.py)
+   -f  Flood the receive path with 100 % bus load for this many virtual seconds of driving and check
+       the main loop period, Bamocar response handling and torque commands stay inside their budgets,
+       every frame reaches the ISRs, rate limited IDs sent too fast are rejected and slow handler
+       periods are deferred to the loop (exit code 1 if not). The pedal calibration is seeded in
+       EEPROM, so no SD files are needed, and the driver inputs (SDC tap, brake, RTD button and a
+       stepped throttle) are scripted, so -a/-d values for those pins are overridden
+   -x  Cycle counter scale - host cycles are multiplied by this to estimate a slower target
+   -s  Directory used as the SD card (config_import.csv is read and the replay's own trace written here)
+   -p  Virtual time between main loop iterations in us (default 100)
+   -a  Analog input value seen by analogRead (repeatable)
+   -d  Digital input value seen by digitalRead (repeatable)
+   -q  Only print the summary
+-------------------------------------------------------------------------------------------------*/
+#include <getopt.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <linux/can.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "core/ECU.h"
+
+/*------------------------------------------
+ Macros - Replay
+------------------------------------------*/
+#define REPLAY_LOOP_PERIOD       100 // Virtual time per loop() call (us)
+
+/*------------------------------------------
+ Macros - RX Flood Benchmark
+------------------------------------------*/
+#define FLOOD_FRAME_US           (STATS_FRAME_BITS(8) * 1000000 / BAUD_RATE) // Back to back frames
+#define FLOOD_RESPONSE_INTERVAL  20    // Every nth bus slot is a genuine Bamocar speed response
+#define FLOOD_RX_QUEUE           256   // Frames the FlexCAN_T4 RX queue holds (RX_SIZE_256)
+#define FLOOD_WARMUP             100000 // Time in DRIVE left out of the results (us)
+#define FLOOD_START_LIMIT        20000000 // Virtual time allowed for the FSM to reach DRIVE (us)
+#define FLOOD_LOOP_BUDGET        1000  // Worst main loop period allowed (us)
+#define FLOOD_RESPONSE_BUDGET    2000  // Worst Bamocar response to decoded speed time allowed (us)
+#define FLOOD_TORQUE_BUDGET      (TORQUE_KEEPALIVE_TIME * 1000 + FLOOD_LOOP_BUDGET) // Worst torque frame gap (us)
+#define FLOOD_CONTROL_BUDGET     5000  // Worst throttle step to changed torque frame time allowed (us)
+#define FLOOD_SLOW_PERIOD        200000 // Slow receive handlers every other period of the results (us)
+#define FLOOD_SLOW_ISR_US        150   // Extra time of each frame handled in the ISRs while slow (us)
+#define FLOOD_FILTERED_ID        0x100 // Babbling ID the acceptance filters must drop
+#define FLOOD_PEDAL_UPPER        900   // Raw calibration seeded for every pedal sensor
+#define FLOOD_PEDAL_LOWER        100
+#define FLOOD_APPS_HIGH          700   // Raw throttle levels the driver steps between (~75 % and ~37 %)
+#define FLOOD_APPS_LOW           400
+#define FLOOD_APPS_STEP          100000 // Time between throttle steps (us)
+#define FLOOD_RTD_PULSE          50000 // RTD button press and release time (us)
+#define FLOOD_SDC_TAP            1023  // Closed shutdown circuit
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+typedef struct replayRecord {
+    uint64_t time;        // Unwrapped micros()
+    traceRecord_t record;
+} replayRecord_t;
+
+typedef struct replayCounts {
+    uint32_t recorded;    // TX frames in the trace
+    uint32_t replayed;    // TX frames sent by this build
+} replayCounts_t;
+
+// Firmware entry points (main.cpp)
+void setup(void);
+void loop(void);
+
+extern systemVehicle vehicle;
+
+static std::map<uint32_t, replayCounts_t> txCounts;
+static bool bQuiet = false;
+static int bridgeSocket = -1;
+
+// Torque command timing (flood benchmark)
+static uint64_t lastTorqueTime = 0;
+static uint64_t torqueGapMaximum = 0;
+static uint32_t torqueCount = 0;
+static uint16_t lastTorque = 0;
+
+// Throttle step to torque frame timing (flood benchmark)
+static uint64_t stepTime = 0;
+static uint16_t stepTorque = 0;
+static bool bStepUp = false;
+static bool bStepPending = false;
+static uint64_t stepMaximum = 0;
+static uint32_t stepCount = 0;
+static uint32_t stepsMissed = 0;
+
+/*-----------------------------------------------------------------------------
+ Print a frame as "<time us> <RX|TX> <id> <len> <data...>"
+-----------------------------------------------------------------------------*/
+static void PrintFrame(uint64_t time, const char * pDirection, uint32_t id, uint8_t len, const uint8_t * pBuf) {
+    printf("%llu %s %03X %u", static_cast<unsigned long long>(time), pDirection, id, len);
+
+    for (uint8_t index = 0; index < len; ++index) {
+        printf(" %02X", pBuf[index]);
+    }
+
+    printf("\n");
+}
+
+/*-----------------------------------------------------------------------------
+ Capture every frame the firmware writes to the bus
+-----------------------------------------------------------------------------*/
+static void ReplayTransmit(uint8_t bus, const CAN_message_t & message) {
+    // Frames bridged off their own bus were traced as RX, not TX
+    bool bForwarded = (bus == CAN1) && !(RoutingHandler::GetBuses(message.id) & CAN_BUS_TELEMETRY);
+
+    if (!bForwarded) {
+        ++txCounts[message.id].replayed;
+    }
+
+    if (message.id == ID_CAN_MESSAGE_RX && message.buf[0] == REG_DIG_TORQUE_SET) {
+        torqueGapMaximum = (torqueCount && replayMicros - lastTorqueTime > torqueGapMaximum) ?
+            replayMicros - lastTorqueTime : torqueGapMaximum;
+        lastTorqueTime = replayMicros;
+        lastTorque = message.buf[BAMOCAR_VALUE_OFFSET] | (message.buf[BAMOCAR_VALUE_OFFSET + 1] << 8);
+        ++torqueCount;
+
+        // First command that moved towards the new throttle since the step
+        if ( bStepPending && (bStepUp ? lastTorque > stepTorque : lastTorque < stepTorque) ) {
+            stepMaximum = std::max<uint64_t>(stepMaximum, replayMicros - stepTime);
+            ++stepCount;
+            bStepPending = false;
+        }
+    }
+
+    if (!bQuiet) {
+        PrintFrame(replayMicros, bForwarded ? "FW" : "TX", message.id, message.len, message.buf);
+    }
+
+#ifdef __linux__
+    // The interface stands in for both buses - a bridged copy would be a duplicate
+    if (bridgeSocket >= 0 && !bForwarded) {
+        struct can_frame frame = {};
+
+        frame.can_id = message.id;
+        frame.can_dlc = message.len;
+        memcpy(frame.data, message.buf, message.len);
+
+        if ( write(bridgeSocket, &frame, sizeof(frame)) != sizeof(frame) ) {
+            perror("replay: bridge write");
+        }
+    }
+#endif
+}
+
+/*-----------------------------------------------------------------------------
+ Deliver a frame to the receive interrupt of the bus it is routed on - Returns false if filtered
+-----------------------------------------------------------------------------*/
+static bool DeliverFrame(CAN_message_t & message) {
+    CAN_DEV_TABLE bus = (RoutingHandler::GetBuses(message.id) & CAN_BUS_CONTROL) ? CAN3 : CAN1;
+
+    // Single bus builds only register the control bus
+    bus = replayReceive[bus] ? bus : CAN3;
+
+    // The controller's acceptance filters drop the frame without an interrupt
+    if ( !replayReceive[bus] || !ReplayAccepts(bus, message.id) ) {
+        return false;
+    }
+
+    message.bus = (bus == CAN3) ? 3 : 1;
+    message.timestamp = FLEXCANb_TIMER(bus);
+    replayReceive[bus](message);
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Print the decoded Bamocar telemetry (catches decoding regressions)
+-----------------------------------------------------------------------------*/
+static void PrintTelemetry(void) {
+    bamocarTelemetry_t telemetry = TelemetryHandler::GetTelemetry();
+
+    printf("%llu TEL %d %d %d %d %d %d\n", static_cast<unsigned long long>(replayMicros),
+        telemetry.motorTemperature.value, telemetry.bamocarTemperature.value, telemetry.speed.value,
+        telemetry.phaseCurrent[0].value, telemetry.phaseCurrent[1].value, telemetry.phaseCurrent[2].value);
+}
+
+/*-----------------------------------------------------------------------------
+ Load the records of one trace file - Returns false if the file is invalid
+-----------------------------------------------------------------------------*/
+static bool LoadTrace(const char * pPath, std::vector<replayRecord_t> & records, uint64_t & time,
+    uint32_t & previous, uint16_t * pSequences, bool * pSequenceValid, uint32_t & dropped) {
+    traceFileHeader_t header;
+    traceRecord_t record;
+    FILE * pFile = fopen(pPath, "rb");
+
+    if (!pFile) {
+        fprintf(stderr, "replay: cannot open %s\n", pPath);
+        return false;
+    }
+
+    if ( fread(&header, sizeof(header), 1, pFile) != 1 || memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) ||
+        header.version != TRACE_VERSION || header.recordSize != TRACE_RECORD_SIZE ) {
+        fprintf(stderr, "replay: %s is not a version %u CAN trace\n", pPath, TRACE_VERSION);
+        fclose(pFile);
+        return false;
+    }
+
+    while ( fread(&record, sizeof(record), 1, pFile) == 1 ) {
+        uint8_t len = record.header >> TRACE_LEN_SHIFT;
+        bool bTransmit = (record.header >> TRACE_TX_BIT) & 0x01;
+
+        // Rest of a buffer written out before it filled
+        if (record.header == TRACE_PADDING) {
+            continue;
+        }
+
+        // Preallocated space past the last sync
+        if (len > 8) {
+            break;
+        }
+
+        // Blocks of the two directions interleave, so allow small steps backwards
+        time = records.empty() ? record.timestamp : time + static_cast<int32_t>(record.timestamp - previous);
+        previous = record.timestamp;
+
+        // Gaps in a direction's sequence are frames dropped by the recorder
+        if (pSequenceValid[bTransmit]) {
+            dropped += static_cast<uint16_t>(record.sequence - pSequences[bTransmit] - 1);
+        }
+
+        pSequences[bTransmit] = record.sequence;
+        pSequenceValid[bTransmit] = true;
+
+        records.push_back( {time, record} );
+    }
+
+    fclose(pFile);
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Parse a "pin=value" option into a pin table
+-----------------------------------------------------------------------------*/
+template <typename T>
+static bool SetPin(const char * pOption, T * pPins) {
+    unsigned pin;
+    unsigned value;
+
+    if (sscanf(pOption, "%u=%u", &pin, &value) != 2 || pin >= REPLAY_NUM_PINS) {
+        fprintf(stderr, "replay: expected pin=value, got %s\n", pOption);
+        return false;
+    }
+
+    pPins[pin] = static_cast<T>(value);
+
+    return true;
+}
+
+/*-----------------------------------------------------------------------------
+ Run the firmware against a live SocketCAN interface on the wall clock
+-----------------------------------------------------------------------------*/
+static int RunBridge(const char * pInterface) {
+#ifdef __linux__
+    struct sockaddr_can address = {};
+    struct ifreq request = {};
+    struct timespec now;
+
+    bridgeSocket = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    strncpy(request.ifr_name, pInterface, IFNAMSIZ - 1);
+
+    if ( bridgeSocket < 0 || ioctl(bridgeSocket, SIOCGIFINDEX, &request) < 0 ) {
+        perror("replay: bridge");
+        return 1;
+    }
+
+    address.can_family = AF_CAN;
+    address.can_ifindex = request.ifr_ifindex;
+
+    if ( bind(bridgeSocket, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) < 0 ) {
+        perror("replay: bridge bind");
+        return 1;
+    }
+
+    fprintf(stderr, "replay: bridging to %s (Ctrl+C to stop)\n", pInterface);
+
+    replayTransmit = ReplayTransmit;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    replayMicros = now.tv_sec * 1000000ULL + now.tv_nsec / 1000;
+    setup();
+
+    while (true) {
+        struct pollfd descriptor = {bridgeSocket, POLLIN, 0};
+
+        // Follow the wall clock (delay() in the firmware moves the clock on by itself)
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        replayMicros = std::max<uint64_t>(replayMicros, now.tv_sec * 1000000ULL + now.tv_nsec / 1000);
+
+        while ( poll(&descriptor, 1, 0) > 0 ) {
+            struct can_frame frame;
+
+            if ( read(bridgeSocket, &frame, sizeof(frame)) != sizeof(frame) || (frame.can_id & CAN_EFF_FLAG) ) {
+                continue;
+            }
+
+            CAN_message_t message;
+            message.id = frame.can_id & CAN_SFF_MASK;
+            message.len = (frame.can_dlc > 8) ? 8 : frame.can_dlc;
+            memcpy(message.buf, frame.data, message.len);
+
+            if (!bQuiet) {
+                PrintFrame(replayMicros, "RX", message.id, message.len, message.buf);
+            }
+
+            DeliverFrame(message);
+        }
+
+        loop();
+
+        // Roughly the loop rate of the car without spinning a host core
+        usleep(REPLAY_LOOP_PERIOD);
+    }
+#else
+    (void)pInterface;
+    fprintf(stderr, "replay: bridge mode needs Linux SocketCAN\n");
+    return 2;
+#endif
+}
+
+/*-----------------------------------------------------------------------------
+ Build the frame on the bus in a flood benchmark slot
+-----------------------------------------------------------------------------*/
+static void MakeFloodFrame(uint32_t slot, CAN_message_t & message, int16_t & speed) {
+    message = CAN_message_t();
+    message.len = 8;
+
+    for (uint8_t index = 0; index < message.len; ++index) {
+        message.buf[index] = static_cast<uint8_t>(slot * 31 + index);
+    }
+
+    // Genuine response carrying a new speed (at least 1 RPM apart) so its handling can be timed
+    if (slot % FLOOD_RESPONSE_INTERVAL == 0) {
+        int16_t raw = static_cast<int16_t>( ((slot / FLOOD_RESPONSE_INTERVAL) % 4000 + 1) * 8 );
+
+        speed = static_cast<int16_t>( static_cast<int32_t>(raw) * BAMOCAR_SPEED_MAX_RPM / BAMOCAR_FULL_SCALE );
+        message.id = ID_CAN_MESSAGE_TX;
+        message.len = PAR_RX_DLC;
+        message.buf[0] = REG_SPEED_FILTERED;
+        message.buf[1] = raw & 0xFF;
+        message.buf[2] = raw >> 8;
+        return;
+    }
+
+    // Babbling nodes - accepted IDs first (every one past its rate limit), then one the filters must drop
+    switch (slot % 6) {
+        case (0):
+        case (3):
+            message.id = ID_CAN_MESSAGE_TX;
+            message.len = PAR_RX_DLC;
+            message.buf[0] = REG_MOTOR_TEMP;
+            break;
+
+        case (1):
+            message.id = ID_BATTERY_TEMP;
+            break;
+
+        case (2):
+            message.id = ID_PARAM_REQUEST;
+            message.len = PAR_PARAM_REQUEST_DLC;
+            message.buf[0] = PARAM_CMD_INFO;
+            break;
+
+        case (4):
+            message.id = ID_TRANSPORT_REQUEST;
+            break;
+
+        default:
+            message.id = FLOOD_FILTERED_ID;
+            break;
+    }
+}
+
+/*-----------------------------------------------------------------------------
+ Run a call on the virtual clock, charging its host time (scaled) as target time
+-----------------------------------------------------------------------------*/
+template <typename F>
+static void RunTimed(double & clock, F call) {
+    uint64_t start = replayMicros = static_cast<uint64_t>(clock);
+    uint32_t cycles = ReplayCycles();
+
+    call();
+
+    // Blocking delays in the firmware already moved the clock
+    clock += (replayMicros - start) + static_cast<double>(ReplayCycles() - cycles) / (F_CPU_ACTUAL / 1000000);
+    replayMicros = static_cast<uint64_t>(clock);
+}
+
+/*-----------------------------------------------------------------------------
+ Store a valid config image with default parameters and calibrated pedals
+-----------------------------------------------------------------------------*/
+static void SeedCalibration(void) {
+    configBlob_t image = {};
+
+    image.magic = CONFIG_MAGIC;
+    image.version = CONFIG_VERSION;
+    image.count = static_cast<uint8_t>(parameter::COUNT);
+    image.flags = CONFIG_FLAG_PEDALS;
+
+    for (uint8_t index = 0; index < static_cast<uint8_t>(parameter::COUNT); ++index) {
+        const parameterInfo_t & info = ParameterHandler::GetInfo(index);
+
+        if (info.type == parameterType::FLOAT) {
+            image.parameters[index].f = info.defaultValue;
+        } else {
+            image.parameters[index].i = static_cast<int32_t>(info.defaultValue);
+        }
+    }
+
+    // Bounds are stored as the hall sensors' cooked (16 bit) output
+    for (uint8_t sensor = 0; sensor < NUM_SENSORS; ++sensor) {
+        image.pedals.upper[sensor] = FLOOD_PEDAL_UPPER * TWO_BYTES / ADC_RESOLUTION;
+        image.pedals.lower[sensor] = FLOOD_PEDAL_LOWER * TWO_BYTES / ADC_RESOLUTION;
+    }
+
+    image.crc = UpdateCRC32( 0, reinterpret_cast<const uint8_t *>(&image), offsetof(configBlob_t, crc) );
+    EEPROM.put(CONFIG_EEPROM_ADDRESS, image);
+}
+
+/*-----------------------------------------------------------------------------
+ Act as the driver - close the SDC, hold the brake and press RTD, then step the throttle
+-----------------------------------------------------------------------------*/
+static void DriveFlood(uint64_t now) {
+    systemData & system = vehicle.GetSystemData();
+    systemState state = static_cast<systemState>( system.GetStateBuffer() );
+    bool bBraking = (state == systemState::RTD);
+    bool bThrottle = (state == systemState::IDLE || state == systemState::DRIVE);
+    uint16_t throttle = (now / FLOOD_APPS_STEP % 2) ? FLOOD_APPS_HIGH : FLOOD_APPS_LOW;
+
+    replayAnalog[PIN_SHUTDOWN_TAP] = FLOOD_SDC_TAP;
+    replayAnalog[PIN_BSE] = bBraking ? FLOOD_PEDAL_UPPER : FLOOD_PEDAL_LOWER;
+
+    // Pulse RTD once the (filtered) brake request is past its threshold
+    bool bBrakeHeld = system.GetBSE().GetPercentRequest() * 100 > ParameterHandler::GetInt(parameter::BRAKE_PERCENT);
+    replayDigital[PIN_RTD_BUTTON] = bBraking && bBrakeHeld && (now / FLOOD_RTD_PULSE % 2);
+
+    // Time each throttle step to the first torque command that follows it
+    if (bThrottle && replayAnalog[PIN_APPS_ONE] != throttle && replayAnalog[PIN_APPS_ONE] != FLOOD_PEDAL_LOWER) {
+        stepsMissed += bStepPending;
+        stepTime = now;
+        stepTorque = lastTorque;
+        bStepUp = (throttle == FLOOD_APPS_HIGH);
+        bStepPending = true;
+    }
+
+    replayAnalog[PIN_APPS_ONE] = bThrottle ? throttle : FLOOD_PEDAL_LOWER;
+    replayAnalog[PIN_APPS_TWO] = replayAnalog[PIN_APPS_ONE];
+}
+
+/*-----------------------------------------------------------------------------
+ Push 100 % bus load through the receive path and check the loop keeps its budgets
+-----------------------------------------------------------------------------*/
+static int RunFlood(uint32_t seconds) {
+    double clock = 1000000;
+    uint64_t loopStart = 0;
+    uint64_t loopMaximum = 0;
+    uint64_t loopTotal = 0;
+    uint32_t loops = 0;
+    uint32_t slot = 0;
+    uint32_t delivered = 0;
+    uint32_t expected = 0;
+    uint32_t filtered = 0;
+    uint32_t overruns = 0;
+    std::map<uint32_t, uint32_t> offered;
+    int16_t speed = 0;
+    int16_t pendingSpeed = 0;
+    uint64_t pendingTime = 0;
+    uint64_t responseMaximum = 0;
+    uint32_t responses = 0;
+    uint32_t responsesMissed = 0;
+    std::vector<uint32_t> periods;
+
+    // Check whether the last genuine response has been decoded yet
+    auto CheckResponse = [&]() {
+        if ( pendingSpeed && TelemetryHandler::GetValue(bamocarSignal::SPEED) == pendingSpeed ) {
+            responseMaximum = std::max<uint64_t>(responseMaximum, replayMicros - pendingTime);
+            ++responses;
+            pendingSpeed = 0;
+        }
+    };
+
+    bQuiet = true;
+    replayTransmit = ReplayTransmit;
+    replayMicros = static_cast<uint64_t>(clock);
+    SeedCalibration();
+    setup();
+
+    // Flood starts once setup (and its delays) is done
+    clock = std::max<double>(clock, replayMicros);
+
+    double floodStart = clock;
+    double nextFrame = clock;
+    uint64_t measureStart = 0;
+    uint64_t end = static_cast<uint64_t>(clock) + FLOOD_START_LIMIT;
+    uint32_t torqueStart = 0;
+    uint32_t deferredStart = 0;
+    bool bDriving = false;
+    bool bMeasuring = false;
+
+    while (clock < end) {
+        double due = clock;
+        bool bSlow = bMeasuring && (static_cast<uint64_t>(clock) - measureStart) / FLOOD_SLOW_PERIOD % 2;
+
+        // Frames the receive queue could not hold while the ISRs fell behind are lost
+        while (due - nextFrame > FLOOD_RX_QUEUE * FLOOD_FRAME_US) {
+            nextFrame += FLOOD_FRAME_US;
+            ++slot;
+            ++overruns;
+        }
+
+        // Frames that finished while the loop ran interrupt it (back to back ISRs steal loop time)
+        while (nextFrame <= due) {
+            CAN_message_t message;
+
+            MakeFloodFrame(slot++, message, speed);
+
+            if (message.id == ID_CAN_MESSAGE_TX && message.buf[0] == REG_SPEED_FILTERED) {
+                responsesMissed += (pendingSpeed != 0);
+                pendingSpeed = speed;
+                pendingTime = static_cast<uint64_t>(clock);
+            }
+
+            // Every ID but the babbling one must pass the acceptance filters
+            expected += (message.id != FLOOD_FILTERED_ID);
+            ++offered[message.id];
+
+            bool bAccepted = false;
+            uint32_t deferred = AdmissionHandler::GetDeferred();
+            RunTimed(clock, [&]() { bAccepted = DeliverFrame(message); });
+
+            // Slow handlers push the ISRs past their budget - frames deferred to the loop skip the extra time
+            if ( bAccepted && bSlow && AdmissionHandler::GetDeferred() == deferred ) {
+                AdmissionHandler::ChargeISR( ARM_DWT_CYCCNT - FLOOD_SLOW_ISR_US * (F_CPU_ACTUAL / 1000000) );
+                clock += FLOOD_SLOW_ISR_US;
+            }
+
+            delivered += bAccepted;
+            filtered += !bAccepted;
+            CheckResponse();
+
+            nextFrame += FLOOD_FRAME_US;
+        }
+
+        uint64_t start = static_cast<uint64_t>(clock);
+
+        // The flood runs through start up - results start once the car has been driving for the warm up
+        if ( !bDriving && vehicle.GetSystemData().GetStateBuffer() == static_cast<uint8_t>(systemState::DRIVE) ) {
+            bDriving = true;
+            measureStart = start + FLOOD_WARMUP;
+            end = measureStart + seconds * 1000000ULL;
+        }
+
+        if (!bMeasuring && bDriving && start >= measureStart) {
+            bMeasuring = true;
+            torqueGapMaximum = 0;
+            responseMaximum = 0;
+            torqueStart = torqueCount;
+            deferredStart = AdmissionHandler::GetDeferred();
+            stepMaximum = 0;
+            stepCount = 0;
+            stepsMissed = 0;
+        } else if (bMeasuring) {
+            uint64_t period = start - loopStart;
+
+            loopMaximum = std::max(loopMaximum, period);
+            loopTotal += period;
+            periods.push_back(static_cast<uint32_t>(period));
+            ++loops;
+        }
+
+        loopStart = start;
+        DriveFlood(start);
+        RunTimed(clock, []() { loop(); });
+        CheckResponse();
+    }
+
+    std::sort(periods.begin(), periods.end());
+
+    const latencyStats_t & control = LatencyHandler::GetControlStats();
+    uint32_t percentile = periods.empty() ? 0 : periods[periods.size() * 99 / 100];
+    uint32_t torqueFrames = torqueCount - torqueStart;
+    bool bPassed = loops > 0 && overruns == 0 && delivered >= expected && loopMaximum <= FLOOD_LOOP_BUDGET &&
+        responseMaximum <= FLOOD_RESPONSE_BUDGET;
+
+    // The car must be driving - torque commands keep coming and follow the throttle
+    bPassed = bPassed && bMeasuring && torqueFrames > 0 && torqueGapMaximum <= FLOOD_TORQUE_BUDGET &&
+        stepCount > 0 && stepsMissed == 0 && stepMaximum <= FLOOD_CONTROL_BUDGET &&
+        control.count > 0 && control.maximum <= FLOOD_CONTROL_BUDGET;
+    double duration = (clock - floodStart) / 1000000;
+    uint8_t overRate = 0;
+
+    fprintf(stderr, "flood: %u s at %u frames/s, cycle scale %u\n", seconds, 1000000 / FLOOD_FRAME_US, replayCycleScale);
+    fprintf(stderr, "flood: %u frames to the ISRs (%u expected), %u dropped by the filters, %u lost to RX queue overruns\n",
+        delivered, expected, filtered, overruns);
+    fprintf(stderr, "flood: %u main loops measured\n", loops);
+    fprintf(stderr, "flood: loop period mean %.1f us p99 %u us max %llu us (budget %u us)\n",
+        loops ? static_cast<double>(loopTotal) / loops : 0.0, percentile,
+        static_cast<unsigned long long>(loopMaximum), FLOOD_LOOP_BUDGET);
+    fprintf(stderr, "flood: response to decoded speed max %llu us over %u responses, %u overwritten (budget %u us)\n",
+        static_cast<unsigned long long>(responseMaximum), responses, responsesMissed, FLOOD_RESPONSE_BUDGET);
+
+    if (!bMeasuring) {
+        fprintf(stderr, "flood: FSM did not reach DRIVE within %u s (state %u)\n", FLOOD_START_LIMIT / 1000000,
+            vehicle.GetSystemData().GetStateBuffer());
+    }
+
+    fprintf(stderr, "flood: torque frame gap max %llu us over %u frames (budget %u us)\n",
+        static_cast<unsigned long long>(torqueGapMaximum), torqueFrames, FLOOD_TORQUE_BUDGET);
+    fprintf(stderr, "flood: throttle step to torque frame max %llu us over %u steps, %u missed (budget %u us)\n",
+        static_cast<unsigned long long>(stepMaximum), stepCount, stepsMissed, FLOOD_CONTROL_BUDGET);
+    fprintf(stderr, "flood: pedal sample to torque frame max %u us over %u frames (budget %u us)\n",
+        control.maximum, control.count, FLOOD_CONTROL_BUDGET);
+
+    // An ID offered faster than its bucket refills must have frames rejected
+    for (uint8_t index = 0; index < ADMISSION_NUM_IDS; ++index) {
+        const admissionConfig_t & limit = AdmissionHandler::GetConfig(index);
+        uint32_t rate = duration > 0 ? static_cast<uint32_t>(offered[limit.id] / duration) : 0;
+        bool bOverRate = offered[limit.id] > limit.rate * duration + limit.burst;
+
+        overRate += bOverRate;
+        bPassed = bPassed && ( !bOverRate || AdmissionHandler::GetRejected(index) > 0 );
+
+        fprintf(stderr, "flood: %03X offered %u/s limited to %u/s rejected %u\n", limit.id, rate, limit.rate,
+            AdmissionHandler::GetRejected(index));
+    }
+
+    // The limiter must be exercised - the frame mix has to push at least one ID past its rate
+    bPassed = bPassed && overRate > 0;
+
+    // So must the ISR budget - the slow periods have to defer frames, and the loop has to keep up with them
+    uint32_t deferred = AdmissionHandler::GetDeferred() - deferredStart;
+    bPassed = bPassed && deferred > 0 && AdmissionHandler::GetDropped() == 0;
+
+    fprintf(stderr, "flood: %u deferred to the loop, %u dropped, ISR peak %u cycles (%u us extra per frame while slow)\n",
+        deferred, AdmissionHandler::GetDropped(), AdmissionHandler::GetPeakCycles(), FLOOD_SLOW_ISR_US);
+    fprintf(stderr, "flood: %s\n", bPassed ? "PASS" : "FAIL");
+
+    return bPassed ? 0 : 1;
+}
+
+/*-------------------------------------------------------------------------------------------------
+ Replay
+-------------------------------------------------------------------------------------------------*/
+int main(int argc, char ** argv) {
+    std::vector<replayRecord_t> records;
+    uint64_t period = REPLAY_LOOP_PERIOD;
+    uint64_t time = 0;
+    uint32_t previous = 0;
+    uint16_t sequences[2] = {0};
+    bool bSequenceValid[2] = {false};
+    uint32_t dropped = 0;
+    uint32_t received = 0;
+    const char * pInterface = NULL;
+    uint32_t floodSeconds = 0;
+    int option;
+
+    while ( (option = getopt(argc, argv, "c:f:x:s:p:a:d:q")) != -1 ) {
+        switch (option) {
+            case ('c'):
+                pInterface = optarg;
+                break;
+
+            case ('f'):
+                floodSeconds = strtoul(optarg, NULL, 10);
+                break;
+
+            case ('x'):
+                replayCycleScale = strtoul(optarg, NULL, 10);
+                replayCycleScale = replayCycleScale ? replayCycleScale : 1;
+                break;
+
+            case ('s'):
+                replaySDRoot = optarg;
+                break;
+
+            case ('p'):
+                period = strtoull(optarg, NULL, 10);
+                period = period ? period : REPLAY_LOOP_PERIOD;
+                break;
+
+            case ('a'):
+                if ( !SetPin(optarg, replayAnalog) ) return 2;
+                break;
+
+            case ('d'):
+                if ( !SetPin(optarg, replayDigital) ) return 2;
+                break;
+
+            case ('q'):
+                bQuiet = true;
+                break;
+
+            default:
+                return 2;
+        }
+    }
+
+    if (pInterface) {
+        return RunBridge(pInterface);
+    }
+
+    if (floodSeconds) {
+        return RunFlood(floodSeconds);
+    }
+
+    if (optind >= argc) {
+        fprintf(stderr, "usage: %s [-s sd_root] [-p loop_us] [-a pin=value] [-d pin=value] [-q] trace...\n", argv[0]);
+        fprintf(stderr, "       %s -c can_interface [-s sd_root] [-a pin=value] [-d pin=value] [-q]\n", argv[0]);
+        fprintf(stderr, "       %s -f seconds [-x scale] [-s sd_root] [-a pin=value] [-d pin=value]\n", argv[0]);
+        return 2;
+    }
+
+    for (int index = optind; index < argc; ++index) {
+        if ( !LoadTrace(argv[index], records, time, previous, sequences, bSequenceValid, dropped) ) {
+            return 1;
+        }
+    }
+
+    // Merge the two directions back into bus order
+    std::stable_sort(records.begin(), records.end(),
+        [](const replayRecord_t & a, const replayRecord_t & b) { return a.time < b.time; });
+
+    if ( records.empty() ) {
+        fprintf(stderr, "replay: no frames\n");
+        return 1;
+    }
+
+    clock_t wallStart = clock();
+
+    replayTransmit = ReplayTransmit;
+    replayMicros = records.front().time;
+    setup();
+
+    for (const replayRecord_t & entry : records) {
+        const traceRecord_t & record = entry.record;
+        bool bTransmit = (record.header >> TRACE_TX_BIT) & 0x01;
+
+        // Run the main loop up to the frame time
+        while (replayMicros + period <= entry.time) {
+            replayMicros += period;
+            loop();
+        }
+
+        replayMicros = std::max(replayMicros, entry.time);
+
+        // Recorded transmissions are only counted - this build makes its own
+        if (bTransmit) {
+            ++txCounts[record.header & TRACE_ID_MASK].recorded;
+            continue;
+        }
+
+        CAN_message_t message;
+        message.id = record.header & TRACE_ID_MASK;
+        message.len = record.header >> TRACE_LEN_SHIFT;
+        memcpy(message.buf, record.buf, sizeof(message.buf));
+
+        if (!bQuiet) {
+            PrintFrame(replayMicros, "RX", message.id, message.len, message.buf);
+        }
+
+        // Deliver as the receive interrupt would
+        DeliverFrame(message);
+
+        if (!bQuiet && message.id == ID_CAN_MESSAGE_TX) {
+            PrintTelemetry();
+        }
+
+        ++received;
+    }
+
+    double wall = static_cast<double>(clock() - wallStart) / CLOCKS_PER_SEC;
+    double span = (records.back().time - records.front().time) / 1e6;
+
+    fprintf(stderr, "replay: %u RX frames, %zu TX frames recorded, %u dropped by the recorder\n",
+        received, records.size() - received, dropped);
+    fprintf(stderr, "replay: %.3f s of trace in %.3f s (%.0fx real time)\n", span, wall,
+        (wall > 0) ? span / wall : 0.0);
+
+    for (const auto & count : txCounts) {
+        fprintf(stderr, "replay: TX %03X recorded %u replayed %u\n", count.first,
+            count.second.recorded, count.second.replayed);
+    }
+
+    return 0;
+}
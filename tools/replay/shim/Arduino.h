@@ -0,0 +1,195 @@
+// Safe guards
+#ifndef REPLAY_ARDUINO_H
+#define REPLAY_ARDUINO_H
+
+/*-------------------------------------------------------------------------------------------------
+ Host shim of the Teensy Arduino core used by the trace replay (virtual clock, simulated pins)
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <string>
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+/*------------------------------------------
+ Macros - Core
+------------------------------------------*/
+#define HIGH                     1
+#define LOW                      0
+#define INPUT                    0
+#define OUTPUT                   1
+#define INPUT_PULLUP             2
+#define CHANGE                   4
+#define FALLING                  2
+#define RISING                   3
+#define HEX                      16
+#define F_CPU                    600000000
+
+#define A0                       14
+#define A1                       15
+#define A2                       16
+#define A3                       17
+#define A4                       18
+#define A5                       19
+#define A6                       20
+#define A7                       21
+#define A8                       22
+#define A9                       23
+#define A10                      24
+#define A11                      25
+#define A12                      26
+#define A13                      27
+#define A14                      38
+#define A15                      39
+#define A16                      40
+#define A17                      41
+
+#define REPLAY_NUM_PINS          64
+
+#define FLASHMEM
+#define FASTRUN
+#define DMAMEM
+#define PROGMEM
+#define F(string)                string
+
+#define bitRead(value, bit)      (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit)       ((value) |= (1UL << (bit)))
+#define bitClear(value, bit)     ((value) &= ~(1UL << (bit)))
+#define constrain(x, low, high)  ((x) < (low) ? (low) : ((x) > (high) ? (high) : (x)))
+
+/*-------------------------------------------------------------------------------------------------
+ Replay state (defined in shim.cpp)
+-------------------------------------------------------------------------------------------------*/
+extern uint64_t replayMicros;
+extern uint16_t replayAnalog[REPLAY_NUM_PINS];
+extern uint8_t replayDigital[REPLAY_NUM_PINS];
+
+extern uint32_t F_CPU_ACTUAL;
+extern uint32_t replayCycleScale;
+
+// Cycle counter follows host time (scaled to estimate a slower target)
+uint32_t ReplayCycles(void);
+#define ARM_DWT_CYCCNT           ReplayCycles()
+
+/*-------------------------------------------------------------------------------------------------
+ Time
+-------------------------------------------------------------------------------------------------*/
+inline uint32_t micros(void) { return static_cast<uint32_t>(replayMicros); }
+inline uint32_t millis(void) { return static_cast<uint32_t>(replayMicros / 1000); }
+
+// Blocking waits advance the virtual clock instead of stalling the replay
+inline void delay(uint32_t ms) { replayMicros += static_cast<uint64_t>(ms) * 1000; }
+inline void delayMicroseconds(uint32_t us) { replayMicros += us; }
+
+class elapsedMillis {
+    public:
+        elapsedMillis(uint32_t value = 0) { start = millis() - value; }
+        operator uint32_t() const { return millis() - start; }
+        elapsedMillis & operator=(uint32_t value) { start = millis() - value; return *this; }
+
+    private:
+        uint32_t start;
+};
+
+class elapsedMicros {
+    public:
+        elapsedMicros(uint32_t value = 0) { start = micros() - value; }
+        operator uint32_t() const { return micros() - start; }
+        elapsedMicros & operator=(uint32_t value) { start = micros() - value; return *this; }
+
+    private:
+        uint32_t start;
+};
+
+// Periodic hardware timers never fire during replay
+class IntervalTimer {
+    public:
+        bool begin(void (*)(void), uint32_t) { return true; }
+        void end(void) {}
+        void priority(uint8_t) {}
+};
+
+/*-------------------------------------------------------------------------------------------------
+ Pins (inputs read from the replay pin tables)
+-------------------------------------------------------------------------------------------------*/
+inline void pinMode(uint8_t, uint8_t) {}
+inline int analogRead(uint8_t pin) { return (pin < REPLAY_NUM_PINS) ? replayAnalog[pin] : 0; }
+inline void analogWrite(uint8_t, int) {}
+inline void analogReadResolution(uint8_t) {}
+inline uint8_t digitalRead(uint8_t pin) { return (pin < REPLAY_NUM_PINS) ? replayDigital[pin] : LOW; }
+inline uint8_t digitalReadFast(uint8_t pin) { return digitalRead(pin); }
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline void digitalWriteFast(uint8_t, uint8_t) {}
+
+inline int digitalPinToInterrupt(int pin) { return pin; }
+inline void attachInterrupt(int, void (*)(void), int) {}
+inline void detachInterrupt(int) {}
+
+inline void __disable_irq(void) {}
+inline void __enable_irq(void) {}
+inline void interrupts(void) {}
+inline void noInterrupts(void) {}
+
+/*-------------------------------------------------------------------------------------------------
+ Strings & Serial (debug output is discarded)
+-------------------------------------------------------------------------------------------------*/
+class String {
+    public:
+        String(void) {}
+        String(const char * pString) : text(pString ? pString : "") {}
+        String(const std::string & string) : text(string) {}
+
+        const char * c_str(void) const { return text.c_str(); }
+        unsigned length(void) const { return text.length(); }
+
+    private:
+        std::string text;
+};
+
+class Print {
+    public:
+        virtual ~Print(void) {}
+
+        virtual size_t write(const uint8_t *, size_t size) { return size; }
+        size_t write(uint8_t value) { return write(&value, 1); }
+
+        size_t print(const char * pString) { return write(reinterpret_cast<const uint8_t *>(pString), strlen(pString)); }
+        size_t print(char * pString) { return print( static_cast<const char *>(pString) ); }
+        size_t print(const String & string) { return print( string.c_str() ); }
+        size_t print(char character) { return write( static_cast<uint8_t>(character) ); }
+        template <typename T> size_t print(T value) { return print( std::to_string(value).c_str() ); }
+        template <typename T> size_t print(T value, int base) {
+            char pNumber[24];
+            snprintf(pNumber, sizeof(pNumber), (base == HEX) ? "%llX" : "%llu", static_cast<unsigned long long>(value));
+            return print(pNumber);
+        }
+
+        template <typename T> size_t println(T value) { return print(value) + println(); }
+        template <typename T> size_t println(T value, int base) { return print(value, base) + println(); }
+        size_t println(void) { return print("\r\n"); }
+};
+
+class Stream : public Print {
+    public:
+        virtual int available(void) { return 0; }
+        virtual int read(void) { return -1; }
+        virtual String readString(void) { return String(); }
+        void flush(void) {}
+};
+
+class usb_serial_class : public Stream {
+    public:
+        void begin(uint32_t) {}
+        operator bool(void) { return true; }
+};
+
+extern usb_serial_class Serial;
+
+// End safe guards
+#endif /* REPLAY_ARDUINO_H */
@@ -0,0 +1,41 @@
+// Safe guards
+#ifndef REPLAY_EEPROM_H
+#define REPLAY_EEPROM_H
+
+/*-------------------------------------------------------------------------------------------------
+ Host shim of the Teensy EEPROM emulation (erased on every run)
+-------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <string.h>
+
+/*------------------------------------------
+ Macros - EEPROM
+------------------------------------------*/
+#define E2END                    0x10BB  // Teensy 4.1 (4284 bytes)
+
+class EEPROMClass {
+    public:
+        EEPROMClass(void) { memset(bytes, 0xFF, sizeof(bytes)); }
+
+        template <typename T>
+        T & get(int address, T & value) {
+            memcpy(&value, &bytes[address], sizeof(T));
+            return value;
+        }
+
+        template <typename T>
+        const T & put(int address, const T & value) {
+            memcpy(&bytes[address], &value, sizeof(T));
+            return value;
+        }
+
+        uint16_t length(void) { return E2END + 1; }
+
+    private:
+        uint8_t bytes[E2END + 1];
+};
+
+extern EEPROMClass EEPROM;
+
+// End safe guards
+#endif /* REPLAY_EEPROM_H */
@@ -0,0 +1,159 @@
+// Safe guards
+#ifndef REPLAY_FLEXCAN_T4_H
+#define REPLAY_FLEXCAN_T4_H
+
+/*-------------------------------------------------------------------------------------------------
+ Host shim of FlexCAN_T4 used by the trace replay (frames routed to the replay harness)
+-------------------------------------------------------------------------------------------------*/
+#include "Arduino.h"
+
+/*-------------------------------------------------------------------------------------------------
+ Data Structures
+-------------------------------------------------------------------------------------------------*/
+typedef struct CAN_message_t {
+    uint32_t id = 0;
+    uint16_t timestamp = 0;
+    uint8_t idhit = 0;
+    struct {
+        bool extended = 0;
+        bool remote = 0;
+        bool overrun = 0;
+        bool reserved = 0;
+    } flags;
+    uint8_t len = 8;
+    uint8_t buf[8] = { 0 };
+    int8_t mb = 0;
+    uint8_t bus = 0;
+    bool seq = 0;
+} CAN_message_t;
+
+typedef void (*_MB_ptr)(const CAN_message_t & message);
+
+// FIFO acceptance filters (exact standard IDs)
+#define REPLAY_NUM_FILTERS       8
+
+typedef struct replayFilter {
+    bool bRejectAll;
+    bool bUsed[REPLAY_NUM_FILTERS];
+    uint32_t ids[REPLAY_NUM_FILTERS];
+} replayFilter_t;
+
+typedef enum FLEXCAN_MAILBOX {
+    MB0, MB1, MB2, MB3, MB4, MB5, MB6, MB7, MB8, MB9, MB10, MB11, MB12, MB13, MB14, MB15,
+    MB16, MB17, MB18, MB19, MB20, MB21, MB22, MB23, MB24, MB25, MB26, MB27, MB28, MB29, MB30,
+    MB31, MB32, MB33, MB34, MB35, MB36, MB37, MB38, MB39, MB40, MB41, MB42, MB43, MB44, MB45,
+    MB46, MB47, MB48, MB49, MB50, MB51, MB52, MB53, MB54, MB55, MB56, MB57, MB58, MB59, MB60,
+    MB61, MB62, MB63, FIFO = 99
+} FLEXCAN_MAILBOX;
+
+typedef enum FLEXCAN_RXTX { TX, RX, LISTEN_ONLY } FLEXCAN_RXTX;
+typedef enum FLEXCAN_IDE { NONE, EXT, RTR, STD, INACTIVE } FLEXCAN_IDE;
+typedef enum FLEXCAN_FLTEN { ACCEPT_ALL, REJECT_ALL } FLEXCAN_FLTEN;
+typedef enum CAN_DEV_TABLE { CAN0 = 0, CAN1 = 1, CAN2 = 2, CAN3 = 3 } CAN_DEV_TABLE;
+
+typedef enum FLEXCAN_RXQUEUE_TABLE {
+    RX_SIZE_2 = 2, RX_SIZE_4 = 4, RX_SIZE_8 = 8, RX_SIZE_16 = 16, RX_SIZE_32 = 32,
+    RX_SIZE_64 = 64, RX_SIZE_128 = 128, RX_SIZE_256 = 256, RX_SIZE_512 = 512, RX_SIZE_1024 = 1024
+} FLEXCAN_RXQUEUE_TABLE;
+
+typedef enum FLEXCAN_TXQUEUE_TABLE {
+    TX_SIZE_2 = 2, TX_SIZE_4 = 4, TX_SIZE_8 = 8, TX_SIZE_16 = 16, TX_SIZE_32 = 32,
+    TX_SIZE_64 = 64, TX_SIZE_128 = 128, TX_SIZE_256 = 256, TX_SIZE_512 = 512, TX_SIZE_1024 = 1024
+} FLEXCAN_TXQUEUE_TABLE;
+
+/*-------------------------------------------------------------------------------------------------
+ Replay hooks & simulated controller registers (defined in shim.cpp)
+-------------------------------------------------------------------------------------------------*/
+extern _MB_ptr replayReceive[4];
+extern void (*replayTransmit)(uint8_t bus, const CAN_message_t & message);
+
+extern replayFilter_t replayFilters[4];
+
+volatile uint32_t & ReplayRegister(uint8_t bus, uint32_t offset);
+bool ReplayAccepts(uint8_t bus, uint32_t id);
+
+#define FLEXCANb_MCR(b)                  ReplayRegister(b, 0x00)
+#define FLEXCANb_CTRL1(b)                ReplayRegister(b, 0x04)
+#define FLEXCANb_TIMER(b)                ReplayRegister(b, 0x08)
+#define FLEXCANb_ECR(b)                  ReplayRegister(b, 0x1C)
+#define FLEXCANb_ESR1(b)                 ReplayRegister(b, 0x20)
+
+#define FLEXCAN_ESR_ERR_INT              (0x00000002)
+#define FLEXCAN_ESR_BOFF_INT             (0x00000004)
+#define FLEXCAN_ESR_FLT_CONF_MASK        (0x00000030)
+#define FLEXCAN_ESR_get_fault_code(esr)  (((esr) & FLEXCAN_ESR_FLT_CONF_MASK) >> 4)
+
+/*-------------------------------------------------------------------------------------------------
+ Controller (FIFO filters are kept for ReplayAccepts, other configuration is ignored)
+-------------------------------------------------------------------------------------------------*/
+template <CAN_DEV_TABLE _bus, FLEXCAN_RXQUEUE_TABLE _rxSize, FLEXCAN_TXQUEUE_TABLE _txSize>
+class FlexCAN_T4 {
+    public:
+        // Re-initializing leaves bus off like the soft reset does
+        void begin(void) { FLEXCANb_ESR1(_bus) &= ~FLEXCAN_ESR_FLT_CONF_MASK; }
+        void setBaudRate(uint32_t, FLEXCAN_RXTX = TX) {}
+        void setMaxMB(uint8_t) {}
+        void enableFIFO(bool = 1) {}
+        void enableFIFOInterrupt(bool = 1) {}
+        void enableMBInterrupt(const FLEXCAN_MAILBOX &, bool = 1) {}
+        void enableMBInterrupts(bool = 1) {}
+        bool setMB(const FLEXCAN_MAILBOX &, const FLEXCAN_RXTX &, const FLEXCAN_IDE & = STD) { return 1; }
+
+        void setFIFOFilter(const FLEXCAN_FLTEN & mode) {
+            replayFilters[_bus] = {};
+            replayFilters[_bus].bRejectAll = (mode == REJECT_ALL);
+        }
+
+        bool setFIFOFilter(uint8_t filter, uint32_t id, const FLEXCAN_IDE &, const FLEXCAN_IDE & = NONE) {
+            if (filter >= REPLAY_NUM_FILTERS) {
+                return 0;
+            }
+
+            replayFilters[_bus].bUsed[filter] = true;
+            replayFilters[_bus].ids[filter] = id;
+
+            return 1;
+        }
+
+        bool setFIFOFilter(uint8_t, uint32_t, uint32_t, const FLEXCAN_IDE &, const FLEXCAN_IDE & = NONE) { return 1; }
+        bool setFIFOFilterRange(uint8_t, uint32_t, uint32_t, const FLEXCAN_IDE &, const FLEXCAN_IDE & = NONE) { return 1; }
+        void setMBFilter(FLEXCAN_FLTEN) {}
+        void setMBFilter(FLEXCAN_MAILBOX, FLEXCAN_FLTEN) {}
+        bool setMBFilter(FLEXCAN_MAILBOX, uint32_t) { return 1; }
+
+        void onReceive(_MB_ptr handler) { replayReceive[_bus] = handler; }
+        void onReceive(const FLEXCAN_MAILBOX &, _MB_ptr handler) { replayReceive[_bus] = handler; }
+        void onTransmit(_MB_ptr handler) { transmitHandler = handler; }
+        void onTransmit(const FLEXCAN_MAILBOX &, _MB_ptr handler) { transmitHandler = handler; }
+
+        int write(const CAN_message_t & message) { return Transmit(message); }
+        int write(FLEXCAN_MAILBOX, const CAN_message_t & message) { return Transmit(message); }
+        int read(CAN_message_t &) { return 0; }
+
+        uint64_t events(void) { return 0; }
+        uint32_t getRXQueueCount(void) { return 0; }
+        uint32_t getTXQueueCount(void) { return 0; }
+
+    private:
+        _MB_ptr transmitHandler = nullptr;
+
+        // Frames are on the bus as soon as they are written - confirmed straight away
+        int Transmit(const CAN_message_t & message) {
+            if (replayTransmit) {
+                replayTransmit(_bus, message);
+            }
+
+            if (transmitHandler) {
+                CAN_message_t confirmed = message;
+
+                confirmed.bus = _bus;
+                confirmed.timestamp = FLEXCANb_TIMER(_bus);
+                transmitHandler(confirmed);
+            }
+
+            return 1;
+        }
+};
+
+// End safe guards
+#endif /* REPLAY_FLEXCAN_T4_H */
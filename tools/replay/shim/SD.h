@@ -0,0 +1,240 @@
+// Safe guards
+#ifndef REPLAY_SD_H
+#define REPLAY_SD_H
+
+/*-------------------------------------------------------------------------------------------------
+ Host shim of the Teensy SD library used by the trace replay (files live in a host directory)
+-------------------------------------------------------------------------------------------------*/
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "Arduino.h"
+
+/*------------------------------------------
+ Macros - Open Modes
+------------------------------------------*/
+#define FILE_READ                O_RDONLY
+#define FILE_WRITE               (O_RDWR | O_CREAT | O_APPEND)
+#define FILE_WRITE_BEGIN         (O_RDWR | O_CREAT)
+#define BUILTIN_SDCARD           254
+
+// Directory used as the SD card root (defined in shim.cpp)
+extern std::string replaySDRoot;
+
+/*-------------------------------------------------------------------------------------------------
+ Files (backed by stdio)
+-------------------------------------------------------------------------------------------------*/
+class File : public Stream {
+    public:
+        File(void) : pFile(nullptr), pDirectory(nullptr) {}
+        explicit File(FILE * pHostFile, const std::string & path = "") :
+            pFile(pHostFile), pDirectory(nullptr), path(path) {}
+        explicit File(DIR * pHostDirectory, const std::string & path) :
+            pFile(nullptr), pDirectory(pHostDirectory), path(path) {}
+
+        operator bool(void) const { return pFile != nullptr || pDirectory != nullptr; }
+
+        // Directories
+        const char * name(void) const {
+            size_t slash = path.find_last_of('/');
+            return path.c_str() + ( (slash == std::string::npos) ? 0 : slash + 1 );
+        }
+        bool isDirectory(void) const { return pDirectory != nullptr; }
+        File openNextFile(void) {
+            struct dirent * pEntry;
+
+            while ( pDirectory && (pEntry = readdir(pDirectory)) ) {
+                if ( !strcmp(pEntry->d_name, ".") || !strcmp(pEntry->d_name, "..") ) {
+                    continue;
+                }
+
+                std::string entryPath = path + "/" + pEntry->d_name;
+                struct stat status;
+
+                if ( stat(entryPath.c_str(), &status) != 0 ) {
+                    continue;
+                }
+
+                if ( S_ISDIR(status.st_mode) ) {
+                    return File(opendir( entryPath.c_str() ), entryPath);
+                }
+
+                return File(fopen(entryPath.c_str(), "rb"), entryPath);
+            }
+
+            return File();
+        }
+
+        size_t write(const uint8_t * pBuffer, size_t size) override {
+            return pFile ? fwrite(pBuffer, 1, size, pFile) : 0;
+        }
+        size_t write(const void * pBuffer, size_t size) {
+            return write(static_cast<const uint8_t *>(pBuffer), size);
+        }
+
+        int read(void) override { return pFile ? fgetc(pFile) : -1; }
+        int read(void * pBuffer, size_t size) {
+            return pFile ? static_cast<int>( fread(pBuffer, 1, size, pFile) ) : -1;
+        }
+
+        int available(void) override {
+            return pFile ? static_cast<int>( size() - position() ) : 0;
+        }
+
+        String readString(void) override {
+            std::string text;
+            int character;
+
+            while ( (character = read()) >= 0 ) {
+                text += static_cast<char>(character);
+            }
+
+            return String(text);
+        }
+
+        bool truncate(uint64_t length) {
+            return pFile && fflush(pFile) == 0 && ftruncate(fileno(pFile), length) == 0;
+        }
+
+        bool seek(uint64_t offset) { return pFile && fseek(pFile, offset, SEEK_SET) == 0; }
+        uint64_t position(void) { return pFile ? ftell(pFile) : 0; }
+        uint64_t size(void) {
+            if (!pFile) {
+                return 0;
+            }
+
+            long current = ftell(pFile);
+            fseek(pFile, 0, SEEK_END);
+            long end = ftell(pFile);
+            fseek(pFile, current, SEEK_SET);
+
+            return end;
+        }
+
+        void flush(void) { if (pFile) fflush(pFile); }
+        bool close(void) {
+            if (pFile) {
+                fclose(pFile);
+                pFile = nullptr;
+            }
+
+            if (pDirectory) {
+                closedir(pDirectory);
+                pDirectory = nullptr;
+            }
+
+            return true;
+        }
+
+    protected:
+        FILE * pFile;
+        DIR * pDirectory;
+        std::string path;
+};
+
+// SdFat file - preallocation has no host equivalent and always succeeds
+class FsFile : public File {
+    public:
+        FsFile(void) : File() {}
+        explicit FsFile(FILE * pHostFile) : File(pHostFile) {}
+
+        using File::truncate;
+
+        bool preAllocate(uint64_t) { return pFile != nullptr; }
+        bool sync(void) { return pFile && fflush(pFile) == 0; }
+        bool truncate(void) { return pFile != nullptr; }
+        bool seekSet(uint64_t offset) { return seek(offset); }
+        bool isBusy(void) { return false; }
+};
+
+/*-------------------------------------------------------------------------------------------------
+ File systems
+-------------------------------------------------------------------------------------------------*/
+inline std::string ReplaySDPath(const char * pFileName) {
+    return replaySDRoot + "/" + pFileName;
+}
+
+inline FILE * ReplayOpen(const char * pFileName, int flags) {
+    std::string path = ReplaySDPath(pFileName);
+    FILE * pFile = nullptr;
+
+    // Exclusive create fails on an existing file
+    if ( (flags & O_EXCL) && access(path.c_str(), F_OK) == 0 ) {
+        return nullptr;
+    }
+
+    if ( (flags & O_ACCMODE) == O_RDONLY ) {
+        pFile = fopen(path.c_str(), "rb");
+    } else if (flags & O_APPEND) {
+        pFile = fopen(path.c_str(), "a+b");
+    } else if (flags & O_TRUNC) {
+        pFile = fopen(path.c_str(), (flags & O_RDWR) ? "w+b" : "wb");
+    } else {
+        // Open for update, creating the file if allowed
+        pFile = fopen(path.c_str(), "r+b");
+        if (!pFile && (flags & O_CREAT)) {
+            pFile = fopen(path.c_str(), "w+b");
+        }
+    }
+
+    return pFile;
+}
+
+// Host writes complete before returning - the card is never busy
+class SdCard {
+    public:
+        bool isBusy(void) { return false; }
+};
+
+class SdFs {
+    public:
+        SdCard * card(void) { return &sdCard; }
+        FsFile open(const char * pFileName, int flags = O_RDONLY) { return FsFile( ReplayOpen(pFileName, flags) ); }
+        bool exists(const char * pFileName) {
+            FILE * pFile = fopen(ReplaySDPath(pFileName).c_str(), "rb");
+
+            if (pFile) {
+                fclose(pFile);
+            }
+
+            return pFile != nullptr;
+        }
+        bool remove(const char * pFileName) { return ::remove( ReplaySDPath(pFileName).c_str() ) == 0; }
+        bool rename(const char * pOld, const char * pNew) {
+            return ::rename( ReplaySDPath(pOld).c_str(), ReplaySDPath(pNew).c_str() ) == 0;
+        }
+
+    private:
+        SdCard sdCard;
+};
+
+class SDClass {
+    public:
+        bool begin(uint8_t) { return true; }
+
+        File open(const char * pFileName, int flags = FILE_READ) {
+            std::string path = ReplaySDPath(pFileName);
+            struct stat status;
+
+            // Directories are listed with openNextFile
+            if ( stat(path.c_str(), &status) == 0 && S_ISDIR(status.st_mode) ) {
+                return File(opendir( path.c_str() ), path);
+            }
+
+            return File(ReplayOpen(pFileName, flags), path);
+        }
+        bool exists(const char * pFileName) { return sdfs.exists(pFileName); }
+        bool remove(const char * pFileName) { return sdfs.remove(pFileName); }
+        bool rename(const char * pOld, const char * pNew) { return sdfs.rename(pOld, pNew); }
+
+        SdFs sdfs;
+};
+
+extern SDClass SD;
+
+// End safe guards
+#endif /* REPLAY_SD_H */
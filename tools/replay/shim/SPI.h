@@ -0,0 +1,11 @@
+// Safe guards
+#ifndef REPLAY_SPI_H
+#define REPLAY_SPI_H
+
+/*-------------------------------------------------------------------------------------------------
+ Host shim of the Teensy SPI library (unused by the replay)
+-------------------------------------------------------------------------------------------------*/
+#include "Arduino.h"
+
+// End safe guards
+#endif /* REPLAY_SPI_H */
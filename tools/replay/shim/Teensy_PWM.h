@@ -0,0 +1,19 @@
+// Safe guards
+#ifndef REPLAY_TEENSY_PWM_H
+#define REPLAY_TEENSY_PWM_H
+
+/*-------------------------------------------------------------------------------------------------
+ Host shim of Teensy_PWM used by the trace replay (outputs are discarded)
+-------------------------------------------------------------------------------------------------*/
+#include "Arduino.h"
+
+class Teensy_PWM {
+    public:
+        Teensy_PWM(uint32_t, float, float) {}
+
+        bool setPWM(void) { return true; }
+        bool setPWM(uint32_t, float, float) { return true; }
+};
+
+// End safe guards
+#endif /* REPLAY_TEENSY_PWM_H */
@@ -0,0 +1,31 @@
+// Safe guards
+#ifndef REPLAY_WATCHDOG_T4_H
+#define REPLAY_WATCHDOG_T4_H
+
+/*-------------------------------------------------------------------------------------------------
+ Host shim of WDT_T4 used by the trace replay (the watchdog never expires)
+-------------------------------------------------------------------------------------------------*/
+#include "Arduino.h"
+
+typedef void (*watchdog_class_ptr)(void);
+
+typedef enum WDT_DEV_TABLE { WDT1 = 1, WDT2, WDT3, EWM } WDT_DEV_TABLE;
+
+typedef struct WDT_timings_t {
+    double trigger = 5;
+    double timeout = 10;
+    double window = 0;
+    uint16_t pin = 21;
+    watchdog_class_ptr callback = nullptr;
+} WDT_timings_t;
+
+template <WDT_DEV_TABLE _device>
+class WDT_T4 {
+    public:
+        void begin(WDT_timings_t) {}
+        void feed(void) {}
+        void reset(void) {}
+};
+
+// End safe guards
+#endif /* REPLAY_WATCHDOG_T4_H */
@@ -0,0 +1,74 @@
+/*-------------------------------------------------------------------------------------------------
+ Host shim state shared by the Arduino, FlexCAN_T4 and SD replacements
+-------------------------------------------------------------------------------------------------*/
+#include <map>
+#include <time.h>
+
+#include "Arduino.h"
+#include "EEPROM.h"
+#include "FlexCAN_T4.h"
+#include "SD.h"
+
+// Virtual clock and simulated pins
+uint64_t replayMicros = 0;
+uint16_t replayAnalog[REPLAY_NUM_PINS] = {0};
+uint8_t replayDigital[REPLAY_NUM_PINS] = {0};
+
+uint32_t F_CPU_ACTUAL = F_CPU;
+uint32_t replayCycleScale = 1;
+
+usb_serial_class Serial;
+EEPROMClass EEPROM;
+
+// SD card root directory
+std::string replaySDRoot = ".";
+SDClass SD;
+
+// Frame routing between the firmware and the replay harness
+_MB_ptr replayReceive[4] = {nullptr};
+void (*replayTransmit)(uint8_t bus, const CAN_message_t & message) = nullptr;
+
+// Acceptance filters of each controller (accept all until REJECT_ALL)
+replayFilter_t replayFilters[4] = {};
+
+/*-----------------------------------------------------------------------------
+ Host time in target CPU cycles
+-----------------------------------------------------------------------------*/
+uint32_t ReplayCycles(void) {
+    struct timespec now;
+
+    // Thread CPU time - other host processes do not count against the firmware
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+
+    uint64_t nanoseconds = now.tv_sec * 1000000000ULL + now.tv_nsec;
+
+    return static_cast<uint32_t>( nanoseconds * (F_CPU_ACTUAL / 1000000) / 1000 * replayCycleScale );
+}
+
+/*-----------------------------------------------------------------------------
+ Check a standard ID against the FIFO filters of a controller
+-----------------------------------------------------------------------------*/
+bool ReplayAccepts(uint8_t bus, uint32_t id) {
+    const replayFilter_t & filter = replayFilters[bus];
+
+    if (!filter.bRejectAll) {
+        return true;
+    }
+
+    for (uint8_t index = 0; index < REPLAY_NUM_FILTERS; ++index) {
+        if ( filter.bUsed[index] && filter.ids[index] == id ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*-----------------------------------------------------------------------------
+ Simulated controller registers - Read back whatever was last written
+-----------------------------------------------------------------------------*/
+volatile uint32_t & ReplayRegister(uint8_t bus, uint32_t offset) {
+    static std::map<uint32_t, uint32_t> registers;
+
+    return registers[(static_cast<uint32_t>(bus) << 16) | offset];
+}